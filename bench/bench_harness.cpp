@@ -0,0 +1,167 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+// JSON
+
+// Application files
+#include <bench_harness.h>
+#include <defs/dice_rolls.h>
+#include <utils/stopwatch.h>
+
+///////////////////////////////////////////////////////////////////////
+
+namespace
+{
+/**
+ * @brief Load one of the shipped configs, apply overrides and write it to the
+ * scratch directory
+ * @param scratch_dir Where to write the config
+ * @param name Config file name in config/
+ * @param overrides Keys to replace
+ * @return Path of the written config
+ */
+std::filesystem::path write_config(const std::filesystem::path& scratch_dir,
+                                   const std::string& name,
+                                   const nlohmann::json& overrides)
+{
+  std::filesystem::path source = std::filesystem::path(PROJECT_ROOT_DIR) / "config" / name;
+  nlohmann::json data = nlohmann::json::parse(std::ifstream(source));
+  data.merge_patch(overrides);
+
+  std::filesystem::create_directories(scratch_dir);
+  std::filesystem::path target = scratch_dir / name;
+  std::ofstream(target) << data.dump(2) << "\n";
+  return target;
+}
+}
+
+///////////////////////////////////////////////////////////////////////
+
+double world_builder::bench::Bench_result::Get_percentile(double fraction) const
+{
+  if(samples.empty())
+  {
+    return 0.0;
+  }
+
+  std::vector<double> sorted = samples;
+  std::sort(sorted.begin(), sorted.end());
+  size_t rank = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+  rank = std::clamp<size_t>(rank, 1, sorted.size());
+  return sorted[rank - 1];
+}
+
+///////////////////////////////////////////////////////////////////////
+
+nlohmann::json world_builder::bench::Bench_result::To_json() const
+{
+  double median = Get_median();
+  nlohmann::json out;
+  out["kernel"] = kernel;
+  out["size"] = size;
+  out["items"] = items;
+  out["repetitions"] = samples.size();
+  out["median_s"] = median;
+  out["p95_s"] = Get_p95();
+  out["min_s"] = samples.empty() ? 0.0 : *std::min_element(samples.begin(), samples.end());
+  out["mean_s"] = samples.empty() ? 0.0 :
+      std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+  out["items_per_s"] = median > 0.0 ? items / median : 0.0;
+  out["samples_s"] = samples;
+  if(!extra.empty())
+  {
+    out["extra"] = extra;
+  }
+  return out;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+world_builder::bench::Bench_result
+world_builder::bench::Measure(const Bench_options& options,
+                              const std::string& kernel,
+                              int size,
+                              const std::function<std::size_t()>& setup,
+                              const std::function<void()>& body)
+{
+  Bench_result result;
+  result.kernel = kernel;
+  result.size = size;
+
+  for(int run = 0; run < options.warmup + options.repetitions; ++run)
+  {
+    dice::Set_seed(options.seed);
+    result.items = setup();
+
+    Stopwatch timer;
+    timer.Start();
+    body();
+    timer.Stop();
+
+    if(run >= options.warmup)
+    {
+      result.samples.push_back(timer.Get_time());
+    }
+  }
+
+  return result;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+world_builder::Tiles_config
+world_builder::bench::Make_tiles_config(const std::filesystem::path& scratch_dir,
+                                        uint32_t width,
+                                        uint32_t height,
+                                        unsigned seed,
+                                        const nlohmann::json& overrides)
+{
+  nlohmann::json patch = overrides;
+  patch["width"] = width;
+  patch["height"] = height;
+  patch["seed"] = seed;
+  return Tiles_config(std::ifstream(write_config(scratch_dir, "gen_params.json", patch)));
+}
+
+///////////////////////////////////////////////////////////////////////
+
+world_builder::Voronoi_config
+world_builder::bench::Make_voronoi_config(const std::filesystem::path& scratch_dir,
+                                          double width,
+                                          double height,
+                                          unsigned seed,
+                                          const nlohmann::json& overrides)
+{
+  nlohmann::json patch = overrides;
+  patch["map_width"] = width;
+  patch["map_height"] = height;
+  patch["seed"] = seed;
+  return Voronoi_config(std::ifstream(write_config(scratch_dir, "voronoi_gen_config.json", patch)));
+}
+
+///////////////////////////////////////////////////////////////////////
+
+std::vector<std::string> world_builder::bench::Split_list(const std::string& list)
+{
+  std::vector<std::string> out;
+  std::stringstream stream(list);
+  std::string item;
+  while(std::getline(stream, item, ','))
+  {
+    if(!item.empty())
+    {
+      out.push_back(item);
+    }
+  }
+  return out;
+}
+
+///////////////////////////////////////////////////////////////////////
@@ -0,0 +1,165 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+// Standard libs
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+// JSON
+#include <deps/json.hpp>
+
+// Application files
+#include <utils/tiles_config.h>
+#include <utils/voronoi_config.h>
+
+namespace world_builder
+{
+/**
+ * @brief Shared helpers for the benchmark binaries
+ */
+namespace bench
+{
+
+/**
+ * @brief Settings shared by every measurement
+ */
+struct Bench_options
+{
+  /**
+   * @brief Untimed runs before measuring
+   */
+  int warmup = 1;
+
+  /**
+   * @brief Timed runs per kernel and size
+   */
+  int repetitions = 5;
+
+  /**
+   * @brief Seed applied to the dice before every run
+   */
+  unsigned seed = 12345;
+
+  /**
+   * @brief Directory for config files and any output the kernels write
+   */
+  std::filesystem::path scratch_dir;
+};
+
+/**
+ * @brief Timing summary of one kernel at one size
+ */
+struct Bench_result
+{
+  /**
+   * @brief Kernel name
+   */
+  std::string kernel;
+
+  /**
+   * @brief Size parameter the kernel was run with
+   */
+  int size = 0;
+
+  /**
+   * @brief Number of items (points, cells, tiles...) processed per run
+   */
+  std::size_t items = 0;
+
+  /**
+   * @brief Wall time of every timed run, in seconds
+   */
+  std::vector<double> samples;
+
+  /**
+   * @brief Kernel-specific measurements, e.g. collapsed sites
+   */
+  nlohmann::json extra = nlohmann::json::object();
+
+  /**
+   * @brief Median of the samples
+   */
+  double Get_median() const { return Get_percentile(0.5); }
+
+  /**
+   * @brief 95th percentile of the samples
+   */
+  double Get_p95() const { return Get_percentile(0.95); }
+
+  /**
+   * @brief Nearest-rank percentile of the samples
+   * @param fraction Percentile in [0, 1]
+   */
+  double Get_percentile(double fraction) const;
+
+  /**
+   * @brief Machine-readable form of this result
+   */
+  nlohmann::json To_json() const;
+};
+
+/**
+ * @brief Run `body` with warmup and repetitions, re-seeding the dice and
+ * calling the untimed `setup` before every run
+ * @param options Warmup, repetitions and seed
+ * @param kernel Kernel name
+ * @param size Size parameter, recorded with the result
+ * @param setup Untimed preparation, returns the number of items the body will
+ * process
+ * @param body The timed kernel
+ * @return The collected samples
+ */
+Bench_result Measure(const Bench_options& options,
+                     const std::string& kernel,
+                     int size,
+                     const std::function<std::size_t()>& setup,
+                     const std::function<void()>& body);
+
+/**
+ * @brief Write a tiles config in the production JSON format and load it back
+ * @param scratch_dir Directory for the config file
+ * @param width Tiles wide
+ * @param height Tiles high
+ * @param seed Seed stored in the config
+ * @param overrides Extra keys to set in the JSON
+ * @return The loaded config
+ */
+Tiles_config Make_tiles_config(const std::filesystem::path& scratch_dir,
+                               uint32_t width,
+                               uint32_t height,
+                               unsigned seed,
+                               const nlohmann::json& overrides = nlohmann::json::object());
+
+/**
+ * @brief Write a Voronoi config in the production JSON format and load it back
+ * @param scratch_dir Directory for the config file
+ * @param width Map width
+ * @param height Map height
+ * @param seed Seed stored in the config
+ * @param overrides Extra keys to set in the JSON
+ * @return The loaded config
+ */
+Voronoi_config Make_voronoi_config(const std::filesystem::path& scratch_dir,
+                                   double width,
+                                   double height,
+                                   unsigned seed,
+                                   const nlohmann::json& overrides = nlohmann::json::object());
+
+/**
+ * @brief Parse a comma separated list, e.g. "100,200,400"
+ * @param list The list to parse
+ * @return The parsed values
+ */
+std::vector<std::string> Split_list(const std::string& list);
+
+}
+}
+
+#endif
@@ -0,0 +1,695 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+#include <algorithm>
+#include <boost/program_options.hpp>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+// JSON
+#include <deps/json.hpp>
+
+// Application files
+#include <bench_harness.h>
+#include <utils/task_scheduler.h>
+#include <utils/world_builder_utils.h>
+// Tiles
+#include <geo_models/tiles/hex_distance_transform.h>
+#include <geo_models/tiles/world.h>
+#include <utils/html_writer.h>
+// Voronoi
+#include <geo_models/voronoi/cell_bfs.h>
+#include <geo_models/voronoi/cell_hierarchy.h>
+#include <geo_models/voronoi/chunked_poisson.h>
+#include <geo_models/voronoi/elevation_assigner.h>
+#include <geo_models/voronoi/poisson_disc.h>
+#include <geo_models/voronoi/river_network.h>
+#include <geo_models/voronoi/sample_elimination.h>
+#include <geo_models/voronoi/spherical_voronoi.h>
+#include <geo_models/voronoi/variable_poisson_disc.h>
+#include <geo_models/voronoi/voronoi_builder.h>
+
+///////////////////////////////////////////////////////////////////////
+
+namespace bench = world_builder::bench;
+
+///////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief A named microbenchmark, run once per size
+ */
+struct Kernel
+{
+  /**
+   * @brief Name used on the command line and in the results
+   */
+  std::string name;
+
+  /**
+   * @brief Measure the kernel at the given map width
+   */
+  std::function<bench::Bench_result(const bench::Bench_options&, int)> run;
+};
+
+///////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Voronoi maps keep the 5:3 aspect of the shipped config
+ * @param width Map width
+ * @return Map height
+ */
+double Voronoi_height(int width)
+{
+  return width * 3.0 / 5.0;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Tiles maps keep the 2:1 aspect of the shipped config
+ * @param width Tiles wide
+ * @return Tiles high
+ */
+uint32_t Tiles_height(int width)
+{
+  return std::max(1, width / 2);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Generate the Poisson points for a Voronoi config
+ * @param config The config
+ * @return The points
+ */
+std::vector<world_builder::Point> Make_points(const world_builder::Voronoi_config& config)
+{
+  world_builder::Poisson_disc sampler(config.Get_width(),
+                                      config.Get_height(),
+                                      config.Get_min_distance(),
+                                      config.Get_attempts());
+  sampler.Set_wrap_x(config.Get_wrap_points());
+  return sampler.Generate();
+}
+
+///////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Build a tiles world up to (but not including) a stage
+ * @param config The config, must outlive the world
+ * @param stages_to_run Number of pipeline stages to run, in pipeline order
+ * @return The world
+ */
+std::unique_ptr<world_builder::World> Make_world(const world_builder::Tiles_config& config,
+                                                 int stages_to_run)
+{
+  auto world = std::make_unique<world_builder::World>(config);
+  const std::vector<void (world_builder::World::*)()> stages = {
+    &world_builder::World::Seed_continents,
+    &world_builder::World::Seed_oceans,
+    &world_builder::World::Run_diffusion,
+    &world_builder::World::Normalize_elevation,
+    &world_builder::World::Run_oceans_and_coasts,
+    &world_builder::World::Run_rivers,
+    &world_builder::World::Run_moisture,
+    &world_builder::World::Run_temperature,
+    &world_builder::World::Paint_terrain
+  };
+  for(int i = 0; i < stages_to_run && i < static_cast<int>(stages.size()); ++i)
+  {
+    ((*world).*stages[i])();
+  }
+  return world;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief All registered kernels
+ * @return The kernels, in pipeline order
+ */
+std::vector<Kernel> Make_kernels()
+{
+  std::vector<Kernel> kernels;
+
+  kernels.push_back({"poisson_generate", [](const bench::Bench_options& options, int size)
+  {
+    auto config = bench::Make_voronoi_config(options.scratch_dir, size, Voronoi_height(size), options.seed);
+    std::size_t count = 0;
+    auto result = bench::Measure(options, "poisson_generate", size,
+                                 [&]() { return count; },
+                                 [&]() { count = Make_points(config).size(); });
+    result.items = count;
+    return result;
+  }});
+
+  kernels.push_back({"chunked_poisson_region", [](const bench::Bench_options& options, int size)
+  {
+    // A fresh cache every run, so every chunk is generated
+    auto config = bench::Make_voronoi_config(options.scratch_dir, size, Voronoi_height(size), options.seed);
+    double chunk_size = 16 * config.Get_min_distance();
+    std::size_t count = 0;
+    auto result = bench::Measure(options, "chunked_poisson_region", size,
+                                 [&]() { return count; },
+                                 [&]()
+                                 {
+                                   world_builder::Chunked_poisson sampler(chunk_size,
+                                                                          config.Get_min_distance(),
+                                                                          config.Get_attempts(),
+                                                                          options.seed);
+                                   count = sampler.Generate_region(0, 0, config.Get_width(),
+                                                                   config.Get_height()).size();
+                                 });
+    result.items = count;
+    result.extra["chunk_size"] = chunk_size;
+    return result;
+  }});
+
+  kernels.push_back({"variable_poisson_generate", [](const bench::Bench_options& options, int size)
+  {
+    // An ocean-heavy map: full detail on a central island covering about a
+    // fifth of the map, four times the spacing over open water
+    auto config = bench::Make_voronoi_config(options.scratch_dir, size, Voronoi_height(size), options.seed);
+    double min_radius = config.Get_min_distance();
+    double max_radius = 4 * min_radius;
+    double center_x = config.Get_width() / 2;
+    double center_y = config.Get_height() / 2;
+    double island = 0.3 * config.Get_height();
+    auto radius = [=](double x, double y)
+    {
+      double d = std::hypot(x - center_x, y - center_y);
+      double t = std::clamp((d - island) / island, 0.0, 1.0);
+      return min_radius + t * (max_radius - min_radius);
+    };
+    std::size_t count = 0;
+    auto result = bench::Measure(options, "variable_poisson_generate", size,
+                                 [&]() { return count; },
+                                 [&]()
+                                 {
+                                   world_builder::Variable_poisson_disc sampler(config.Get_width(),
+                                                                                config.Get_height(),
+                                                                                radius,
+                                                                                min_radius,
+                                                                                max_radius,
+                                                                                config.Get_attempts(),
+                                                                                options.seed);
+                                   count = sampler.Generate().size();
+                                 });
+    result.items = count;
+    result.extra["max_radius"] = max_radius;
+    return result;
+  }});
+
+  kernels.push_back({"sample_elimination_generate", [](const bench::Bench_options& options, int size)
+  {
+    // Same number of points as Poisson sampling would place on this map
+    auto config = bench::Make_voronoi_config(options.scratch_dir, size, Voronoi_height(size), options.seed);
+    size_t target = Make_points(config).size();
+    return bench::Measure(options, "sample_elimination_generate", size,
+                          [&]() { return target; },
+                          [&]()
+                          {
+                            world_builder::Sample_elimination sampler(config.Get_width(),
+                                                                      config.Get_height(),
+                                                                      target);
+                            sampler.Generate();
+                          });
+  }});
+
+  kernels.push_back({"voronoi_build_cells", [](const bench::Bench_options& options, int size)
+  {
+    auto config = bench::Make_voronoi_config(options.scratch_dir, size, Voronoi_height(size), options.seed);
+    std::vector<world_builder::Point> points;
+    world_builder::Voronoi_builder builder(config.Get_width(), config.Get_height(),
+                                           config.Get_voronoi_scale_factor());
+    auto result = bench::Measure(options, "voronoi_build_cells", size,
+                                 [&]() { points = Make_points(config); return points.size(); },
+                                 [&]() { builder.Build_cells(points); });
+    result.extra["collapsed_sites"] = builder.Get_collapsed_sites();
+    return result;
+  }});
+
+  kernels.push_back({"voronoi_build_cells_quantized", [](const bench::Bench_options& options, int size)
+  {
+    // Same points as voronoi_build_cells, snapped onto the int32 grid
+    auto config = bench::Make_voronoi_config(options.scratch_dir, size, Voronoi_height(size), options.seed);
+    std::vector<world_builder::Point> points;
+    world_builder::Voronoi_builder builder(config.Get_width(), config.Get_height(),
+                                           config.Get_voronoi_scale_factor());
+    builder.Set_site_input(world_builder::ESite_input::ESITE_INPUT_Quantized);
+    auto result = bench::Measure(options, "voronoi_build_cells_quantized", size,
+                                 [&]() { points = Make_points(config); return points.size(); },
+                                 [&]() { builder.Build_cells(points); });
+    result.extra["collapsed_sites"] = builder.Get_collapsed_sites();
+    return result;
+  }});
+
+  kernels.push_back({"voronoi_build_cells_clipping", [](const bench::Bench_options& options, int size)
+  {
+    // Same points as voronoi_build_cells, on the in-tree clipping backend
+    auto config = bench::Make_voronoi_config(options.scratch_dir, size, Voronoi_height(size), options.seed);
+    std::vector<world_builder::Point> points;
+    world_builder::Voronoi_builder builder(config.Get_width(), config.Get_height(),
+                                           config.Get_voronoi_scale_factor());
+    builder.Set_backend(world_builder::EVoronoi_backend::EVORONOI_BACKEND_Clipping);
+    auto result = bench::Measure(options, "voronoi_build_cells_clipping", size,
+                                 [&]() { points = Make_points(config); return points.size(); },
+                                 [&]() { builder.Build_cells(points); });
+    result.extra["collapsed_sites"] = builder.Get_collapsed_sites();
+    return result;
+  }});
+
+  kernels.push_back({"voronoi_build_cells_strips", [](const bench::Bench_options& options, int size)
+  {
+    // Same points as voronoi_build_cells, built in four strips per thread
+    auto config = bench::Make_voronoi_config(options.scratch_dir, size, Voronoi_height(size), options.seed);
+    int strips = 4 * static_cast<int>(world_builder::Task_scheduler::Instance().Get_thread_count());
+    std::vector<world_builder::Point> points;
+    world_builder::Voronoi_builder builder(config.Get_width(), config.Get_height(),
+                                           config.Get_voronoi_scale_factor());
+    builder.Set_strip_count(strips);
+    auto result = bench::Measure(options, "voronoi_build_cells_strips", size,
+                                 [&]() { points = Make_points(config); return points.size(); },
+                                 [&]() { builder.Build_cells(points); });
+    result.extra["strips"] = strips;
+    return result;
+  }});
+
+  kernels.push_back({"voronoi_build_cells_sphere", [](const bench::Bench_options& options, int size)
+  {
+    // As many sites as voronoi_build_cells, spread over a sphere, with no
+    // ghosts to build
+    auto config = bench::Make_voronoi_config(options.scratch_dir, size, Voronoi_height(size), options.seed);
+    std::vector<world_builder::Vec3> sites;
+    world_builder::Spherical_voronoi builder;
+    auto result = bench::Measure(options, "voronoi_build_cells_sphere", size,
+                                 [&]()
+                                 {
+                                   world_builder::Sphere_sampler sampler(Make_points(config).size(),
+                                                                         config.Get_sphere_jitter());
+                                   sites = sampler.Generate();
+                                   return sites.size();
+                                 },
+                                 [&]() { builder.Build_cells(sites); });
+    result.extra["vertices"] = builder.Get_vertices().size();
+    return result;
+  }});
+
+  kernels.push_back({"voronoi_relax_cells", [](const bench::Bench_options& options, int size)
+  {
+    auto config = bench::Make_voronoi_config(options.scratch_dir, size, Voronoi_height(size), options.seed);
+    std::optional<world_builder::Voronoi_builder> builder;
+    auto result = bench::Measure(options, "voronoi_relax_cells", size,
+                                 [&]()
+                                 {
+                                   auto points = Make_points(config);
+                                   builder.emplace(config.Get_width(), config.Get_height(),
+                                                   config.Get_voronoi_scale_factor());
+                                   builder->Build_cells(points);
+                                   return points.size();
+                                 },
+                                 [&]() { builder->Relax_cells(config.Get_relax_iterations()); });
+    result.extra["iterations"] = config.Get_relax_iterations();
+    result.extra["rebuilds"] = builder->Get_relax_rebuilds();
+    result.extra["energy"] = builder->Get_relax_energy();
+    return result;
+  }});
+
+  kernels.push_back({"voronoi_relax_cells_lbfgs", [](const bench::Bench_options& options, int size)
+  {
+    // Same points and iteration count as voronoi_relax_cells, with L-BFGS
+    auto config = bench::Make_voronoi_config(options.scratch_dir, size, Voronoi_height(size), options.seed);
+    std::optional<world_builder::Voronoi_builder> builder;
+    auto result = bench::Measure(options, "voronoi_relax_cells_lbfgs", size,
+                                 [&]()
+                                 {
+                                   auto points = Make_points(config);
+                                   builder.emplace(config.Get_width(), config.Get_height(),
+                                                   config.Get_voronoi_scale_factor());
+                                   builder->Set_relax_method(world_builder::ERelax_method::ERELAX_METHOD_Lbfgs);
+                                   builder->Build_cells(points);
+                                   return points.size();
+                                 },
+                                 [&]() { builder->Relax_cells(config.Get_relax_iterations()); });
+    result.extra["iterations"] = config.Get_relax_iterations();
+    result.extra["rebuilds"] = builder->Get_relax_rebuilds();
+    result.extra["energy"] = builder->Get_relax_energy();
+    return result;
+  }});
+
+  kernels.push_back({"voronoi_export_ppm", [](const bench::Bench_options& options, int size)
+  {
+    auto config = bench::Make_voronoi_config(options.scratch_dir, size, Voronoi_height(size), options.seed);
+    std::string filename = (options.scratch_dir / "bench_cells.ppm").string();
+    std::optional<world_builder::Voronoi_builder> builder;
+    auto result = bench::Measure(options, "voronoi_export_ppm", size,
+                                 [&]()
+                                 {
+                                   auto points = Make_points(config);
+                                   builder.emplace(config.Get_width(), config.Get_height(),
+                                                   config.Get_voronoi_scale_factor());
+                                   builder->Build_cells(points);
+                                   return points.size();
+                                 },
+                                 [&]() { builder->Export_PPM(filename); });
+    result.extra["pixels"] = static_cast<int64_t>(config.Get_width()) *
+                             static_cast<int64_t>(config.Get_height());
+    return result;
+  }});
+
+  kernels.push_back({"cell_hierarchy_build", [](const bench::Bench_options& options, int size)
+  {
+    // Link a coarse layer at 8x the spacing to the fine cells, then hand a
+    // value per coarse cell down to every fine cell
+    auto config = bench::Make_voronoi_config(options.scratch_dir, size, Voronoi_height(size), options.seed);
+    std::optional<world_builder::Voronoi_builder> coarse;
+    std::optional<world_builder::Voronoi_builder> fine;
+    world_builder::Cell_hierarchy hierarchy;
+    std::vector<double> coarse_values;
+    std::vector<double> fine_values;
+    auto result = bench::Measure(options, "cell_hierarchy_build", size,
+                                 [&]()
+                                 {
+                                   auto points = Make_points(config);
+                                   fine.emplace(config.Get_width(), config.Get_height(),
+                                                config.Get_voronoi_scale_factor());
+                                   fine->Build_cells(points);
+                                   world_builder::Poisson_disc sampler(config.Get_width(),
+                                                                       config.Get_height(),
+                                                                       8 * config.Get_min_distance(),
+                                                                       config.Get_attempts());
+                                   sampler.Set_wrap_x(config.Get_wrap_points());
+                                   coarse.emplace(config.Get_width(), config.Get_height(),
+                                                  config.Get_voronoi_scale_factor());
+                                   coarse->Build_cells(sampler.Generate());
+                                   coarse_values.assign(coarse->Get_cells().size(), 1.0);
+                                   return points.size();
+                                 },
+                                 [&]()
+                                 {
+                                   hierarchy.Build(*coarse, *fine);
+                                   hierarchy.Propagate(coarse_values, fine_values);
+                                 });
+    result.extra["coarse_cells"] = hierarchy.Get_coarse_count();
+    return result;
+  }});
+
+  kernels.push_back({"elevation_assign", [](const bench::Bench_options& options, int size)
+  {
+    // The cell graph is derived once in setup; every run after the first
+    // reuses the assigner's search buffers
+    auto config = bench::Make_voronoi_config(options.scratch_dir, size, Voronoi_height(size), options.seed);
+    std::optional<world_builder::Voronoi_builder> builder;
+    world_builder::Elevation_assigner assigner(0.8, 8, 6);
+    auto result = bench::Measure(options, "elevation_assign", size,
+                                 [&]()
+                                 {
+                                   auto points = Make_points(config);
+                                   builder.emplace(config.Get_width(), config.Get_height(),
+                                                   config.Get_voronoi_scale_factor());
+                                   builder->Build_cells(points);
+                                   builder->Get_cell_graph();
+                                   return points.size();
+                                 },
+                                 [&]()
+                                 {
+                                   assigner.Assign(builder->Get_cells(), builder->Get_cell_graph(),
+                                                   config.Get_width(), config.Get_height());
+                                 });
+    result.extra["links"] = builder->Get_cell_graph().neighbors.size();
+    return result;
+  }});
+
+  kernels.push_back({"river_route", [](const bench::Bench_options& options, int size)
+  {
+    // Elevation is assigned once in setup; the run routes flow over it and
+    // traces the rivers
+    auto config = bench::Make_voronoi_config(options.scratch_dir, size, Voronoi_height(size), options.seed);
+    std::optional<world_builder::Voronoi_builder> builder;
+    world_builder::Elevation_assigner assigner(0.8, 8, 6);
+    world_builder::River_network rivers;
+    auto result = bench::Measure(options, "river_route", size,
+                                 [&]()
+                                 {
+                                   auto points = Make_points(config);
+                                   builder.emplace(config.Get_width(), config.Get_height(),
+                                                   config.Get_voronoi_scale_factor());
+                                   builder->Build_cells(points);
+                                   assigner.Assign(builder->Get_cells(), builder->Get_cell_graph(),
+                                                   config.Get_width(), config.Get_height());
+                                   return points.size();
+                                 },
+                                 [&]()
+                                 {
+                                   rivers.Route(builder->Get_cell_graph(), assigner.Get_elevation());
+                                   rivers.Trace(builder->Get_cells(), config.Get_width(), 15);
+                                 });
+    result.extra["rivers"] = rivers.Get_river_count();
+    return result;
+  }});
+
+  kernels.push_back({"cell_bfs_nearest", [](const bench::Bench_options& options, int size)
+  {
+    // Distance and nearest coastal cell from the whole coast of an assigned
+    // island
+    auto config = bench::Make_voronoi_config(options.scratch_dir, size, Voronoi_height(size), options.seed);
+    std::optional<world_builder::Voronoi_builder> builder;
+    world_builder::Elevation_assigner assigner(0.8, 8, 6);
+    world_builder::Cell_bfs bfs;
+    std::vector<int> sources;
+    std::vector<int> distance;
+    std::vector<int> nearest;
+    auto result = bench::Measure(options, "cell_bfs_nearest", size,
+                                 [&]()
+                                 {
+                                   auto points = Make_points(config);
+                                   builder.emplace(config.Get_width(), config.Get_height(),
+                                                   config.Get_voronoi_scale_factor());
+                                   builder->Build_cells(points);
+                                   assigner.Assign(builder->Get_cells(), builder->Get_cell_graph(),
+                                                   config.Get_width(), config.Get_height());
+                                   sources.clear();
+                                   for(size_t i = 0; i < points.size(); ++i)
+                                   {
+                                     if(assigner.Get_land()[i] && assigner.Get_coast_distance()[i] == 0)
+                                     {
+                                       sources.push_back(static_cast<int>(i));
+                                     }
+                                   }
+                                   return points.size();
+                                 },
+                                 [&]() { bfs.Run(builder->Get_cell_graph(), sources, distance, &nearest); });
+    result.extra["sources"] = sources.size();
+    return result;
+  }});
+
+  kernels.push_back({"world_run_diffusion", [](const bench::Bench_options& options, int size)
+  {
+    auto config = bench::Make_tiles_config(options.scratch_dir, size, Tiles_height(size), options.seed);
+    std::unique_ptr<world_builder::World> world;
+    return bench::Measure(options, "world_run_diffusion", size,
+                          [&]() { world = Make_world(config, 2); return std::size_t(size) * Tiles_height(size); },
+                          [&]() { world->Run_diffusion(); });
+  }});
+
+  kernels.push_back({"hex_distance_transform", [](const bench::Bench_options& options, int size)
+  {
+    // Distance and nearest ocean tile over a world's ocean
+    auto config = bench::Make_tiles_config(options.scratch_dir, size, Tiles_height(size), options.seed);
+    world_builder::Hex_distance_transform transform;
+    std::vector<unsigned char> ocean;
+    std::vector<float> distance;
+    std::vector<int> nearest;
+    return bench::Measure(options, "hex_distance_transform", size,
+                          [&]()
+                          {
+                            auto world = Make_world(config, 5);
+                            const std::vector<float>& coast_distance = world->Get_coast_distance();
+                            ocean.resize(coast_distance.size());
+                            for(size_t i = 0; i < ocean.size(); ++i)
+                            {
+                              ocean[i] = coast_distance[i] == 0;
+                            }
+                            return ocean.size();
+                          },
+                          [&]()
+                          {
+                            transform.Run(ocean, config.Get_width(), config.Get_height(), distance, &nearest);
+                          });
+  }});
+
+  kernels.push_back({"world_run_rivers", [](const bench::Bench_options& options, int size)
+  {
+    auto config = bench::Make_tiles_config(options.scratch_dir, size, Tiles_height(size), options.seed);
+    std::unique_ptr<world_builder::World> world;
+    return bench::Measure(options, "world_run_rivers", size,
+                          [&]() { world = Make_world(config, 5); return std::size_t(size) * Tiles_height(size); },
+                          [&]() { world->Run_rivers(); });
+  }});
+
+  kernels.push_back({"world_run_moisture", [](const bench::Bench_options& options, int size)
+  {
+    auto config = bench::Make_tiles_config(options.scratch_dir, size, Tiles_height(size), options.seed);
+    std::unique_ptr<world_builder::World> world;
+    return bench::Measure(options, "world_run_moisture", size,
+                          [&]() { world = Make_world(config, 6); return std::size_t(size) * Tiles_height(size); },
+                          [&]() { world->Run_moisture(); });
+  }});
+
+  kernels.push_back({"world_run_temperature", [](const bench::Bench_options& options, int size)
+  {
+    auto config = bench::Make_tiles_config(options.scratch_dir, size, Tiles_height(size), options.seed);
+    std::unique_ptr<world_builder::World> world;
+    return bench::Measure(options, "world_run_temperature", size,
+                          [&]() { world = Make_world(config, 7); return std::size_t(size) * Tiles_height(size); },
+                          [&]() { world->Run_temperature(); });
+  }});
+
+  kernels.push_back({"world_paint_terrain", [](const bench::Bench_options& options, int size)
+  {
+    auto config = bench::Make_tiles_config(options.scratch_dir, size, Tiles_height(size), options.seed);
+    std::unique_ptr<world_builder::World> world;
+    return bench::Measure(options, "world_paint_terrain", size,
+                          [&]() { world = Make_world(config, 8); return std::size_t(size) * Tiles_height(size); },
+                          [&]() { world->Paint_terrain(); });
+  }});
+
+  kernels.push_back({"html_writer_write", [](const bench::Bench_options& options, int size)
+  {
+    auto config = bench::Make_tiles_config(options.scratch_dir, size, Tiles_height(size), options.seed);
+    world_builder::World_tiles tiles;
+    world_builder::HTML_writer writer(options.scratch_dir);
+    return bench::Measure(options, "html_writer_write", size,
+                          [&]()
+                          {
+                            tiles = Make_world(config, 9)->Get_world_tiles();
+                            return tiles.size();
+                          },
+                          [&]() { writer.Write(tiles, config, "bench_world.html"); });
+  }});
+
+  return kernels;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+int main(int argc, char *argv[])
+{
+  //////////////////////////////////////////////////////
+  // Config defaults
+  bench::Bench_options options;
+  options.scratch_dir = std::filesystem::temp_directory_path() / "world_builder_bench";
+  std::string sizes_string = "100,200,400";
+  std::string kernels_string;
+  std::string output_path = "world_builder_bench.json";
+  std::string scratch_string = options.scratch_dir.string();
+  unsigned threads = 1;
+
+  //////////////////////////////////////////////////////
+  // Set up the program options
+  namespace po = boost::program_options;
+
+  po::options_description desc("Benchmark options");
+  desc.add_options()
+      ("help", "Produce help message")
+      ("sizes",
+         po::value(&sizes_string)->default_value(sizes_string),
+         "Comma separated map widths to run every kernel at")
+      ("kernels",
+         po::value(&kernels_string),
+         "Comma separated kernels to run (default: all)")
+      ("warmup",
+         po::value(&options.warmup)->default_value(options.warmup),
+         "Untimed runs before measuring")
+      ("repetitions",
+         po::value(&options.repetitions)->default_value(options.repetitions),
+         "Timed runs per kernel and size")
+      ("seed",
+         po::value(&options.seed)->default_value(options.seed),
+         "Seed applied before every run")
+      ("threads",
+         po::value(&threads)->default_value(threads),
+         "Threads for the shared task scheduler, 0 for all cores")
+      ("scratch_dir",
+         po::value(&scratch_string)->default_value(scratch_string),
+         "Directory for generated configs and output files")
+      ("output",
+         po::value(&output_path)->default_value(output_path),
+         "JSON results file");
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  po::notify(vm);
+
+  std::vector<Kernel> kernels = Make_kernels();
+
+  if(vm.count("help"))
+  {
+    world_builder::Print_to_cout(desc);
+    std::string names;
+    for(const auto& kernel : kernels)
+    {
+      names += " " + kernel.name;
+    }
+    world_builder::Print_key_value_string("Kernels", names);
+    return 1;
+  }
+
+  options.scratch_dir = scratch_string;
+  std::filesystem::create_directories(options.scratch_dir);
+  world_builder::Task_scheduler::Instance().Set_thread_count(threads);
+
+  std::vector<std::string> selected = bench::Split_list(kernels_string);
+  std::vector<int> sizes;
+  for(const auto& size : bench::Split_list(sizes_string))
+  {
+    sizes.push_back(std::stoi(size));
+  }
+
+  //////////////////////////////////////////////////////
+  // Run
+
+  nlohmann::json results = nlohmann::json::array();
+  for(const auto& kernel : kernels)
+  {
+    if(!selected.empty() &&
+       std::find(selected.begin(), selected.end(), kernel.name) == selected.end())
+    {
+      continue;
+    }
+
+    for(int size : sizes)
+    {
+      bench::Bench_result result = kernel.run(options, size);
+      world_builder::Print_to_cout(kernel.name + " size " + std::to_string(size) +
+                                   ": median " + std::to_string(result.Get_median()) +
+                                   " s, p95 " + std::to_string(result.Get_p95()) + " s");
+      results.push_back(result.To_json());
+    }
+  }
+
+  nlohmann::json report;
+  report["seed"] = options.seed;
+  report["warmup"] = options.warmup;
+  report["repetitions"] = options.repetitions;
+  report["threads"] = world_builder::Task_scheduler::Instance().Get_thread_count();
+  report["results"] = results;
+
+  std::ofstream ofs(output_path);
+  if(!ofs)
+  {
+    world_builder::Print_to_cout("Failed to open results file " + output_path);
+    return 1;
+  }
+  ofs << report.dump(2) << "\n";
+  world_builder::Print_to_cout("Results written to " + output_path);
+
+  return 0;
+}
@@ -0,0 +1,427 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// JSON
+#include <deps/json.hpp>
+
+// Application files
+#include <bench_harness.h>
+#include <defs/dice_rolls.h>
+#include <utils/memory_tracker.h>
+#include <utils/pipelines.h>
+#include <utils/stage_profiler.h>
+#include <utils/stopwatch.h>
+#include <utils/task_scheduler.h>
+#include <utils/tiles_config.h>
+#include <utils/voronoi_config.h>
+#include <utils/world_builder_utils.h>
+
+///////////////////////////////////////////////////////////////////////
+
+namespace bench = world_builder::bench;
+
+///////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Poisson disc sampling with 30 attempts places roughly this many
+ * points per radius^2 of area; used to size maps for a target site count.
+ */
+constexpr double POISSON_POINTS_PER_RADIUS_SQ = 0.77;
+
+///////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief One cell of the scaling matrix
+ */
+struct Scaling_run
+{
+  /**
+   * @brief "voronoi" or "tiles"
+   */
+  std::string pipeline;
+
+  /**
+   * @brief Requested number of sites or tiles
+   */
+  int64_t size;
+
+  /**
+   * @brief Worker threads the run was allowed to use
+   */
+  int threads;
+
+  /**
+   * @brief Sites or tiles actually produced
+   */
+  int64_t items;
+
+  /**
+   * @brief Median wall time of the whole pipeline, in seconds
+   */
+  double seconds;
+
+  /**
+   * @brief Peak resident set size over the run, in kB
+   */
+  uint64_t peak_rss_kb;
+
+  /**
+   * @brief Bytes requested from the heap over the run
+   */
+  uint64_t alloc_bytes;
+
+  /**
+   * @brief Key used to match a run against the baseline
+   */
+  std::string Get_key() const
+  {
+    return pipeline + "/" + std::to_string(size) + "/" + std::to_string(threads);
+  }
+
+  /**
+   * @brief Machine-readable form of this run
+   */
+  nlohmann::json To_json() const
+  {
+    nlohmann::json out;
+    out["pipeline"] = pipeline;
+    out["size"] = size;
+    out["threads"] = threads;
+    out["items"] = items;
+    out["seconds"] = seconds;
+    out["items_per_s"] = seconds > 0.0 ? items / seconds : 0.0;
+    out["peak_rss_kb"] = peak_rss_kb;
+    out["alloc_bytes"] = alloc_bytes;
+    return out;
+  }
+};
+
+///////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Run the whole Voronoi pipeline, as world_builder does, sized for
+ * roughly `sites` cells
+ * @details The map is scaled to the site count at the config's spacing; a
+ * config that asks for an exact cell count, or for a sphere, is given
+ * `sites` as that count instead.
+ * @param options Seed and scratch directory
+ * @param config_path Production config to scale
+ * @param sites Target site count
+ * @param with_export Also write the PPM images
+ * @return Number of cells produced
+ */
+int64_t Run_voronoi(const bench::Bench_options& options,
+                    const std::filesystem::path& config_path,
+                    int64_t sites,
+                    bool with_export)
+{
+  world_builder::Voronoi_config base{std::ifstream(config_path)};
+  double radius = base.Get_min_distance();
+  double aspect = base.Get_width() / base.Get_height();
+  double area = sites * radius * radius / POISSON_POINTS_PER_RADIUS_SQ;
+  double height = std::sqrt(area / aspect);
+  double width = height * aspect;
+
+  nlohmann::json overrides = nlohmann::json::parse(std::ifstream(config_path));
+  if(base.Get_target_cell_count() > 0 || base.Get_spherical())
+  {
+    overrides["target_cell_count"] = sites;
+  }
+  world_builder::Voronoi_config config = bench::Make_voronoi_config(options.scratch_dir,
+                                                                    std::ceil(width),
+                                                                    std::ceil(height),
+                                                                    options.seed,
+                                                                    overrides);
+  config.Apply();
+
+  world_builder::Stage_profiler profiler(false);
+  const std::filesystem::path output_dir = options.scratch_dir / "scaling_voronoi";
+  if(with_export)
+  {
+    std::filesystem::create_directories(output_dir);
+  }
+  return static_cast<int64_t>(world_builder::Run_voronoi_pipeline(config,
+                                                                  with_export ? output_dir.string() : std::string(),
+                                                                  profiler));
+}
+
+///////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Run the whole tiles pipeline, as world_builder does, with roughly
+ * `tiles` tiles
+ * @param options Seed and scratch directory
+ * @param config_path Production config to scale
+ * @param tiles Target tile count
+ * @param with_export Also write the HTML map
+ * @return Number of tiles produced
+ */
+int64_t Run_tiles(const bench::Bench_options& options,
+                  const std::filesystem::path& config_path,
+                  int64_t tiles,
+                  bool with_export)
+{
+  world_builder::Tiles_config base{std::ifstream(config_path)};
+  double aspect = static_cast<double>(base.Get_width()) / base.Get_height();
+  uint32_t height = std::max<uint32_t>(1, static_cast<uint32_t>(std::round(std::sqrt(tiles / aspect))));
+  uint32_t width = std::max<uint32_t>(1, static_cast<uint32_t>(std::round(static_cast<double>(tiles) / height)));
+
+  nlohmann::json overrides = nlohmann::json::parse(std::ifstream(config_path));
+  world_builder::Tiles_config config = bench::Make_tiles_config(options.scratch_dir,
+                                                                width,
+                                                                height,
+                                                                options.seed,
+                                                                overrides);
+  config.Apply();
+
+  world_builder::Stage_profiler profiler(false);
+  const std::filesystem::path output_dir = options.scratch_dir / "scaling_tiles";
+  return static_cast<int64_t>(world_builder::Run_tiles_pipeline(config,
+                                                                with_export ? output_dir.string() : std::string(),
+                                                                profiler));
+}
+
+///////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Compare runs against a baseline
+ * @param runs Current runs
+ * @param baseline Baseline report, as written by --write_baseline
+ * @param threshold Allowed relative slowdown, e.g. 0.10 for 10%
+ * @return Number of regressions found
+ */
+int Compare_to_baseline(const std::vector<Scaling_run>& runs,
+                        const nlohmann::json& baseline,
+                        double threshold)
+{
+  int regressions = 0;
+  for(const auto& run : runs)
+  {
+    const nlohmann::json* match = nullptr;
+    for(const auto& entry : baseline.at("runs"))
+    {
+      if(entry.at("pipeline") == run.pipeline &&
+         entry.at("size") == run.size &&
+         entry.at("threads") == run.threads)
+      {
+        match = &entry;
+        break;
+      }
+    }
+
+    if(!match)
+    {
+      world_builder::Print_to_cout(run.Get_key() + ": no baseline entry");
+      continue;
+    }
+
+    double base_seconds = match->at("seconds");
+    double ratio = base_seconds > 0.0 ? run.seconds / base_seconds : 1.0;
+    std::string verdict = "ok";
+    if(ratio > 1.0 + threshold)
+    {
+      verdict = "REGRESSION";
+      regressions++;
+    }
+    else if(ratio < 1.0 - threshold)
+    {
+      verdict = "improved";
+    }
+
+    uint64_t base_rss = match->value("peak_rss_kb", uint64_t(0));
+    if(base_rss > 0 && run.peak_rss_kb > base_rss * (1.0 + threshold))
+    {
+      verdict += " (memory regression: " + std::to_string(base_rss) + " -> " +
+                 std::to_string(run.peak_rss_kb) + " kB)";
+      regressions++;
+    }
+
+    world_builder::Print_to_cout(run.Get_key() + ": " + std::to_string(run.seconds) +
+                                 " s vs baseline " + std::to_string(base_seconds) +
+                                 " s (x" + std::to_string(ratio) + ") " + verdict);
+  }
+  return regressions;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+int main(int argc, char *argv[])
+{
+  //////////////////////////////////////////////////////
+  // Config defaults
+  bench::Bench_options options;
+  options.repetitions = 1;
+  options.scratch_dir = std::filesystem::temp_directory_path() / "world_builder_scaling";
+  std::string scratch_string = options.scratch_dir.string();
+  std::string pipelines_string = "voronoi,tiles";
+  std::string sizes_string = "1000,10000,100000";
+  std::string threads_string = "1";
+  std::string voronoi_cfg_path = std::string(PROJECT_ROOT_DIR) + "/config/voronoi_gen_config.json";
+  std::string tiles_cfg_path = std::string(PROJECT_ROOT_DIR) + "/config/gen_params.json";
+  std::string output_path = "world_builder_scaling.json";
+  std::string baseline_path;
+  double threshold = 0.10;
+  bool write_baseline = false;
+  bool with_export = false;
+
+  //////////////////////////////////////////////////////
+  // Set up the program options
+  namespace po = boost::program_options;
+
+  po::options_description desc("Scaling options");
+  desc.add_options()
+      ("help", "Produce help message")
+      ("pipelines",
+         po::value(&pipelines_string)->default_value(pipelines_string),
+         "Comma separated pipelines to run: voronoi, tiles")
+      ("sizes",
+         po::value(&sizes_string)->default_value(sizes_string),
+         "Comma separated site/tile counts, e.g. 1000,10000,...,10000000")
+      ("threads",
+         po::value(&threads_string)->default_value(threads_string),
+         "Comma separated thread counts for the shared task scheduler")
+      ("repetitions",
+         po::value(&options.repetitions)->default_value(options.repetitions),
+         "Timed runs per matrix cell, the median is reported")
+      ("seed",
+         po::value(&options.seed)->default_value(options.seed),
+         "Seed applied to every run")
+      ("voronoi_cfg",
+         po::value(&voronoi_cfg_path)->default_value(voronoi_cfg_path),
+         "Voronoi config to scale")
+      ("tiles_cfg",
+         po::value(&tiles_cfg_path)->default_value(tiles_cfg_path),
+         "Tiles config to scale")
+      ("with_export",
+         po::bool_switch(&with_export),
+         "Include the PPM/HTML exporters in the timed pipeline")
+      ("scratch_dir",
+         po::value(&scratch_string)->default_value(scratch_string),
+         "Directory for generated configs and output files")
+      ("output",
+         po::value(&output_path)->default_value(output_path),
+         "JSON results file")
+      ("baseline",
+         po::value(&baseline_path),
+         "Baseline JSON to compare against (or to write with --write_baseline)")
+      ("threshold",
+         po::value(&threshold)->default_value(threshold),
+         "Relative slowdown flagged as a regression")
+      ("write_baseline",
+         po::bool_switch(&write_baseline),
+         "Store these results as the new baseline");
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  po::notify(vm);
+
+  if(vm.count("help"))
+  {
+    world_builder::Print_to_cout(desc);
+    return 1;
+  }
+
+  options.scratch_dir = scratch_string;
+  std::filesystem::create_directories(options.scratch_dir);
+  world_builder::memory::Set_tracking_enabled(true);
+
+  //////////////////////////////////////////////////////
+  // Run the matrix
+
+  std::vector<Scaling_run> runs;
+  for(const auto& pipeline : bench::Split_list(pipelines_string))
+  {
+    if(pipeline != "voronoi" && pipeline != "tiles")
+    {
+      world_builder::Print_to_cout("Unknown pipeline " + pipeline);
+      return 1;
+    }
+
+    for(const auto& size_string : bench::Split_list(sizes_string))
+    {
+      for(const auto& threads_entry : bench::Split_list(threads_string))
+      {
+        Scaling_run run{pipeline, std::stoll(size_string), std::stoi(threads_entry), 0, 0.0, 0, 0};
+
+        world_builder::Task_scheduler::Instance().Set_thread_count(run.threads);
+
+        std::vector<double> samples;
+        for(int rep = 0; rep < std::max(1, options.repetitions); ++rep)
+        {
+          world_builder::memory::Reset_peak_rss();
+          world_builder::memory::Reset_alloc_stats();
+
+          world_builder::Stopwatch timer;
+          timer.Start();
+          run.items = (pipeline == "voronoi") ?
+                Run_voronoi(options, voronoi_cfg_path, run.size, with_export) :
+                Run_tiles(options, tiles_cfg_path, run.size, with_export);
+          timer.Stop();
+
+          samples.push_back(timer.Get_time());
+          run.peak_rss_kb = std::max(run.peak_rss_kb, world_builder::memory::Get_peak_rss_kb());
+          run.alloc_bytes = world_builder::memory::Get_alloc_stats().bytes;
+        }
+
+        std::sort(samples.begin(), samples.end());
+        run.seconds = samples[samples.size() / 2];
+        runs.push_back(run);
+
+        world_builder::Print_to_cout(run.Get_key() + ": " + std::to_string(run.items) + " items, " +
+                                     std::to_string(run.seconds) + " s, " +
+                                     std::to_string(run.seconds > 0.0 ? run.items / run.seconds : 0.0) +
+                                     " items/s, peak RSS " + std::to_string(run.peak_rss_kb) + " kB");
+      }
+    }
+  }
+
+  //////////////////////////////////////////////////////
+  // Report
+
+  nlohmann::json report;
+  report["seed"] = options.seed;
+  report["voronoi_cfg"] = voronoi_cfg_path;
+  report["tiles_cfg"] = tiles_cfg_path;
+  report["with_export"] = with_export;
+  report["runs"] = nlohmann::json::array();
+  for(const auto& run : runs)
+  {
+    report["runs"].push_back(run.To_json());
+  }
+
+  std::ofstream(output_path) << report.dump(2) << "\n";
+  world_builder::Print_to_cout("Results written to " + output_path);
+
+  if(baseline_path.empty())
+  {
+    return 0;
+  }
+
+  if(write_baseline)
+  {
+    std::ofstream(baseline_path) << report.dump(2) << "\n";
+    world_builder::Print_to_cout("Baseline written to " + baseline_path);
+    return 0;
+  }
+
+  std::ifstream baseline_file(baseline_path);
+  if(!baseline_file)
+  {
+    world_builder::Print_to_cout("Failed to open baseline " + baseline_path);
+    return 1;
+  }
+
+  int regressions = Compare_to_baseline(runs, nlohmann::json::parse(baseline_file), threshold);
+  world_builder::Print_key_value("Regressions", regressions);
+  return regressions > 0 ? 2 : 0;
+}
@@ -0,0 +1,256 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+#include <cmath>
+
+// Application files
+#include <defs/batch_rng.h>
+
+///////////////////////////////////////////////////////////////////////
+
+using br = world_builder::dice::Batch_rng;
+
+///////////////////////////////////////////////////////////////////////
+
+namespace
+{
+/**
+ * @brief 2^-53, turns the top 53 bits into a double in [0, 1)
+ */
+constexpr double UNIT_DOUBLE = 0x1.0p-53;
+
+/**
+ * @brief SplitMix64 step, used only to expand seeds
+ */
+uint64_t Split_mix(uint64_t& state)
+{
+  uint64_t value = (state += 0x9e3779b97f4a7c15ULL);
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+  return value ^ (value >> 31);
+}
+
+/**
+ * @brief 64-bit rotate left
+ */
+inline uint64_t Rotl(uint64_t value, int shift)
+{
+  return (value << shift) | (value >> (64 - shift));
+}
+}
+
+///////////////////////////////////////////////////////////////////////
+
+br::Batch_rng()
+  :
+  Batch_rng(Draw_seed())
+{ }
+
+///////////////////////////////////////////////////////////////////////
+
+br::Batch_rng(uint64_t seed)
+  :
+  m_s0(),
+  m_s1(),
+  m_s2(),
+  m_s3(),
+  m_block(),
+  m_next(LANES)
+{
+  seed_lanes(seed);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+br::Batch_rng(ERng_stream stream, uint64_t index)
+  :
+  Batch_rng(Get_stream_bits(stream, index))
+{ }
+
+///////////////////////////////////////////////////////////////////////
+
+uint64_t br::Next_bits()
+{
+  if(m_next == LANES)
+  {
+    step();
+  }
+  return m_block[m_next++];
+}
+
+///////////////////////////////////////////////////////////////////////
+
+uint64_t br::Next_below(uint64_t bound)
+{
+  // Lemire's multiply-shift; the bias is below 2^-32 for any bound we use
+  return static_cast<uint64_t>((static_cast<unsigned __int128>(Next_bits()) * bound) >> 64);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+double br::Next_uniform(double min_value, double max_value)
+{
+  return min_value + static_cast<double>(Next_bits() >> 11) * UNIT_DOUBLE * (max_value - min_value);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void br::Fill_uniform(double* out, size_t count, double min_value, double max_value)
+{
+  const double scale = (max_value - min_value) * UNIT_DOUBLE;
+  size_t i = 0;
+
+  // Drain what is left of the current block so whole blocks line up
+  while(i < count && m_next < LANES)
+  {
+    out[i++] = min_value + static_cast<double>(m_block[m_next++] >> 11) * scale;
+  }
+
+  // Whole blocks, converted lane-parallel
+  while(count - i >= LANES)
+  {
+    step();
+    for(size_t lane = 0; lane < LANES; ++lane)
+    {
+      out[i + lane] = min_value + static_cast<double>(m_block[lane] >> 11) * scale;
+    }
+    m_next = LANES;
+    i += LANES;
+  }
+
+  while(i < count)
+  {
+    out[i++] = min_value + static_cast<double>(Next_bits() >> 11) * scale;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void br::Fill_normal(double* out, size_t count, double mean, double stddev)
+{
+  for(size_t i = 0; i < count; i += 2)
+  {
+    // 1 - u keeps the log argument in (0, 1]
+    double u1 = 1.0 - static_cast<double>(Next_bits() >> 11) * UNIT_DOUBLE;
+    double u2 = static_cast<double>(Next_bits() >> 11) * UNIT_DOUBLE;
+    double radius = std::sqrt(-2.0 * std::log(u1)) * stddev;
+    double angle = 2.0 * M_PI * u2;
+
+    out[i] = mean + radius * std::cos(angle);
+    if(i + 1 < count)
+    {
+      out[i + 1] = mean + radius * std::sin(angle);
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void br::Fill_angles(double* out, size_t count)
+{
+  Fill_uniform(out, count, 0.0, 2.0 * M_PI);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void br::Fill_directions(double* cos_out, double* sin_out, size_t count)
+{
+  // Split each angle into a quarter turn and an offset r in [-π/4, π/4)
+  // around the middle of that quarter, then rotate (cos r, sin r) into place.
+  // Taylor terms up to r^12 are accurate to 1e-11 on that interval.
+  constexpr double HALF_SQRT2 = 0.70710678118654752440;
+
+  // The uniforms are staged in cos_out and replaced in place
+  Fill_uniform(cos_out, count, 0.0, 4.0);
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    double quarter = std::floor(cos_out[i]);
+    double r = (cos_out[i] - quarter - 0.5) * (M_PI / 2.0);
+    double r2 = r * r;
+
+    double sin_r = r * (1.0 + r2 * (-1.0 / 6 + r2 * (1.0 / 120 + r2 * (-1.0 / 5040 +
+                   r2 * (1.0 / 362880 + r2 * (-1.0 / 39916800))))));
+    double cos_r = 1.0 + r2 * (-1.0 / 2 + r2 * (1.0 / 24 + r2 * (-1.0 / 720 +
+                   r2 * (1.0 / 40320 + r2 * (-1.0 / 3628800 + r2 * (1.0 / 479001600))))));
+
+    // Angle within the quarter is π/4 + r
+    double c = (cos_r - sin_r) * HALF_SQRT2;
+    double s = (sin_r + cos_r) * HALF_SQRT2;
+
+    // Rotate by whole quarter turns, written as selects so it vectorizes
+    double qc = (quarter == 0.0) ? c : (quarter == 1.0) ? -s : (quarter == 2.0) ? -c : s;
+    double qs = (quarter == 0.0) ? s : (quarter == 1.0) ? c : (quarter == 2.0) ? -s : -c;
+    cos_out[i] = qc;
+    sin_out[i] = qs;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void br::Fill_colors(std::array<unsigned char, 3>* out,
+                     size_t count,
+                     int min_value,
+                     int max_value)
+{
+  const uint64_t span = static_cast<uint64_t>(max_value - min_value + 1);
+  for(size_t i = 0; i < count; ++i)
+  {
+    // 16 bits per channel, scaled into range without division
+    uint64_t bits = Next_bits();
+    out[i] = {
+        static_cast<unsigned char>(min_value + ((bits & 0xffff) * span >> 16)),
+        static_cast<unsigned char>(min_value + (((bits >> 16) & 0xffff) * span >> 16)),
+        static_cast<unsigned char>(min_value + (((bits >> 32) & 0xffff) * span >> 16))
+    };
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void br::seed_lanes(uint64_t seed)
+{
+  uint64_t state = seed;
+  for(size_t lane = 0; lane < LANES; ++lane)
+  {
+    m_s0[lane] = Split_mix(state);
+    m_s1[lane] = Split_mix(state);
+    m_s2[lane] = Split_mix(state);
+    m_s3[lane] = Split_mix(state);
+  }
+  m_next = LANES;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void br::step()
+{
+  // xoshiro256+, written over whole lane arrays so it vectorizes
+  for(size_t lane = 0; lane < LANES; ++lane)
+  {
+    uint64_t s0 = m_s0[lane];
+    uint64_t s1 = m_s1[lane];
+    uint64_t s2 = m_s2[lane];
+    uint64_t s3 = m_s3[lane];
+
+    m_block[lane] = s0 + s3;
+
+    uint64_t t = s1 << 17;
+    s2 ^= s0;
+    s3 ^= s1;
+    s1 ^= s2;
+    s0 ^= s3;
+    s2 ^= t;
+    s3 = Rotl(s3, 45);
+
+    m_s0[lane] = s0;
+    m_s1[lane] = s1;
+    m_s2[lane] = s2;
+    m_s3[lane] = s3;
+  }
+  m_next = 0;
+}
+
+///////////////////////////////////////////////////////////////////////
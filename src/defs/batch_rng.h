@@ -0,0 +1,149 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef BATCH_RNG_H
+#define BATCH_RNG_H
+
+// Standard libs
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// JSON
+
+// Application files
+#include <defs/dice_rolls.h>
+
+namespace world_builder
+{
+namespace dice
+{
+
+/**
+ * @brief Bulk random number generator for hot loops
+ * @details Runs `LANES` independent xoshiro256+ generators side by side with
+ * their state stored lane-major, so one step of every lane is a straight-line
+ * loop of shifts, xors and adds that the compiler turns into SIMD. Callers
+ * draw a whole block of values at once instead of paying a call and a
+ * distribution object per scalar, as `Make_a_roll` does.
+ *
+ * The sequence depends only on how the generator was seeded, never on the
+ * batch sizes used to drain it.
+ */
+class Batch_rng
+{
+public:
+  // Attributes
+  /**
+   * @brief Independent generators stepped together
+   */
+  static constexpr size_t LANES = 8;
+
+  // Implementation
+  /**
+   * @brief Seed from the shared dice generator, so a seeded run stays
+   * reproducible
+   */
+  Batch_rng();
+
+  /**
+   * @brief Seed explicitly
+   * @param seed Any value; the lanes are expanded from it with SplitMix64
+   */
+  explicit Batch_rng(uint64_t seed);
+
+  /**
+   * @brief Seed from one element of a counter-based stream, so independent
+   * blocks of work can each own a generator that does not depend on which
+   * thread runs them
+   * @param stream The stream
+   * @param index The block index within the stream
+   */
+  Batch_rng(ERng_stream stream, uint64_t index);
+
+  /**
+   * @brief Next raw 64 bits
+   */
+  uint64_t Next_bits();
+
+  /**
+   * @brief Uniform integer in [0, bound), bound must be non-zero
+   */
+  uint64_t Next_below(uint64_t bound);
+
+  /**
+   * @brief Uniform double in [min_value, max_value)
+   */
+  double Next_uniform(double min_value, double max_value);
+
+  /**
+   * @brief Fill `out[0..count)` with uniform doubles in [min_value, max_value)
+   */
+  void Fill_uniform(double* out, size_t count, double min_value, double max_value);
+
+  /**
+   * @brief Fill `out[0..count)` with normally distributed doubles
+   * @details Box-Muller on pairs of uniforms, so values come two at a time.
+   */
+  void Fill_normal(double* out, size_t count, double mean, double stddev);
+
+  /**
+   * @brief Fill `out[0..count)` with uniform angles in [0, 2π)
+   */
+  void Fill_angles(double* out, size_t count);
+
+  /**
+   * @brief Fill `cos_out` and `sin_out` with the cosine and sine of `count`
+   * uniform angles, i.e. random unit vectors
+   * @details Uses a branch-free polynomial sincos (error below 1e-11) instead
+   * of libm, so the loop vectorizes.
+   */
+  void Fill_directions(double* cos_out, double* sin_out, size_t count);
+
+  /**
+   * @brief Fill `out[0..count)` with random RGB colors, one draw per color
+   * @param min_value Min channel value
+   * @param max_value Max channel value
+   */
+  void Fill_colors(std::array<unsigned char, 3>* out,
+                   size_t count,
+                   int min_value = 50,
+                   int max_value = 255);
+
+private:
+  // Attributes
+  /**
+   * @brief xoshiro256+ state, one word of each lane per array
+   */
+  alignas(64) std::array<uint64_t, LANES> m_s0;
+  alignas(64) std::array<uint64_t, LANES> m_s1;
+  alignas(64) std::array<uint64_t, LANES> m_s2;
+  alignas(64) std::array<uint64_t, LANES> m_s3;
+
+  /**
+   * @brief Output of the last step, handed out front to back
+   */
+  alignas(64) std::array<uint64_t, LANES> m_block;
+
+  /**
+   * @brief Next unread value in m_block, LANES when empty
+   */
+  size_t m_next;
+
+  // Implementation
+  /**
+   * @brief Expand a seed into every lane's state
+   */
+  void seed_lanes(uint64_t seed);
+
+  /**
+   * @brief Step every lane once, refilling m_block
+   */
+  void step();
+};
+
+}
+}
+
+#endif
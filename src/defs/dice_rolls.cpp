@@ -7,6 +7,31 @@
 
 ///////////////////////////////////////////////////////////////////////
 
+namespace
+{
+/**
+ * @brief SplitMix64 finalizer, a cheap bijective mix of all 64 bits
+ */
+uint64_t Mix_bits(uint64_t value)
+{
+  value += 0x9e3779b97f4a7c15ULL;
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+  return value ^ (value >> 31);
+}
+
+/**
+ * @brief Key the streams are derived from, follows the generator's seed
+ */
+uint64_t& Get_stream_key()
+{
+  static uint64_t key = Mix_bits(std::random_device{}());
+  return key;
+}
+}
+
+///////////////////////////////////////////////////////////////////////
+
 std::mt19937& world_builder::dice::Get_generator()
 {
   static std::random_device rd;
@@ -16,6 +41,30 @@ std::mt19937& world_builder::dice::Get_generator()
 
 ///////////////////////////////////////////////////////////////////////
 
+void world_builder::dice::Set_seed(unsigned seed)
+{
+  Get_generator().seed(seed);
+  Get_stream_key() = Mix_bits(seed);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+uint64_t world_builder::dice::Draw_seed()
+{
+  uint64_t high = Get_generator()();
+  return (high << 32) | Get_generator()();
+}
+
+///////////////////////////////////////////////////////////////////////
+
+uint64_t world_builder::dice::Get_stream_bits(ERng_stream stream, uint64_t index)
+{
+  uint64_t stream_key = Mix_bits(Get_stream_key() ^ static_cast<uint64_t>(stream));
+  return Mix_bits(stream_key ^ Mix_bits(index));
+}
+
+///////////////////////////////////////////////////////////////////////
+
 bool world_builder::dice::Flip_a_coin()
 {
   return static_cast<bool>(Make_a_roll<int8_t>(1, 0));
@@ -9,6 +9,7 @@
 #include <stdexcept>
 #include <random>
 #include <array>
+#include <cstdint>
 
 // JSON
 
@@ -28,6 +29,61 @@ namespace dice
  */
 std::mt19937& Get_generator();
 
+/**
+ * @brief Re-seed the singleton generator, making every following roll
+ * reproducible
+ * @param seed The new seed
+ */
+void Set_seed(unsigned seed);
+
+/**
+ * @brief Draw 64 bits from the singleton generator, for seeding other
+ * generators reproducibly
+ */
+uint64_t Draw_seed();
+
+/**
+ * @brief Independent random streams for work that runs in parallel
+ * @details Each stream is a counter-based generator: a roll is a hash of the
+ * seed, the stream and an element index, so every element gets the same value
+ * no matter which thread draws it or in what order.
+ */
+enum class ERng_stream : uint64_t
+{
+  ERNG_STREAM_Diffusion,    ///< Diffusion noise, index is pass * blocks + block
+  ERNG_STREAM_Rivers,       ///< Per-tile river spawn roll
+  ERNG_STREAM_Cell_colors,  ///< Cell visualization colors, one block for all cells
+  ERNG_STREAM_Elevation,    ///< Cell coastline shape and mountain seeds, one block
+  ERNG_STREAM_Count         ///< Size of options enum
+};
+
+/**
+ * @brief Raw 64 bits for one element of a stream, derived from the seed last
+ * passed to Set_seed()
+ * @param stream The stream
+ * @param index The element index within the stream
+ * @return Well-mixed random bits
+ */
+uint64_t Get_stream_bits(ERng_stream stream, uint64_t index);
+
+/**
+ * @brief Uniform roll in [min_value, max_value) for one element of a stream
+ * @param stream The stream
+ * @param index The element index within the stream
+ * @param min_value
+ * @param max_value
+ * @return The roll, identical for the same seed, stream and index
+ */
+template<typename T>
+T Make_stream_roll(ERng_stream stream, uint64_t index, T min_value, T max_value)
+{
+  static_assert(std::is_floating_point_v<T>, "Make_stream_roll requires floating point type");
+
+  // Top 53 bits give every double in [0, 1) with equal spacing
+  T unit = static_cast<T>(Get_stream_bits(stream, index) >> 11) * static_cast<T>(0x1.0p-53);
+  return min_value + unit * (max_value - min_value);
+}
+
 /**
  * @brief Generate a random number between min and max
  * @param min_value
@@ -0,0 +1,247 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+#include <limits>
+#include <stdexcept>
+
+// JSON
+#include <deps/json.hpp>
+
+// Application files
+#include <geo_models/biome_table.h>
+#include <utils/task_scheduler.h>
+
+///////////////////////////////////////////////////////////////////////
+
+using bt = world_builder::Biome_table;
+
+///////////////////////////////////////////////////////////////////////
+
+world_builder::Biome_rule::Biome_rule(const std::string& biome)
+  :
+  biome(biome),
+  min(),
+  max(),
+  coast(ECoast_rule::ECOAST_RULE_Any),
+  color({128, 128, 128})
+{
+  min.fill(-std::numeric_limits<double>::infinity());
+  max.fill(std::numeric_limits<double>::infinity());
+}
+
+///////////////////////////////////////////////////////////////////////
+
+bt::Biome_table(const std::vector<Biome_rule>& rules)
+  :
+  m_axes(),
+  m_table(),
+  m_names(),
+  m_colors()
+{
+  // Biome ids in order of first appearance, and the id of every rule
+  std::vector<uint8_t> rule_biome(rules.size());
+  for (size_t r = 0; r < rules.size(); r++)
+  {
+    for (size_t a = 0; a < m_axes.size(); a++)
+    {
+      if (!(rules[r].min[a] < rules[r].max[a]))
+        throw std::invalid_argument("Biome rule for " + rules[r].biome + " has an empty " +
+                                    std::string(Enum_to_string(static_cast<EBiome_axis>(a), BIOME_AXIS_LOOKUP)) +
+                                    " range");
+    }
+
+    auto found = std::find(m_names.begin(), m_names.end(), rules[r].biome);
+    if (found == m_names.end())
+    {
+      if (m_names.size() == UNCLASSIFIED)
+        throw std::invalid_argument("Too many biomes");
+      m_names.push_back(rules[r].biome);
+      m_colors.push_back(rules[r].color);
+      found = m_names.end() - 1;
+    }
+    rule_biome[r] = static_cast<uint8_t>(found - m_names.begin());
+  }
+
+  for (size_t a = 0; a < m_axes.size(); a++)
+  {
+    m_axes[a] = build_axis(rules, a);
+  }
+
+  // No rule changes its mind inside an interval, so any point of it stands
+  // for all of it
+  auto sample = [](const Axis& axis, size_t k)
+  {
+    const double lo = axis.edges[k];
+    const double hi = axis.edges[k + 1];
+    if (std::isinf(lo) && std::isinf(hi))
+      return 0.0;
+    if (std::isinf(lo))
+      return hi - 1.0;
+    if (std::isinf(hi))
+      return lo + 1.0;
+    return 0.5 * (lo + hi);
+  };
+
+  const size_t ne = m_axes[0].Interval_count();
+  const size_t nm = m_axes[1].Interval_count();
+  const size_t nt = m_axes[2].Interval_count();
+  m_table.assign(2 * nt * nm * ne, UNCLASSIFIED);
+  for (size_t coastal = 0; coastal < 2; coastal++)
+  {
+    for (size_t t = 0; t < nt; t++)
+    {
+      for (size_t m = 0; m < nm; m++)
+      {
+        for (size_t e = 0; e < ne; e++)
+        {
+          const double value[3] = {sample(m_axes[0], e), sample(m_axes[1], m), sample(m_axes[2], t)};
+          for (size_t r = 0; r < rules.size(); r++)
+          {
+            bool match = (rules[r].coast == ECoast_rule::ECOAST_RULE_Any) ||
+                         (rules[r].coast == ECoast_rule::ECOAST_RULE_Coastal) == (coastal == 1);
+            for (size_t a = 0; a < 3 && match; a++)
+            {
+              match = (value[a] >= rules[r].min[a] && value[a] < rules[r].max[a]);
+            }
+            if (match)
+            {
+              m_table[((coastal * nt + t) * nm + m) * ne + e] = rule_biome[r];
+              break;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+
+std::vector<world_builder::Biome_rule> bt::Parse_rules(const std::string& json_text)
+{
+  nlohmann::json rules_data = nlohmann::json::parse(json_text);
+  if (!rules_data.is_array())
+    throw std::invalid_argument("Biome rules must be an array");
+
+  std::vector<Biome_rule> rules;
+  for (const auto& rule_data : rules_data)
+  {
+    if (!rule_data.is_object() || !rule_data.contains("biome") || !rule_data["biome"].is_string())
+      throw std::invalid_argument("Every biome rule needs a \"biome\" name");
+    Biome_rule rule(rule_data["biome"].get<std::string>());
+
+    for (size_t a = 0; a < rule.min.size(); a++)
+    {
+      const std::string key(Enum_to_string(static_cast<EBiome_axis>(a), BIOME_AXIS_LOOKUP));
+      if (!rule_data.contains(key))
+        continue;
+      const auto& range = rule_data[key];
+      if (!range.is_array() || range.size() != 2 || !range[0].is_number() || !range[1].is_number())
+        throw std::invalid_argument("Biome rule for " + rule.biome + ": \"" + key + "\" must be [min, max]");
+      rule.min[a] = range[0].get<double>();
+      rule.max[a] = range[1].get<double>();
+    }
+
+    if (rule_data.contains("coast"))
+    {
+      try
+      {
+        rule.coast = String_to_enum(rule_data["coast"].get<std::string>(), COAST_RULE_LOOKUP);
+      }
+      catch (const std::exception&)
+      {
+        throw std::invalid_argument("Biome rule for " + rule.biome + ": \"coast\" must be any, coastal or inland");
+      }
+    }
+
+    if (rule_data.contains("color"))
+    {
+      const auto& color = rule_data["color"];
+      if (!color.is_array() || color.size() != 3)
+        throw std::invalid_argument("Biome rule for " + rule.biome + ": \"color\" must be [r, g, b]");
+      for (size_t c = 0; c < 3; c++)
+      {
+        rule.color[c] = static_cast<unsigned char>(std::clamp(color[c].get<int>(), 0, 255));
+      }
+    }
+    rules.push_back(rule);
+  }
+  return rules;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void bt::Classify_all(const double* elevation,
+                      const double* moisture,
+                      const double* temperature,
+                      const unsigned char* coastal,
+                      size_t count,
+                      uint8_t* out) const
+{
+  Task_scheduler::Instance().Parallel_for(0, count, 4096, [&](size_t lo, size_t hi)
+  {
+    for (size_t i = lo; i < hi; i++)
+    {
+      out[i] = Classify(elevation[i],
+                        moisture ? moisture[i] : 0.0,
+                        temperature ? temperature[i] : 0.0,
+                        coastal && coastal[i]);
+    }
+  });
+}
+
+///////////////////////////////////////////////////////////////////////
+
+bt::Axis bt::build_axis(const std::vector<Biome_rule>& rules, size_t axis)
+{
+  Axis out;
+  std::vector<double> cuts;
+  for (const auto& rule : rules)
+  {
+    if (std::isfinite(rule.min[axis]))
+      cuts.push_back(rule.min[axis]);
+    if (std::isfinite(rule.max[axis]))
+      cuts.push_back(rule.max[axis]);
+  }
+  std::sort(cuts.begin(), cuts.end());
+  cuts.erase(std::unique(cuts.begin(), cuts.end()), cuts.end());
+
+  out.edges.push_back(-std::numeric_limits<double>::infinity());
+  out.edges.insert(out.edges.end(), cuts.begin(), cuts.end());
+  out.edges.push_back(std::numeric_limits<double>::infinity());
+  if (cuts.size() < 2)
+  {
+    // No bucket grid needed: one step up from the first interval at most
+    out.start = 0.0;
+    out.scale = 0.0;
+    out.buckets.assign(1, 0);
+    return out;
+  }
+
+  // Buckets no wider than the closest pair of cuts, so a bucket rarely
+  // holds more than one, plus one spare bucket at each end
+  double min_gap = cuts.back() - cuts.front();
+  for (size_t k = 1; k < cuts.size(); k++)
+  {
+    min_gap = std::min(min_gap, cuts[k] - cuts[k - 1]);
+  }
+  const double span = cuts.back() - cuts.front();
+  const size_t inner = std::min<size_t>(MAX_BUCKETS - 2, static_cast<size_t>(std::ceil(span / min_gap)));
+  const double width = span / inner;
+  out.start = cuts.front() - width;
+  out.scale = 1.0 / width;
+  out.buckets.resize(inner + 2);
+
+  // Each bucket starts at the interval half a bucket before it, which is
+  // never past the interval of any value rounding into it
+  for (size_t b = 0; b < out.buckets.size(); b++)
+  {
+    const double at = out.start + (b - 0.5) * width;
+    out.buckets[b] = static_cast<uint16_t>(std::upper_bound(cuts.begin(), cuts.end(), at) - cuts.begin());
+  }
+  return out;
+}
+
+///////////////////////////////////////////////////////////////////////
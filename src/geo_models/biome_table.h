@@ -0,0 +1,249 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef BIOME_TABLE_H
+#define BIOME_TABLE_H
+
+// Standard libs
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// JSON
+
+// Application files
+#include <utils/world_builder_utils.h>
+
+namespace world_builder
+{
+
+/**
+ * @brief Climate quantities biome rules test
+ */
+enum class EBiome_axis : uint8_t
+{
+  EBIOME_AXIS_Elevation,    ///< Elevation
+  EBIOME_AXIS_Moisture,     ///< Moisture
+  EBIOME_AXIS_Temperature,  ///< Temperature
+  EBIOME_AXIS_Count         ///< Size of options enum
+};
+
+/**
+ * @brief Lookup table mapping biome axes to their rule keys
+ */
+constexpr std::array<Enum_mapping<EBiome_axis>,
+                     static_cast<size_t>(EBiome_axis::EBIOME_AXIS_Count)> BIOME_AXIS_LOOKUP = {
+  Enum_mapping{EBiome_axis::EBIOME_AXIS_Elevation,   "elevation"},
+  Enum_mapping{EBiome_axis::EBIOME_AXIS_Moisture,    "moisture"},
+  Enum_mapping{EBiome_axis::EBIOME_AXIS_Temperature, "temperature"}
+};
+
+/**
+ * @brief Which side of the coast a biome rule applies to
+ */
+enum class ECoast_rule : uint8_t
+{
+  ECOAST_RULE_Any,      ///< Coastal or not
+  ECOAST_RULE_Coastal,  ///< Only next to the sea
+  ECOAST_RULE_Inland,   ///< Only away from the sea
+  ECOAST_RULE_Count     ///< Size of options enum
+};
+
+/**
+ * @brief Lookup table mapping coast rules to their rule values
+ */
+constexpr std::array<Enum_mapping<ECoast_rule>,
+                     static_cast<size_t>(ECoast_rule::ECOAST_RULE_Count)> COAST_RULE_LOOKUP = {
+  Enum_mapping{ECoast_rule::ECOAST_RULE_Any,     "any"},
+  Enum_mapping{ECoast_rule::ECOAST_RULE_Coastal, "coastal"},
+  Enum_mapping{ECoast_rule::ECOAST_RULE_Inland,  "inland"}
+};
+
+/**
+ * @brief One biome rule: the biome applies where every axis is inside its
+ * range [min, max) and the coast rule holds
+ */
+struct Biome_rule
+{
+  /**
+   * @brief Name of the biome
+   */
+  std::string biome;
+
+  /**
+   * @brief Range of each axis, by EBiome_axis; unbounded by default
+   */
+  std::array<double, static_cast<size_t>(EBiome_axis::EBIOME_AXIS_Count)> min;
+  std::array<double, static_cast<size_t>(EBiome_axis::EBIOME_AXIS_Count)> max;
+
+  /**
+   * @brief Which side of the coast it applies to
+   */
+  ECoast_rule coast;
+
+  /**
+   * @brief Map color of the biome
+   */
+  std::array<unsigned char, 3> color;
+
+  /**
+   * @brief Constructor, for a rule matching everywhere
+   * @param biome Name of the biome
+   */
+  explicit Biome_rule(const std::string& biome);
+};
+
+/**
+ * @brief Biome rules compiled into a dense lookup table
+ * @details Rules are tried in order and the first that matches wins. Every
+ * axis is cut at each rule's range ends into intervals no rule can tell
+ * apart, and the winning biome is worked out once per combination of
+ * intervals and coast side at construction. Classifying a value then finds
+ * its interval on each axis through a uniform bucket grid, one array read
+ * and a comparison or two, and reads the table: a handful of loads with no
+ * per-rule branching, whatever the number of rules.
+ */
+class Biome_table
+{
+public:
+  // Attributes
+  /**
+   * @brief Biome of values no rule matches
+   */
+  static constexpr uint8_t UNCLASSIFIED = 255;
+
+  // Implementation
+  /**
+   * @brief Compile the rules
+   * @param rules Rules in priority order
+   * @throws std::invalid_argument If a range is empty or there are more
+   * biomes than fit below UNCLASSIFIED
+   */
+  explicit Biome_table(const std::vector<Biome_rule>& rules);
+
+  /**
+   * @brief Parse rules from config
+   * @param json_text A JSON array of objects, each with a "biome" name, an
+   * optional [min, max] range for any of "elevation", "moisture" and
+   * "temperature", an optional "coast" of "any", "coastal" or "inland", and
+   * an optional [r, g, b] "color"
+   * @return The rules, in order
+   * @throws std::invalid_argument If a rule is malformed
+   */
+  static std::vector<Biome_rule> Parse_rules(const std::string& json_text);
+
+  /**
+   * @brief Biome of one set of values
+   * @return Index into Get_biome_names(), UNCLASSIFIED if no rule matches
+   */
+  uint8_t Classify(double elevation, double moisture, double temperature, bool coastal) const
+  {
+    return m_table[((static_cast<size_t>(coastal) * m_axes[2].Interval_count() + m_axes[2].Locate(temperature))
+                    * m_axes[1].Interval_count() + m_axes[1].Locate(moisture))
+                   * m_axes[0].Interval_count() + m_axes[0].Locate(elevation)];
+  }
+
+  /**
+   * @brief Biome of every element of a batch, classified in parallel
+   * @param elevation Elevation of each element
+   * @param moisture Moisture of each element; null for all 0
+   * @param temperature Temperature of each element; null for all 0
+   * @param coastal Whether each element is coastal; null for none
+   * @param count Number of elements
+   * @param out Biome of each element
+   */
+  void Classify_all(const double* elevation,
+                    const double* moisture,
+                    const double* temperature,
+                    const unsigned char* coastal,
+                    size_t count,
+                    uint8_t* out) const;
+
+  /**
+   * @brief Biome names and colors, in order of first appearance in the
+   * rules
+   */
+  const std::vector<std::string>& Get_biome_names() const { return m_names; }
+  const std::vector<std::array<unsigned char, 3>>& Get_biome_colors() const { return m_colors; }
+
+private:
+  // Attributes
+  /**
+   * @brief Most buckets per axis
+   */
+  static constexpr size_t MAX_BUCKETS = 4096;
+
+  /**
+   * @brief The intervals of one axis
+   */
+  struct Axis
+  {
+    /**
+     * @brief Interval ends in ascending order, between -inf and +inf:
+     * interval k is [edges[k], edges[k + 1])
+     */
+    std::vector<double> edges;
+
+    /**
+     * @brief Start of the bucket grid and buckets per unit
+     */
+    double start;
+    double scale;
+
+    /**
+     * @brief Interval holding the start of every bucket
+     */
+    std::vector<uint16_t> buckets;
+
+    /**
+     * @brief Number of intervals
+     */
+    size_t Interval_count() const { return edges.size() - 1; }
+
+    /**
+     * @brief Interval holding a value; a bucket never starts past its
+     * values' interval, so at most a step or two up from it finds the one
+     */
+    size_t Locate(double value) const
+    {
+      const double at = std::clamp((value - start) * scale, 0.0, static_cast<double>(buckets.size() - 1));
+      size_t k = buckets[static_cast<size_t>(at)];
+      while (k + 2 < edges.size() && value >= edges[k + 1])
+      {
+        k++;
+      }
+      return k;
+    }
+  };
+
+  /**
+   * @brief Intervals of each axis, by EBiome_axis
+   */
+  std::array<Axis, static_cast<size_t>(EBiome_axis::EBIOME_AXIS_Count)> m_axes;
+
+  /**
+   * @brief Biome of every combination of intervals, elevation fastest, then
+   * moisture, temperature and inland / coastal
+   */
+  std::vector<uint8_t> m_table;
+
+  /**
+   * @brief Biome names and colors
+   */
+  std::vector<std::string> m_names;
+  std::vector<std::array<unsigned char, 3>> m_colors;
+
+  // Implementation
+  /**
+   * @brief Cut an axis at every end of the rules' ranges on it
+   */
+  static Axis build_axis(const std::vector<Biome_rule>& rules, size_t axis);
+};
+}
+
+#endif
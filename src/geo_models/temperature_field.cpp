@@ -0,0 +1,71 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+#include <cmath>
+#include <stdexcept>
+
+// JSON
+
+// Application files
+#include <geo_models/temperature_field.h>
+#include <utils/task_scheduler.h>
+
+///////////////////////////////////////////////////////////////////////
+
+using tf = world_builder::Temperature_field;
+
+///////////////////////////////////////////////////////////////////////
+
+tf::Temperature_field(double moderation_distance)
+  :
+  m_moderation_distance(static_cast<float>(moderation_distance))
+{
+  if (!(moderation_distance > 0))
+  {
+    throw std::invalid_argument("Temperature moderation distance must be positive");
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void tf::Temperature_all(const float* latitude,
+                         const float* height,
+                         const float* coast_distance,
+                         size_t count,
+                         float* out) const
+{
+  Task_scheduler::Instance().Parallel_for(0, count, 4096, [&](size_t lo, size_t hi)
+  {
+    for (size_t i = lo; i < hi; i++)
+    {
+      out[i] = Temperature(latitude[i], height[i], coast_distance[i]);
+    }
+  });
+}
+
+///////////////////////////////////////////////////////////////////////
+
+std::array<unsigned char, 3> tf::Temperature_color(float temperature)
+{
+  // Colors at evenly spaced stops from the coldest to the hottest
+  static constexpr int STOPS = 5;
+  static constexpr float COLDEST = -40.0f;
+  static constexpr float HOTTEST = 40.0f;
+  static constexpr float RAMP[STOPS][3] = {{40, 40, 150}, {90, 160, 230}, {245, 245, 245}, {240, 170, 60}, {170, 30, 30}};
+
+  const float t = std::clamp((temperature - COLDEST) / (HOTTEST - COLDEST), 0.0f, 1.0f);
+  const float scaled = t * (STOPS - 1);
+  const int stop = std::min(static_cast<int>(scaled), STOPS - 2);
+  const float f = scaled - stop;
+
+  std::array<unsigned char, 3> color;
+  for (int c = 0; c < 3; c++)
+  {
+    color[c] = static_cast<unsigned char>(std::lround(RAMP[stop][c] + f * (RAMP[stop + 1][c] - RAMP[stop][c])));
+  }
+  return color;
+}
+
+///////////////////////////////////////////////////////////////////////
@@ -0,0 +1,115 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef TEMPERATURE_FIELD_H
+#define TEMPERATURE_FIELD_H
+
+// Standard libs
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+// JSON
+
+// Application files
+
+namespace world_builder
+{
+
+/**
+ * @brief Mean surface temperature, in degrees Celsius, from latitude,
+ * height above the sea and distance to the coast
+ * @details Temperature falls from the equator to the poles with the square
+ * of the latitude and drops at a fixed lapse rate with height. The sea
+ * moderates the climate: on the coast and at sea it is the latitude's own,
+ * and inland it swings further from the global mean, hotter near the
+ * equator and colder near the poles, approaching the full continental swing
+ * as the distance to the coast grows past the moderation distance. The
+ * distance comes in precomputed, so a whole map is one branch-free pass over
+ * its elevations.
+ */
+class Temperature_field
+{
+public:
+  // Attributes
+  /**
+   * @brief Sea level temperature at the equator and at the poles, and the
+   * global mean inland climates swing away from
+   */
+  static constexpr float EQUATOR_TEMPERATURE = 30.0f;
+  static constexpr float POLE_TEMPERATURE = -25.0f;
+  static constexpr float MEAN_TEMPERATURE = 10.0f;
+
+  /**
+   * @brief Drop in temperature per unit of elevation above the sea
+   */
+  static constexpr float LAPSE_RATE = 40.0f;
+
+  /**
+   * @brief Extra swing from the mean far inland, as a share of the
+   * latitude's swing
+   */
+  static constexpr float CONTINENTALITY = 0.3f;
+
+  /**
+   * @brief Moderation distance both pipelines use unless configured, in
+   * tiles or cell hops
+   */
+  static constexpr double DEFAULT_MODERATION_DISTANCE = 4.0;
+
+  // Implementation
+  /**
+   * @brief Constructor
+   * @param moderation_distance Distance to the coast, in the caller's units,
+   * at which the continental swing is half its full size
+   */
+  explicit Temperature_field(double moderation_distance);
+
+  /**
+   * @brief Temperature at one place
+   * @param latitude Distance from the equator, 0 there to 1 at either pole
+   * @param height Elevation above the sea; 0 or less at sea
+   * @param coast_distance Distance to the coast; ignored at sea
+   * @return Degrees Celsius
+   */
+  float Temperature(float latitude, float height, float coast_distance) const
+  {
+    const float sea_level = POLE_TEMPERATURE + (EQUATOR_TEMPERATURE - POLE_TEMPERATURE) * (1.0f - latitude * latitude);
+    const float distance = (height > 0.0f) ? coast_distance : 0.0f;
+    const float inland = distance / (distance + m_moderation_distance);
+    return MEAN_TEMPERATURE + (sea_level - MEAN_TEMPERATURE) * (1.0f + CONTINENTALITY * inland)
+           - LAPSE_RATE * std::max(height, 0.0f);
+  }
+
+  /**
+   * @brief Temperature of every element of a batch, worked out in parallel
+   * @param latitude Latitude of each element
+   * @param height Height above the sea of each element
+   * @param coast_distance Distance to the coast of each element
+   * @param count Number of elements
+   * @param out Temperature of each element
+   */
+  void Temperature_all(const float* latitude,
+                       const float* height,
+                       const float* coast_distance,
+                       size_t count,
+                       float* out) const;
+
+  /**
+   * @brief Map color for a temperature: blue through white to red
+   * @param temperature Degrees Celsius
+   * @return The color
+   */
+  static std::array<unsigned char, 3> Temperature_color(float temperature);
+
+private:
+  // Attributes
+  /**
+   * @brief Distance at which the continental swing is half its full size
+   */
+  float m_moderation_distance;
+};
+}
+
+#endif
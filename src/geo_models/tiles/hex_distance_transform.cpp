@@ -0,0 +1,167 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+// JSON
+
+// Application files
+#include <geo_models/tiles/hex_distance_transform.h>
+#include <utils/task_scheduler.h>
+
+///////////////////////////////////////////////////////////////////////
+
+using hdt = world_builder::Hex_distance_transform;
+
+///////////////////////////////////////////////////////////////////////
+
+hdt::Hex_distance_transform()
+  :
+  m_row_nearest()
+{ }
+
+///////////////////////////////////////////////////////////////////////
+
+void hdt::Run(const std::vector<unsigned char>& features,
+              int width,
+              int height,
+              std::vector<float>& distance,
+              std::vector<int>* nearest)
+{
+  auto& scheduler = world_builder::Task_scheduler::Instance();
+  const size_t count = static_cast<size_t>(width) * height;
+  distance.resize(count);
+  if(nearest)
+  {
+    nearest->resize(count);
+  }
+  if(count == 0)
+  {
+    return;
+  }
+
+  // Doubled x runs from the first tile of the first row to the last tile of
+  // the last row
+  const int span = 2 * (width - 1) + (height - 1) + 1;
+  m_row_nearest.resize(static_cast<size_t>(span) * height);
+
+  // Pass 1: nearest feature along each row, one sweep from each side
+  scheduler.Parallel_for(0, height, 1, [&](size_t row_lo, size_t row_hi)
+  {
+    for(size_t r = row_lo; r < row_hi; ++r)
+    {
+      const unsigned char* row_features = features.data() + r * width;
+      int* row_nearest = m_row_nearest.data() + r * span;
+      auto is_feature = [&](int x)
+      {
+        const int offset = x - static_cast<int>(r);
+        return offset >= 0 && (offset & 1) == 0 && offset / 2 < width && row_features[offset / 2];
+      };
+
+      int last = NONE;
+      for(int x = 0; x < span; ++x)
+      {
+        if(is_feature(x))
+        {
+          last = x;
+        }
+        row_nearest[x] = last;
+      }
+      int next = NONE;
+      for(int x = span - 1; x >= 0; --x)
+      {
+        if(is_feature(x))
+        {
+          next = x;
+        }
+        if(next != NONE && (row_nearest[x] == NONE || next - x < x - row_nearest[x]))
+        {
+          row_nearest[x] = next;
+        }
+      }
+    }
+  });
+
+  // Pass 2: along each vertical line, the lower envelope of the parabolas
+  // 3 * (r - s)^2 + f(s) in doubled units, f(s) being the squared distance
+  // to row s's nearest feature
+  scheduler.Parallel_for(0, span, LINE_GRAIN, [&](size_t line_lo, size_t line_hi)
+  {
+    std::vector<int> rows(height);
+    std::vector<int64_t> row_offset(height);
+    std::vector<double> starts(height + 1);
+    for(size_t line = line_lo; line < line_hi; ++line)
+    {
+      const int x = static_cast<int>(line);
+
+      // Envelope parabolas, each with where it starts to be the lowest
+      int top = -1;
+      for(int s = 0; s < height; ++s)
+      {
+        const int feature_x = m_row_nearest[static_cast<size_t>(s) * span + x];
+        if(feature_x == NONE)
+        {
+          continue;
+        }
+        const int64_t dx = x - feature_x;
+        const int64_t offset = dx * dx + 3 * static_cast<int64_t>(s) * s;
+        double start = -std::numeric_limits<double>::infinity();
+        while(top >= 0)
+        {
+          start = static_cast<double>(offset - row_offset[top]) / (6.0 * (s - rows[top]));
+          if(start > starts[top])
+          {
+            break;
+          }
+          top--;
+        }
+        if(top < 0)
+        {
+          start = -std::numeric_limits<double>::infinity();
+        }
+        top++;
+        rows[top] = s;
+        row_offset[top] = offset;
+        starts[top] = start;
+      }
+      starts[top + 1] = std::numeric_limits<double>::infinity();
+
+      // Tiles on this line: r with the same parity as x, and q in the map
+      const int r_first = std::max(x - 2 * (width - 1), 0);
+      int k = 0;
+      for(int r = r_first + ((x - r_first) & 1); r < height && r <= x; r += 2)
+      {
+        const size_t i = static_cast<size_t>(r) * width + (x - r) / 2;
+        if(top < 0)
+        {
+          distance[i] = std::numeric_limits<float>::infinity();
+          if(nearest)
+          {
+            (*nearest)[i] = NONE;
+          }
+          continue;
+        }
+        while(starts[k + 1] < r)
+        {
+          k++;
+        }
+        const int s = rows[k];
+        const int feature_x = m_row_nearest[static_cast<size_t>(s) * span + x];
+        const int64_t dx = x - feature_x;
+        const int64_t dr = r - s;
+        distance[i] = static_cast<float>(std::sqrt(static_cast<double>(dx * dx + 3 * dr * dr)) * 0.5);
+        if(nearest)
+        {
+          (*nearest)[i] = s * width + (feature_x - s) / 2;
+        }
+      }
+    }
+  });
+}
+
+///////////////////////////////////////////////////////////////////////
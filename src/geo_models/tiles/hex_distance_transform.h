@@ -0,0 +1,86 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef HEX_DISTANCE_TRANSFORM_H
+#define HEX_DISTANCE_TRANSFORM_H
+
+// Standard libs
+#include <cstddef>
+#include <vector>
+
+// JSON
+
+// Application files
+
+namespace world_builder
+{
+/**
+ * @brief Exact Euclidean distance from every tile of the axial hex grid to
+ * the nearest feature tile, with neighboring tile centers 1 apart
+ * @details Tile (q, r) sits at x = q + r / 2, y = r * sqrt(3) / 2, so the
+ * rows are horizontal lines and every vertical line through a tile center
+ * meets a center every other row. The squared distance splits into a
+ * horizontal and a vertical part, and the transform is two separable passes
+ * in doubled x units, X = 2q + r:
+ *
+ * 1. Each row finds, for every X across the map, its nearest feature in
+ *    that row with one sweep each way.
+ * 2. Each vertical line X takes the lower envelope of the parabolas the
+ *    rows give it (Felzenszwalb and Huttenlocher) and reads off the tiles on
+ *    it.
+ *
+ * Rows run in parallel in the first pass and vertical lines in the second;
+ * both are linear, so the whole transform is linear in height * (2 * width
+ * + height). Distances come from integer squared distances, so they are
+ * exact, and every tile and vertical line is worked out by one task alone,
+ * so ties between features break the same way whatever the threading. The
+ * buffers are kept between runs.
+ */
+class Hex_distance_transform
+{
+public:
+  // Attributes
+  /**
+   * @brief Nearest feature of a tile when there are no features
+   */
+  static constexpr int NONE = -1;
+
+  // Implementation
+  /**
+   * @brief Constructor, with empty buffers
+   */
+  Hex_distance_transform();
+
+  /**
+   * @brief Measure the distances
+   * @param features Row-major, `r * width + q`; nonzero for a feature tile
+   * @param width Tiles per row
+   * @param height Rows
+   * @param distance Filled with the distance from each tile to the nearest
+   * feature, 0 on one and infinity if there are none
+   * @param nearest If set, filled with the index of each tile's nearest
+   * feature, NONE if there are none
+   */
+  void Run(const std::vector<unsigned char>& features,
+           int width,
+           int height,
+           std::vector<float>& distance,
+           std::vector<int>* nearest = nullptr);
+
+private:
+  // Attributes
+  /**
+   * @brief Vertical lines per task in the second pass
+   */
+  static constexpr size_t LINE_GRAIN = 16;
+
+  /**
+   * @brief Doubled x of the nearest feature in every row for every vertical
+   * line, row-major, NONE for a row without features
+   */
+  std::vector<int> m_row_nearest;
+};
+}
+
+#endif
@@ -27,7 +27,10 @@ tile::Tile(const world_builder::Coord& coord)
   m_terrain(world_builder::ETerrain::ETERRAIN_Unknown),
   m_is_river(false),
   m_is_coast(false),
-  m_river_to()
+  m_river_to(),
+  m_moisture(0.0),
+  m_precipitation(0.0),
+  m_temperature(0.0f)
 { }
 
 ///////////////////////////////////////////////////////////////////////
@@ -39,7 +42,10 @@ tile::Tile(const Tile& copy)
   m_terrain(copy.m_terrain),
   m_is_river(copy.m_is_river),
   m_is_coast(copy.m_is_coast),
-  m_river_to(copy.m_river_to)
+  m_river_to(copy.m_river_to),
+  m_moisture(copy.m_moisture),
+  m_precipitation(copy.m_precipitation),
+  m_temperature(copy.m_temperature)
 { }
 
 ///////////////////////////////////////////////////////////////////////
@@ -84,12 +90,14 @@ std::optional<world_builder::Coord> tile::Downhill_neighbor(const world_builder:
     return std::nullopt;
   }
 
-  std::sort(cands.begin(),
-            cands.end(),
-            [](auto& a, auto& b){ return a.second < b.second; });
-  if(cands.front().second <= cur_e)
+  // Lowest neighbor, ties go to the first in neighbor order so the river
+  // path is canonical
+  auto lowest = std::min_element(cands.begin(),
+                                 cands.end(),
+                                 [](auto& a, auto& b){ return a.second < b.second; });
+  if(lowest->second <= cur_e)
   {
-    return cands.front().first;
+    return lowest->first;
   }
   return std::nullopt;
 }
@@ -143,45 +151,3 @@ void tile::Set_ocean_terrain(const double sea_level)
 
 ///////////////////////////////////////////////////////////////////////
 
-void tile::Paint_terrain(const double sea_level)
-{
-  if (m_terrain == world_builder::ETerrain::ETERRAIN_Ocean)
-  {
-    return;
-  }
-
-  if(m_is_river)
-  {
-    m_terrain = world_builder::ETerrain::ETERRAIN_River;
-  }
-
-  if(m_is_coast && m_elevation <= sea_level + 0.03)
-  {
-    m_terrain = world_builder::ETerrain::ETERRAIN_Beach;
-  }
-  else if(m_elevation < sea_level + 0.07)
-  {
-    m_terrain = world_builder::ETerrain::ETERRAIN_Marsh;
-  }
-  else if(m_elevation < sea_level + 0.20)
-  {
-    m_terrain = world_builder::ETerrain::ETERRAIN_Plains;
-  }
-  else if(m_elevation < sea_level + 0.45)
-  {
-    m_terrain = world_builder::ETerrain::ETERRAIN_Hills;
-  }
-  else
-  {
-    if(m_elevation > 0.8)
-    {
-      m_terrain = world_builder::ETerrain::ETERRAIN_Mountains;
-    }
-    else
-    {
-      m_terrain = world_builder::ETerrain::ETERRAIN_Hills;
-    }
-  }
-}
-
-///////////////////////////////////////////////////////////////////////
@@ -71,6 +71,9 @@ public:
       m_is_river = other.m_is_river;
       m_is_coast = other.m_is_coast;
       m_river_to = other.m_river_to;
+      m_moisture = other.m_moisture;
+      m_precipitation = other.m_precipitation;
+      m_temperature = other.m_temperature;
     }
     return *this;
   }
@@ -108,16 +111,10 @@ public:
    */
   void Set_ocean_terrain(const double sea_level);
 
-  /**
-   * @brief Paint terrain based on sea level
-   * @param sea_level The configured sea level
-   */
-  void Paint_terrain(const double sea_level);
-
   /**
    * Getters and setters
    */
-  const std::vector<Coord>& Get_neighbor_offsets() const { return m_neighbor_offsets; }
+  static const std::vector<Coord>& Get_neighbor_offsets() { return m_neighbor_offsets; }
 
   const Coord& Get_coord() const { return m_coord; }
 
@@ -136,6 +133,15 @@ public:
   const std::optional<Coord>& Get_river_to() const { return m_river_to; }
   void Set_river_to(const Coord& river_to) { m_river_to = river_to;}
 
+  const double Get_moisture() const { return m_moisture; }
+  void Set_moisture(const double moisture) { m_moisture = moisture; }
+
+  const double Get_precipitation() const { return m_precipitation; }
+  void Set_precipitation(const double precipitation) { m_precipitation = precipitation; }
+
+  const float Get_temperature() const { return m_temperature; }
+  void Set_temperature(const float temperature) { m_temperature = temperature; }
+
 
 private:
   // Attributes
@@ -175,6 +181,21 @@ private:
    * @brief The downstream river tile, if this is a river tile
    */
   std::optional<Coord> m_river_to;
+
+  /**
+   * @brief Humidity of the air over this tile, 0 dry to 1 saturated
+   */
+  double m_moisture;
+
+  /**
+   * @brief Rain the air dropped on this tile, as humidity lost
+   */
+  double m_precipitation;
+
+  /**
+   * @brief Mean temperature of this tile, in degrees Celsius
+   */
+  float m_temperature;
 };
 }
 
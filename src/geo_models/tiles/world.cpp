@@ -3,13 +3,23 @@
  */
 
 // Standard libs
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
 // JSON
 
 // Application files
+#include <defs/batch_rng.h>
 #include <defs/dice_rolls.h>
+#include <geo_models/temperature_field.h>
 #include <geo_models/tiles/continent.h>
 #include <geo_models/tiles/world.h>
+#include <utils/task_scheduler.h>
 #include <utils/tiles_config.h>
 
 ///////////////////////////////////////////////////////////////////////
@@ -18,22 +28,116 @@ using wd = world_builder::World;
 
 ///////////////////////////////////////////////////////////////////////
 
+namespace
+{
+/**
+ * @brief Tiles per diffusion noise block, each block has its own generator
+ */
+constexpr size_t NOISE_BLOCK_SIZE = 4096;
+
+/**
+ * @brief Share of the missing humidity air picks up over one ocean tile
+ */
+constexpr double EVAPORATION = 0.2;
+
+/**
+ * @brief Share of its humidity air rains on every land tile, and the extra
+ * share per unit of elevation it climbs into a tile
+ */
+constexpr double BASE_RAIN = 0.03;
+constexpr double OROGRAPHIC_RAIN = 10.0;
+
+/**
+ * @brief Edges of the wind bands, as fractions of the way from the equator
+ * to the poles
+ */
+constexpr double TRADE_WIND_EDGE = 1.0 / 3.0;
+constexpr double POLAR_EASTERLY_EDGE = 2.0 / 3.0;
+
+/**
+ * @brief Terrain rules from config, or the built-in ones: beaches on the
+ * coast just above the sea, then marsh, plains and hills by height above it,
+ * and mountains on the highest ground
+ * @param tiles_config The config
+ * @return The rules
+ */
+std::vector<world_builder::Biome_rule> Terrain_rules(const world_builder::Tiles_config& tiles_config)
+{
+  if(!tiles_config.Get_terrain_rules().empty())
+  {
+    return tiles_config.Get_terrain_rules();
+  }
+
+  constexpr size_t ELEVATION = static_cast<size_t>(world_builder::EBiome_axis::EBIOME_AXIS_Elevation);
+  const double sea_level = tiles_config.Get_sea_level();
+  std::vector<world_builder::Biome_rule> rules;
+  auto below = [&](const std::string& terrain, double max_elevation)
+  {
+    rules.emplace_back(terrain);
+    rules.back().max[ELEVATION] = max_elevation;
+  };
+  below("Beach", sea_level + 0.03);
+  rules.back().coast = world_builder::ECoast_rule::ECOAST_RULE_Coastal;
+  below("Marsh", sea_level + 0.07);
+  below("Plains", sea_level + 0.20);
+  below("Hills", sea_level + 0.45);
+  rules.emplace_back("Mountains");
+  rules.back().min[ELEVATION] = 0.8;
+  rules.emplace_back("Hills");
+  return rules;
+}
+
+/**
+ * @brief Terrain type of every biome of a table, Unknown for
+ * Biome_table::UNCLASSIFIED
+ * @throws std::invalid_argument If a biome is not a terrain type
+ */
+std::vector<world_builder::ETerrain> Biome_terrain(const world_builder::Biome_table& table)
+{
+  std::vector<world_builder::ETerrain> terrain(world_builder::Biome_table::UNCLASSIFIED + 1,
+                                               world_builder::ETerrain::ETERRAIN_Unknown);
+  const std::vector<std::string>& names = table.Get_biome_names();
+  for(size_t i = 0; i < names.size(); ++i)
+  {
+    try
+    {
+      terrain[i] = world_builder::String_to_enum(names[i], world_builder::TERRAIN_LOOKUP);
+    }
+    catch(const std::invalid_argument&)
+    {
+      throw std::invalid_argument("Terrain rule names unknown terrain " + names[i]);
+    }
+  }
+  return terrain;
+}
+}
+
+///////////////////////////////////////////////////////////////////////
+
 wd::World(const Tiles_config& tiles_config)
   :
   m_tiles_config(tiles_config),
   m_world_tiles(),
   m_continents(),
-  m_seeds_per_continent(0)
+  m_seeds_per_continent(0),
+  m_rivers(),
+  m_tile_grid(static_cast<size_t>(tiles_config.Get_width()) * tiles_config.Get_height(), nullptr),
+  m_coast_distance(),
+  m_coast_transform(),
+  m_terrain_table(Terrain_rules(tiles_config)),
+  m_biome_terrain(Biome_terrain(m_terrain_table))
 {
   // Using the params, build a grid of Coord objects, which are then used to
   // build a Tile. These tiles represent the individual unit that builds the
   // whole map.
+  m_world_tiles.reserve(m_tile_grid.size());
   for(int q = 0; q < tiles_config.Get_width(); ++q)
   {
     for(int r = 0; r < tiles_config.Get_height(); ++r)
     {
       world_builder::Coord new_coord = world_builder::Coord(q, r);
-      m_world_tiles.try_emplace(new_coord, world_builder::Tile(new_coord));
+      auto [it, inserted] = m_world_tiles.try_emplace(new_coord, world_builder::Tile(new_coord));
+      m_tile_grid[static_cast<size_t>(r) * tiles_config.Get_width() + q] = &it->second;
     }
   }
 }
@@ -124,182 +228,377 @@ void wd::Seed_oceans()
 
 void wd::Run_diffusion()
 {
+  const int width = m_tiles_config.Get_width();
+  const int height = m_tiles_config.Get_height();
+  const size_t count = m_tile_grid.size();
+  const auto& offsets = world_builder::Tile::Get_neighbor_offsets();
+  auto& scheduler = world_builder::Task_scheduler::Instance();
+
+  // Every pass reads the previous pass's elevations and writes a new set, so
+  // tiles can be processed in any order and on any thread
+  std::vector<double> current(count);
+  std::vector<double> next(count);
+  std::vector<double> noise(count);
+  const size_t noise_blocks = (count + NOISE_BLOCK_SIZE - 1) / NOISE_BLOCK_SIZE;
+
+  scheduler.Parallel_for(0, count, 0, [&](size_t lo, size_t hi)
+  {
+    for(size_t i = lo; i < hi; ++i)
+    {
+      current[i] = m_tile_grid[i]->Get_elevation();
+    }
+  });
+
   // Diffusion / smoothing. For every smoothing pass, this will set the elevation for each
   // to based on the average of all neighbors with some random noise injected.
   for (int pass = 0; pass < m_tiles_config.Get_smooth_passes(); ++pass)
   {
-    // Temp map to hold all coordinates, allowing update of the main map after
-    // doing the smoothing passes
-    std::unordered_map<world_builder::Coord,
-                       double,
-                       world_builder::Coord_hash> new_elev;
-
-    // ie for every tile...
-    for (auto& [coord, tile] : m_world_tiles)
+    // (rng.uniform() - 0.5): Make the number in the range of -.5 to .5
+    // * params.randomness: Augment the random roll with the additional randomness factor
+    // (1.0 - (double)pass / params.smooth_passes): Dampens the noise gradually with each smoothing pass.
+    // The noise is pre-drawn in fixed blocks of tiles, each block with its
+    // own generator from the diffusion stream, so it does not depend on which
+    // thread fills the block.
+    double damping = m_tiles_config.Get_randomness() * (1.0 - (double)pass / m_tiles_config.Get_smooth_passes());
+    scheduler.Parallel_for(0, noise_blocks, 1, [&](size_t block_lo, size_t block_hi)
     {
-      // get all neighbors for this tile
-      auto neighbors = tile.Get_neighbor_tiles(coord);
-
-      // Neighboring elevations
-      std::vector<double> neighbor_elevations;
+      for(size_t block = block_lo; block < block_hi; ++block)
+      {
+        size_t first = block * NOISE_BLOCK_SIZE;
+        size_t length = std::min(NOISE_BLOCK_SIZE, count - first);
+        world_builder::dice::Batch_rng rng(world_builder::dice::ERng_stream::ERNG_STREAM_Diffusion,
+                                           static_cast<uint64_t>(pass) * noise_blocks + block);
+        rng.Fill_uniform(noise.data() + first, length, -0.5 * damping, 0.5 * damping);
+      }
+    });
 
-      // for all neighbors,
-      for (auto& nn : neighbors)
+    scheduler.Parallel_for(0, count, 0, [&](size_t lo, size_t hi)
+    {
+      for(size_t i = lo; i < hi; ++i)
       {
-        // Get the pointed to neighbor tile
-        auto it2 = m_world_tiles.find(nn);
-        if(it2 != m_world_tiles.end())
+        int q = static_cast<int>(i % width);
+        int r = static_cast<int>(i / width);
+
+        // Average all neighboring elevations that are on the map
+        double nbr_sum = 0;
+        int nbr_count = 0;
+        for(const auto& offset : offsets)
         {
-          // If found, add the elevation
-          neighbor_elevations.push_back(it2->second.Get_elevation());
+          int nq = q + offset.Get_q_coord();
+          int nr = r + offset.Get_r_coord();
+          if(nq >= 0 && nq < width && nr >= 0 && nr < height)
+          {
+            nbr_sum += current[static_cast<size_t>(nr) * width + nq];
+            nbr_count++;
+          }
         }
-      }
 
-      // Average all neighboring elevations
-      double nbr_mean = 0;
+        // If no neighbors, use this tile's own elevation
+        double nbr_mean = nbr_count > 0 ? nbr_sum / nbr_count : current[i];
 
-      // If no neighbors, use this tile's own elevation
-      if(neighbor_elevations.empty())
-      {
-        nbr_mean = tile.Get_elevation();
-      }
-      // Otherwise, add up all neighboring elevations and divide by found neighbors
-      else
-      {
-        nbr_mean = std::accumulate(neighbor_elevations.begin(),
-                                   neighbor_elevations.end(), 0.0) / neighbor_elevations.size();
-      }
-
-      double blend = 0.6;
+        double blend = 0.6;
 
-      // (rng.uniform() - 0.5): Make the number in the range of -.5 to .5
-      // * params.randomness: Augment the random roll with the additional randomness factor
-      // (1.0 - (double)pass / params.smooth_passes): Dampens the noise gradually with each smoothing pass.
-      double noise = (world_builder::dice::Make_a_roll<double>(0, 1) - 0.5) * m_tiles_config.Get_randomness() * (1.0 - (double)pass / m_tiles_config.Get_smooth_passes());
+        // New elevation is a weighted average between (old elevation) and (neighbor mean), plus some fading noise.
+        // If blend = 0.5 → half current height, half neighbors → moderate smoothing.
+        // If blend = 1.0 → completely replace with neighbor mean (max smoothing).
+        // If blend = 0.0 → do nothing (preserve current map).
+        next[i] = nbr_mean * blend + current[i] * (1 - blend) + noise[i];
+      }
+    });
 
-      // New elevation is a weighted average between (old elevation) and (neighbor mean), plus some fading noise.
-      // If blend = 0.5 → half current height, half neighbors → moderate smoothing.
-      // If blend = 1.0 → completely replace with neighbor mean (max smoothing).
-      // If blend = 0.0 → do nothing (preserve current map).
-      new_elev[coord] = nbr_mean * blend + tile.Get_elevation() * (1 - blend) + noise;
-    }
+    std::swap(current, next);
+  }
 
-    // Reset the tiles to the new elevation
-    for (const auto& [coord, val] : new_elev)
+  // Reset the tiles to the new elevation
+  scheduler.Parallel_for(0, count, 0, [&](size_t lo, size_t hi)
+  {
+    for(size_t i = lo; i < hi; ++i)
     {
-      auto it = m_world_tiles.find(coord);
-      if (it != m_world_tiles.end())
-      {
-        it->second.Set_elevation(val);
-      }
+      m_tile_grid[i]->Set_elevation(current[i]);
     }
-  }
+  });
 }
 
 ///////////////////////////////////////////////////////////////////////
 
 void wd::Normalize_elevation()
 {
-  // Normalize elevation
-  double minE = 1e9;
-  double maxE = -1e9;
+  auto& scheduler = world_builder::Task_scheduler::Instance();
+
+  // For every tile, check for a new max or min elevation. Chunks are folded
+  // in index order, so the result never depends on scheduling.
+  using Min_max = std::pair<double, double>;
+  Min_max range = scheduler.Parallel_reduce(
+      0, m_tile_grid.size(), 0, Min_max{1e9, -1e9},
+      [&](size_t lo, size_t hi, Min_max acc)
+      {
+        for(size_t i = lo; i < hi; ++i)
+        {
+          acc.first = std::min(acc.first, m_tile_grid[i]->Get_elevation());
+          acc.second = std::max(acc.second, m_tile_grid[i]->Get_elevation());
+        }
+        return acc;
+      },
+      [](const Min_max& a, const Min_max& b)
+      {
+        return Min_max{std::min(a.first, b.first), std::max(a.second, b.second)};
+      });
 
-  // For every tile, check for a new max or min elevation
-  for(auto& [c, t] : m_world_tiles)
-  {
-    minE = std::min(minE, t.Get_elevation());
-    maxE = std::max(maxE, t.Get_elevation());
-  }
+  double minE = range.first;
+  double maxE = range.second;
 
   // For every tile, re-scale the elevation to fit within a 0 - 1 range
-  for(auto& [c, t] : m_world_tiles)
+  scheduler.Parallel_for(0, m_tile_grid.size(), 0, [&](size_t lo, size_t hi)
   {
-    t.Set_elevation((t.Get_elevation() - minE) / (maxE - minE));
-  }
+    for(size_t i = lo; i < hi; ++i)
+    {
+      m_tile_grid[i]->Set_elevation((m_tile_grid[i]->Get_elevation() - minE) / (maxE - minE));
+    }
+  });
 }
 
 ///////////////////////////////////////////////////////////////////////
 
 void wd::Run_oceans_and_coasts()
 {
+  auto& scheduler = world_builder::Task_scheduler::Instance();
+
   // Ocean terrain classification based on elevation
   // This has to be done first, since the coastal checks need to know if any
   // neighbors are oceans
-  for(auto& [c, t] : m_world_tiles)
+  scheduler.Parallel_for(0, m_tile_grid.size(), 0, [&](size_t lo, size_t hi)
   {
-    t.Set_ocean_terrain(m_tiles_config.Get_sea_level());
+    for(size_t i = lo; i < hi; ++i)
+    {
+      m_tile_grid[i]->Set_ocean_terrain(m_tiles_config.Get_sea_level());
+    }
+  });
+
+  // Mark coasts. Tiles only read their neighbors' terrain, so any order works.
+  scheduler.Parallel_for(0, m_tile_grid.size(), 0, [&](size_t lo, size_t hi)
+  {
+    for(size_t i = lo; i < hi; ++i)
+    {
+      world_builder::Tile& t = *m_tile_grid[i];
+
+      // Ignore oceans
+      if(t.Get_terrain() == world_builder::ETerrain::ETERRAIN_Ocean)
+      {
+        continue;
+      }
+
+      // For every tile, if it's not an ocean but a neighbor is an ocean, then
+      // this is a coast
+      for(auto& n : t.Get_neighbor_tiles(t.Get_coord()))
+      {
+        auto it2 = m_world_tiles.find(n);
+        if(it2 != m_world_tiles.end() && it2->second.Get_terrain() == world_builder::ETerrain::ETERRAIN_Ocean)
+        {
+          t.Set_is_coast(true);
+          break;
+        }
+      }
+    }
+  });
+
+  // Distance to the sea, exact and measured from every ocean tile at once
+  std::vector<unsigned char> ocean(m_tile_grid.size());
+  scheduler.Parallel_for(0, m_tile_grid.size(), 0, [&](size_t lo, size_t hi)
+  {
+    for(size_t i = lo; i < hi; ++i)
+    {
+      ocean[i] = m_tile_grid[i]->Get_terrain() == world_builder::ETerrain::ETERRAIN_Ocean;
+    }
+  });
+  m_coast_transform.Run(ocean, m_tiles_config.Get_width(), m_tiles_config.Get_height(), m_coast_distance);
+
+  const float no_sea = static_cast<float>(m_tiles_config.Get_width() + m_tiles_config.Get_height());
+  scheduler.Parallel_for(0, m_tile_grid.size(), 0, [&](size_t lo, size_t hi)
+  {
+    for(size_t i = lo; i < hi; ++i)
+    {
+      m_coast_distance[i] = std::min(m_coast_distance[i], no_sea);
+    }
+  });
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void wd::Run_rivers()
+{
+  auto& scheduler = world_builder::Task_scheduler::Instance();
+
+  // for every tile, in row-major order so rivers come out in a canonical
+  // order: check elevation, greater than sea level (plus a pad), and make a
+  // roll against probability
+  std::vector<size_t> sources;
+  for(size_t i = 0; i < m_tile_grid.size(); ++i)
+  {
+    if(m_tile_grid[i]->Get_elevation() > m_tiles_config.Get_sea_level() + 0.05 &&
+       world_builder::dice::Make_stream_roll<double>(world_builder::dice::ERng_stream::ERNG_STREAM_Rivers,
+                                                     i, 0, 1) < m_tiles_config.Get_river_spawn_prob())
+    {
+      sources.push_back(i);
+    }
   }
 
-  // Mark coasts
-  for(auto& [c, t] : m_world_tiles)
+  // Trace a river path from every source. Tracing only reads elevations, so
+  // the paths are independent.
+  std::vector<std::vector<world_builder::Coord>> paths(sources.size());
+  scheduler.Parallel_for(0, sources.size(), 1, [&](size_t lo, size_t hi)
   {
-    // Ignore oceans
-    if(t.Get_terrain() == world_builder::ETerrain::ETERRAIN_Ocean)
+    for(size_t s = lo; s < hi; ++s)
     {
-      continue;
+      world_builder::Tile& t = *m_tile_grid[sources[s]];
+      paths[s] = t.Trace_river(t.Get_coord(), m_world_tiles, m_tiles_config);
     }
+  });
 
-    // For every tile, if it's not an ocean but a neighbor is an ocean, then
-    // this is a coast
-    for(auto& n : t.Get_neighbor_tiles(c))
+  for(auto& path : paths)
+  {
+    // if there are three or more tiles,
+    if (path.size() >= 3)
     {
-      auto it2 = m_world_tiles.find(n);
-      if(it2 != m_world_tiles.end() && it2->second.Get_terrain() == world_builder::ETerrain::ETERRAIN_Ocean)
+      // for each tile in the river path,
+      for(size_t i = 0; i + 1 < path.size(); ++i)
       {
-        t.Set_is_coast(true);
-        break;
+        auto it = m_world_tiles.find(path[i]);
+        if (it != m_world_tiles.end())
+        {
+          it->second.Set_is_river(true);
+          it->second.Set_river_to(path[i + 1]);
+        }
       }
+
+      // handle the last tile
+      auto it_last = m_world_tiles.find(path.back());
+      if(it_last != m_world_tiles.end())
+      {
+        it_last->second.Set_is_river(true);
+      }
+
+      m_rivers.push_back(std::move(path));
     }
   }
 }
 
 ///////////////////////////////////////////////////////////////////////
 
-void wd::Run_rivers()
+void wd::Run_moisture()
 {
-  // for every tile,
-  for(auto& [c, t] : m_world_tiles)
+  const int width = static_cast<int>(m_tiles_config.Get_width());
+  const int height = static_cast<int>(m_tiles_config.Get_height());
+  const double sea_level = m_tiles_config.Get_sea_level();
+
+  world_builder::Task_scheduler::Instance().Parallel_for(0, height, 1, [&](size_t row_lo, size_t row_hi)
   {
-    // Check elevation. greater than sea level (plus a pad), and make a roll against probability
-    if(t.Get_elevation() > m_tiles_config.Get_sea_level() + 0.05 && world_builder::dice::Make_a_roll<double>(0, 1) < m_tiles_config.Get_river_spawn_prob())
+    for(size_t r = row_lo; r < row_hi; ++r)
     {
-      // Trace a river path,
-      auto path = t.Trace_river(c, m_world_tiles, m_tiles_config);
-      // if there are three or more tiles,
-      if (path.size() >= 3)
+      // Distance from the equator, 0 there to 1 at either pole
+      const double latitude = std::abs((r + 0.5) / height * 2.0 - 1.0);
+      const bool westerly = latitude >= TRADE_WIND_EDGE && latitude < POLAR_EASTERLY_EDGE;
+
+      double humidity = 1.0;
+      double previous_surface = sea_level;
+      for(int k = 0; k < width; ++k)
       {
-        // for each tile in the river path,
-        for(size_t i = 0; i + 1 < path.size(); ++i)
+        const int q = westerly ? k : width - 1 - k;
+        world_builder::Tile& t = *m_tile_grid[r * width + q];
+
+        // The ocean surface is flat at sea level
+        const double surface = std::max(t.Get_elevation(), sea_level);
+        double rain = 0.0;
+        if(t.Get_terrain() == world_builder::ETerrain::ETERRAIN_Ocean)
         {
-          auto it = m_world_tiles.find(path[i]);
-          if (it != m_world_tiles.end())
-          {
-            it->second.Set_is_river(true);
-            it->second.Set_river_to(path[i + 1]);
-          }
+          humidity += EVAPORATION * (1.0 - humidity);
         }
-
-        // handle the last tile
-        auto it_last = m_world_tiles.find(path.back());
-        if(it_last != m_world_tiles.end())
+        else
         {
-          it_last->second.Set_is_river(true);
+          const double climb = std::max(0.0, surface - previous_surface);
+          rain = humidity * std::min(1.0, BASE_RAIN + OROGRAPHIC_RAIN * climb);
+          humidity -= rain;
         }
+        t.Set_precipitation(rain);
+        t.Set_moisture(humidity);
+        previous_surface = surface;
+      }
+    }
+  });
+}
 
-        m_rivers.push_back(path);
+///////////////////////////////////////////////////////////////////////
+
+void wd::Run_temperature()
+{
+  const size_t width = m_tiles_config.Get_width();
+  const size_t height = m_tiles_config.Get_height();
+  const float sea_level = static_cast<float>(m_tiles_config.Get_sea_level());
+  const world_builder::Temperature_field field(m_tiles_config.Get_coast_moderation());
+
+  world_builder::Task_scheduler::Instance().Parallel_for(0, height, 1, [&](size_t row_lo, size_t row_hi)
+  {
+    std::vector<float> row_height(width);
+    std::vector<float> row_temperature(width);
+    for(size_t r = row_lo; r < row_hi; ++r)
+    {
+      world_builder::Tile* const* row_tiles = m_tile_grid.data() + r * width;
+      const float* row_distance = m_coast_distance.data() + r * width;
+      const float latitude = static_cast<float>(std::abs((r + 0.5) / height * 2.0 - 1.0));
+
+      for(size_t q = 0; q < width; ++q)
+      {
+        row_height[q] = static_cast<float>(row_tiles[q]->Get_elevation()) - sea_level;
+      }
+      for(size_t q = 0; q < width; ++q)
+      {
+        row_temperature[q] = field.Temperature(latitude, row_height[q], row_distance[q]);
+      }
+      for(size_t q = 0; q < width; ++q)
+      {
+        row_tiles[q]->Set_temperature(row_temperature[q]);
       }
     }
-  }
+  });
 }
 
 ///////////////////////////////////////////////////////////////////////
 
 void wd::Paint_terrain()
 {
-  for (auto& [coord, tile] : m_world_tiles)
+  auto& scheduler = world_builder::Task_scheduler::Instance();
+  const size_t count = m_tile_grid.size();
+  std::vector<double> elevation(count);
+  std::vector<double> moisture(count);
+  std::vector<double> temperature(count);
+  std::vector<unsigned char> coastal(count);
+  std::vector<uint8_t> biome(count);
+
+  scheduler.Parallel_for(0, count, 0, [&](size_t lo, size_t hi)
   {
-    tile.Paint_terrain(m_tiles_config.Get_sea_level());
-  }
+    for(size_t i = lo; i < hi; ++i)
+    {
+      const world_builder::Tile& t = *m_tile_grid[i];
+      elevation[i] = t.Get_elevation();
+      moisture[i] = t.Get_moisture();
+      temperature[i] = t.Get_temperature();
+      coastal[i] = t.Get_is_coast();
+    }
+  });
+
+  m_terrain_table.Classify_all(elevation.data(), moisture.data(), temperature.data(), coastal.data(),
+                               count, biome.data());
+
+  scheduler.Parallel_for(0, count, 0, [&](size_t lo, size_t hi)
+  {
+    for(size_t i = lo; i < hi; ++i)
+    {
+      world_builder::Tile& t = *m_tile_grid[i];
+      if(t.Get_terrain() != world_builder::ETerrain::ETERRAIN_Ocean)
+      {
+        t.Set_terrain(m_biome_terrain[biome[i]]);
+      }
+    }
+  });
 }
 
 ///////////////////////////////////////////////////////////////////////
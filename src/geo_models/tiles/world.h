@@ -11,12 +11,14 @@
 
 // Application files
 #include <defs/world_builder_defs.h>
+#include <geo_models/biome_table.h>
+#include <geo_models/tiles/continent.h>
+#include <geo_models/tiles/hex_distance_transform.h>
 #include <geo_models/tiles/tile.h>
 
 namespace world_builder
 {
 
-class Continent;
 class Tiles_config;
 
 /**
@@ -34,6 +36,12 @@ public:
    */
   World(const Tiles_config& tiles_config);
 
+  /**
+   * @brief Not copyable, m_tile_grid points into this world's tiles
+   */
+  World(const World&) = delete;
+  World& operator=(const World&) = delete;
+
   /**
    * @brief Seed_continents
    */
@@ -55,7 +63,8 @@ public:
   void Normalize_elevation();
 
   /**
-   * @brief Check the tiles elevation and specify Ocean and Coastal terrain
+   * @brief Check the tiles elevation and specify Ocean and Coastal terrain,
+   * then measure every tile's distance to the sea
    */
   void Run_oceans_and_coasts();
 
@@ -65,7 +74,34 @@ public:
   void Run_rivers();
 
   /**
-   * @brief Paint the terrain on each tile
+   * @brief Carry humidity from the oceans along the prevailing winds,
+   * raining it out over land and most where the ground rises
+   * @details Each row is a latitude band with one wind direction: easterly
+   * trade winds within a third of the way from the equator to either pole,
+   * westerlies beyond them and polar easterlies in the last third. Air
+   * enters a row saturated at its upwind edge and is swept across it once,
+   * picking up humidity over ocean and losing a share of it on every land
+   * tile, plus more in proportion to the climb from the tile before; peaks
+   * wring the air out and leave a dry shadow downwind. Rows don't interact,
+   * so they run in parallel, and the stage is a single pass over the tiles.
+   */
+  void Run_moisture();
+
+  /**
+   * @brief Give every tile its mean temperature, from its row's latitude,
+   * its height above the sea and its distance to the coast
+   * @details See Temperature_field. The coast distance comes from
+   * Run_oceans_and_coasts, so each row is gathered into flat arrays and
+   * worked out in one branch-free loop; rows run in parallel.
+   */
+  void Run_temperature();
+
+  /**
+   * @brief Paint the terrain on each land tile from the terrain rules
+   * @details Elevation, moisture, temperature and the coast flag are
+   * gathered into flat arrays in parallel, classified in one
+   * Biome_table::Classify_all batch, and the biomes mapped to terrain types
+   * back onto the tiles; ocean tiles are left as they are.
    */
   void Paint_terrain();
 
@@ -74,6 +110,7 @@ public:
    */
   const world_builder::World_tiles Get_world_tiles() const { return m_world_tiles; }
   const std::vector<std::vector<world_builder::Coord>> Get_rivers() const { return m_rivers; }
+  const std::vector<float>& Get_coast_distance() const { return m_coast_distance; }
 
 private:
   // Attributes
@@ -102,6 +139,32 @@ private:
    */
   std::vector<std::vector<world_builder::Coord>> m_rivers;
 
+  /**
+   * @brief Row-major index into m_world_tiles, `r * width + q`, so stages can
+   * address tiles by position and split work across threads. Pointers into an
+   * unordered_map stay valid for the lifetime of the map.
+   */
+  std::vector<world_builder::Tile*> m_tile_grid;
+
+  /**
+   * @brief Distance from every tile to the nearest ocean tile, in tiles
+   * between centers, row-major like m_tile_grid; 0 at sea, and width +
+   * height if there is no sea. See Hex_distance_transform.
+   */
+  std::vector<float> m_coast_distance;
+
+  /**
+   * @brief Measures m_coast_distance, keeping its buffers between runs
+   */
+  Hex_distance_transform m_coast_transform;
+
+  /**
+   * @brief Terrain rules, compiled, and the terrain of each of their biomes
+   * and of Biome_table::UNCLASSIFIED
+   */
+  Biome_table m_terrain_table;
+  std::vector<world_builder::ETerrain> m_biome_terrain;
+
   // Implementation
 };
 }
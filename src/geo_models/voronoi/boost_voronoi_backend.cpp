@@ -0,0 +1,182 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Application files
+#include <geo_models/voronoi/boost_voronoi_backend.h>
+
+///////////////////////////////////////////////////////////////////////
+
+using bvb = world_builder::Boost_voronoi_backend;
+
+///////////////////////////////////////////////////////////////////////
+
+bvb::Boost_voronoi_backend(ESite_input site_input, double scale_factor)
+  :
+  m_site_input(site_input),
+  m_scale_factor(scale_factor),
+  m_input_scale(scale_factor),
+  m_quantized_x(),
+  m_quantized_y(),
+  m_order(),
+  m_duplicate(),
+  m_site_source(),
+  m_cell_of(),
+  m_builder(),
+  m_diagram()
+{ }
+
+///////////////////////////////////////////////////////////////////////
+
+void bvb::Prepare(double width, double height, size_t site_count)
+{
+  m_input_scale = (m_site_input == ESite_input::ESITE_INPUT_Scaled)
+                  ? m_scale_factor
+                  : Quantization_scale(width, height, site_count);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void bvb::Build(const std::vector<Point>& sites,
+                const std::vector<unsigned char>& /*wanted*/,
+                Flat_diagram& out)
+{
+  // Sweep-line builds every cell anyway, so `wanted` saves nothing here
+  insert_sites(sites);
+  m_diagram.clear();
+  m_builder.construct(&m_diagram);
+
+  // Boost orders cells by its sweep, so find each site's cell first and then
+  // lay the polygons out in site order
+  const size_t count = sites.size();
+  out.Reset(count);
+  m_cell_of.assign(count, nullptr);
+  for (const auto& c : m_diagram.cells())
+  {
+    size_t source = c.source_index();
+    if (source < m_site_source.size())
+    {
+      m_cell_of[m_site_source[source]] = &c;
+    }
+  }
+
+  for (size_t i = 0; i < count; i++)
+  {
+    out.cell_start[i] = static_cast<uint32_t>(out.vertices.size());
+    const auto* c = m_cell_of[i];
+    if (!c)
+      continue;
+
+    out.has_cell[i] = 1;
+    const auto* e = c->incident_edge();
+    if (!e)
+      continue;
+
+    bool bounded = true;
+    const auto* start = e;
+    do
+    {
+      bounded &= !e->is_infinite();
+      if (e->is_primary() && e->vertex0())
+      {
+        out.vertices.push_back(Point{e->vertex0()->x() / m_input_scale,
+                                     e->vertex0()->y() / m_input_scale});
+      }
+      e = e->next();
+    }
+    while (e != start);
+    out.bounded[i] = bounded;
+  }
+  out.cell_start[count] = static_cast<uint32_t>(out.vertices.size());
+}
+
+///////////////////////////////////////////////////////////////////////
+
+double bvb::Quantization_scale(double width, double height, size_t site_count)
+{
+  // Ghosts put sites anywhere in [-width, 2 * width); 2^30 leaves a factor
+  // of two of headroom below int32 for Boost's coordinate differences
+  double extent = std::max(2.0 * width, height);
+  double scale = std::exp2(std::floor(std::log2(std::exp2(30) / extent)));
+
+  // Sites must stay well apart on the integer grid, or many would collapse
+  const double MIN_STEPS_PER_SPACING = 16.0;
+  double spacing = std::sqrt(width * height / std::max<size_t>(1, site_count));
+  if (spacing * scale < MIN_STEPS_PER_SPACING)
+  {
+    throw std::runtime_error("Map too large for int32 Voronoi input at this site spacing");
+  }
+  return scale;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void bvb::insert_sites(const std::vector<Point>& sites)
+{
+  const size_t count = sites.size();
+  m_builder.clear();
+  m_site_source.clear();
+
+  if (m_site_input == ESite_input::ESITE_INPUT_Scaled)
+  {
+    // Boost truncates the scaled coordinates to its int32 input type
+    for (size_t i = 0; i < count; i++)
+    {
+      m_builder.insert_point(sites[i].x * m_input_scale, sites[i].y * m_input_scale);
+      m_site_source.push_back(static_cast<int>(i));
+    }
+    return;
+  }
+
+  // Snap to the integer grid, rounding to nearest
+  m_quantized_x.resize(count);
+  m_quantized_y.resize(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    m_quantized_x[i] = static_cast<int32_t>(std::lround(sites[i].x * m_input_scale));
+    m_quantized_y[i] = static_cast<int32_t>(std::lround(sites[i].y * m_input_scale));
+  }
+
+  // Sort by snapped position, ties by index, so every duplicate follows the
+  // site it collapses onto
+  m_order.resize(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    m_order[i] = static_cast<int>(i);
+  }
+  std::sort(m_order.begin(), m_order.end(), [&](int a, int b)
+  {
+    if (m_quantized_x[a] != m_quantized_x[b]) return m_quantized_x[a] < m_quantized_x[b];
+    if (m_quantized_y[a] != m_quantized_y[b]) return m_quantized_y[a] < m_quantized_y[b];
+    return a < b;
+  });
+
+  // Flag every site that repeats the one before it
+  m_duplicate.assign(count, 0);
+  for (size_t k = 1; k < count; k++)
+  {
+    int a = m_order[k - 1];
+    int b = m_order[k];
+    if (m_quantized_x[a] == m_quantized_x[b] && m_quantized_y[a] == m_quantized_y[b])
+    {
+      m_duplicate[b] = 1;
+    }
+  }
+
+  // Insert survivors in their original order
+  for (size_t i = 0; i < count; i++)
+  {
+    if (!m_duplicate[i])
+    {
+      m_builder.insert_point(m_quantized_x[i], m_quantized_y[i]);
+      m_site_source.push_back(static_cast<int>(i));
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
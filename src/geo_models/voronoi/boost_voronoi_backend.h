@@ -0,0 +1,121 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef BOOST_VORONOI_BACKEND_H
+#define BOOST_VORONOI_BACKEND_H
+
+// Standard libs
+#include <cstdint>
+#include <vector>
+
+// Boost Polygon
+#include <boost/polygon/voronoi.hpp>
+#include <boost/polygon/voronoi_builder.hpp>
+
+// Application files
+#include <geo_models/voronoi/voronoi_backend.h>
+
+namespace world_builder
+{
+
+/**
+ * @brief Voronoi backend on Boost.Polygon's sweep-line
+ * @details Boost takes int32 input, so sites are either scaled by a fixed
+ * factor (and truncated by Boost) or quantized onto the finest grid the map
+ * allows. The builder and diagram are kept between builds, so their storage
+ * is reused; Boost still allocates internally for its beach line and circle
+ * event queue.
+ */
+class Boost_voronoi_backend : public Voronoi_backend
+{
+public:
+  // Implementation
+  /**
+   * @brief Constructor
+   * @param site_input How sites are converted
+   * @param scale_factor Scale for ESITE_INPUT_Scaled
+   */
+  Boost_voronoi_backend(ESite_input site_input, double scale_factor);
+
+  /**
+   * @brief Fix the integer scale for this map
+   */
+  void Prepare(double width, double height, size_t site_count) override;
+
+  /**
+   * @brief Build the diagram of `sites`
+   */
+  void Build(const std::vector<Point>& sites,
+             const std::vector<unsigned char>& wanted,
+             Flat_diagram& out) override;
+
+  /**
+   * @brief Scale for quantized input: the largest power of two that keeps
+   * the wrapped map inside int32 with headroom. A power of two makes the
+   * conversion back exact.
+   * @param width Map width
+   * @param height Map height
+   * @param site_count Sites on the map, giving their typical spacing
+   * @return The scale
+   * @throws std::runtime_error If that grid is too coarse for the spacing
+   */
+  static double Quantization_scale(double width, double height, size_t site_count);
+
+private:
+  // Attributes
+  /**
+   * @brief How sites are converted
+   */
+  ESite_input m_site_input;
+
+  /**
+   * @brief Scale for ESITE_INPUT_Scaled
+   */
+  double m_scale_factor;
+
+  /**
+   * @brief Scale applied in the current build
+   */
+  double m_input_scale;
+
+  /**
+   * @brief Quantized site coordinates, the sites sorted by them, and which
+   * sites repeat an earlier one
+   */
+  std::vector<int32_t> m_quantized_x;
+  std::vector<int32_t> m_quantized_y;
+  std::vector<int> m_order;
+  std::vector<unsigned char> m_duplicate;
+
+  /**
+   * @brief For each site inserted into the builder, its index into the
+   * input sites
+   */
+  std::vector<int> m_site_source;
+
+  /**
+   * @brief The diagram cell of each input site, null for dropped sites
+   */
+  std::vector<const boost::polygon::voronoi_diagram<double>::cell_type*> m_cell_of;
+
+  /**
+   * @brief Boost's sweep-line builder, holding its site event storage
+   */
+  boost::polygon::default_voronoi_builder m_builder;
+
+  /**
+   * @brief The diagram, holding its cell, edge and vertex storage
+   */
+  boost::polygon::voronoi_diagram<double> m_diagram;
+
+  // Implementation
+  /**
+   * @brief Insert the sites into the builder as the site input asks,
+   * filling m_site_source
+   */
+  void insert_sites(const std::vector<Point>& sites);
+};
+}
+
+#endif
@@ -0,0 +1,150 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+#include <algorithm>
+#include <limits>
+
+// Application files
+#include <geo_models/voronoi/cell_bfs.h>
+#include <utils/task_scheduler.h>
+
+///////////////////////////////////////////////////////////////////////
+
+using cb = world_builder::Cell_bfs;
+
+///////////////////////////////////////////////////////////////////////
+
+cb::Cell_bfs()
+  :
+  m_distance(),
+  m_capacity(0),
+  m_nearest(),
+  m_nearest_capacity(0),
+  m_frontier(),
+  m_next(),
+  m_next_size(0),
+  m_max_distance(-1)
+{ }
+
+///////////////////////////////////////////////////////////////////////
+
+void cb::Run(const Cell_graph& graph,
+             const std::vector<int>& sources,
+             std::vector<int>& distance,
+             std::vector<int>* nearest)
+{
+  // Lowered to the nearest source, so it starts above every cell
+  static constexpr int NO_SOURCE = std::numeric_limits<int>::max();
+
+  const size_t N = graph.Size();
+  if (N > m_capacity)
+  {
+    m_distance.reset(new std::atomic<int>[N]);
+    m_capacity = N;
+  }
+  const bool track = (nearest != nullptr);
+  if (track && N > m_nearest_capacity)
+  {
+    m_nearest.reset(new std::atomic<int>[N]);
+    m_nearest_capacity = N;
+  }
+  Task_scheduler& scheduler = Task_scheduler::Instance();
+  scheduler.Parallel_for(0, N, 4096, [&](size_t lo, size_t hi)
+  {
+    for (size_t i = lo; i < hi; i++)
+    {
+      m_distance[i].store(UNREACHED, std::memory_order_relaxed);
+      if (track)
+        m_nearest[i].store(NO_SOURCE, std::memory_order_relaxed);
+    }
+  });
+
+  // Every cell joins some level at most once, so neither level outgrows N
+  m_frontier.resize(N);
+  m_next.resize(N);
+  size_t frontier_size = 0;
+  for (int source : sources)
+  {
+    if (m_distance[source].exchange(0, std::memory_order_relaxed) == UNREACHED)
+      m_frontier[frontier_size++] = source;
+    if (track)
+      m_nearest[source].store(source, std::memory_order_relaxed);
+  }
+
+  m_max_distance = (frontier_size > 0) ? 0 : -1;
+  for (int level = 1; frontier_size > 0; level++)
+  {
+    m_next_size.store(0, std::memory_order_relaxed);
+    scheduler.Parallel_for(0, frontier_size, FRONTIER_GRAIN, [&](size_t lo, size_t hi)
+    {
+      int claimed[CLAIM_BATCH];
+      size_t claimed_count = 0;
+      auto publish = [&]()
+      {
+        size_t at = m_next_size.fetch_add(claimed_count, std::memory_order_relaxed);
+        std::copy(claimed, claimed + claimed_count, m_next.begin() + at);
+        claimed_count = 0;
+      };
+
+      for (size_t f = lo; f < hi; f++)
+      {
+        const int cell = m_frontier[f];
+        const int source = track ? m_nearest[cell].load(std::memory_order_relaxed) : NO_SOURCE;
+        for (uint32_t k = graph.neighbor_start[cell]; k < graph.neighbor_start[cell + 1]; k++)
+        {
+          std::atomic<int>& d = m_distance[graph.neighbors[k]];
+          int expected = UNREACHED;
+          const bool claimed_here = d.load(std::memory_order_relaxed) == UNREACHED &&
+                                    d.compare_exchange_strong(expected, level, std::memory_order_relaxed);
+
+          // Every neighbor on the next level offers its source, whoever
+          // claimed it
+          if (track && (claimed_here || d.load(std::memory_order_relaxed) == level))
+          {
+            std::atomic<int>& n = m_nearest[graph.neighbors[k]];
+            int current = n.load(std::memory_order_relaxed);
+            while (source < current && !n.compare_exchange_weak(current, source, std::memory_order_relaxed))
+            { }
+          }
+          if (!claimed_here)
+            continue;
+
+          claimed[claimed_count++] = graph.neighbors[k];
+          if (claimed_count == CLAIM_BATCH)
+            publish();
+        }
+      }
+      publish();
+    });
+
+    frontier_size = m_next_size.load(std::memory_order_relaxed);
+    if (frontier_size > 0)
+      m_max_distance = level;
+    m_frontier.swap(m_next);
+  }
+
+  distance.resize(N);
+  scheduler.Parallel_for(0, N, 4096, [&](size_t lo, size_t hi)
+  {
+    for (size_t i = lo; i < hi; i++)
+    {
+      distance[i] = m_distance[i].load(std::memory_order_relaxed);
+    }
+  });
+  if (track)
+  {
+    nearest->resize(N);
+    scheduler.Parallel_for(0, N, 4096, [&](size_t lo, size_t hi)
+    {
+      for (size_t i = lo; i < hi; i++)
+      {
+        const int source = m_nearest[i].load(std::memory_order_relaxed);
+        (*nearest)[i] = (source == NO_SOURCE) ? UNREACHED : source;
+      }
+    });
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
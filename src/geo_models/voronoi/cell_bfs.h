@@ -0,0 +1,110 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef CELL_BFS_H
+#define CELL_BFS_H
+
+// Standard libs
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Application files
+#include <geo_models/voronoi/cell_graph.h>
+
+namespace world_builder
+{
+
+/**
+ * @brief Hop distance of every cell from the nearest of a set of source
+ * cells, over the cell graph
+ * @details Level-synchronous breadth-first search: the cells of one level
+ * are expanded in parallel, and a neighbor joins the next level by claiming
+ * its distance with a compare-and-swap, so every cell is visited once and the
+ * whole search is linear in the cells and links. Which thread claims a cell
+ * varies between runs but its distance does not, so results are
+ * deterministic. The nearest source of every cell can be tracked too: a
+ * cell takes the lowest nearest source among its neighbors one level closer,
+ * which every level settles before the next is expanded, so it is
+ * deterministic as well. The distance and frontier buffers are kept between
+ * runs and only grow, so repeated searches over one map stop allocating
+ * after the first.
+ */
+class Cell_bfs
+{
+public:
+  // Attributes
+  /**
+   * @brief Distance of a cell no source reaches
+   */
+  static constexpr int UNREACHED = -1;
+
+  // Implementation
+  /**
+   * @brief Constructor, with empty buffers
+   */
+  Cell_bfs();
+
+  /**
+   * @brief Search from the sources
+   * @param graph The cell graph
+   * @param sources Cells at distance 0; repeats are fine
+   * @param distance Filled with the hops from each cell to the nearest
+   * source, UNREACHED for a cell in a component without one
+   * @param nearest If set, filled with the nearest source of each cell, the
+   * lowest of those at the same distance, UNREACHED for a cell in a
+   * component without one
+   */
+  void Run(const Cell_graph& graph,
+           const std::vector<int>& sources,
+           std::vector<int>& distance,
+           std::vector<int>* nearest = nullptr);
+
+  /**
+   * @brief Largest distance reached by the last run, -1 if it had no
+   * sources
+   */
+  int Get_max_distance() const { return m_max_distance; }
+
+private:
+  // Attributes
+  /**
+   * @brief Cells expanded per task
+   */
+  static constexpr size_t FRONTIER_GRAIN = 512;
+
+  /**
+   * @brief Cells a task claims before publishing them to the next level
+   */
+  static constexpr size_t CLAIM_BATCH = 256;
+
+  /**
+   * @brief Distance of every cell while searching, and how many it holds
+   */
+  std::unique_ptr<std::atomic<int>[]> m_distance;
+  size_t m_capacity;
+
+  /**
+   * @brief Nearest source of every cell while searching, when tracked
+   */
+  std::unique_ptr<std::atomic<int>[]> m_nearest;
+  size_t m_nearest_capacity;
+
+  /**
+   * @brief The level being expanded and the one being claimed, with how
+   * much of the latter is filled
+   */
+  std::vector<int> m_frontier;
+  std::vector<int> m_next;
+  std::atomic<size_t> m_next_size;
+
+  /**
+   * @brief Largest distance reached by the last run
+   */
+  int m_max_distance;
+};
+}
+
+#endif
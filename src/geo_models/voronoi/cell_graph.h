@@ -0,0 +1,44 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef CELL_GRAPH_H
+#define CELL_GRAPH_H
+
+// Standard libs
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Application files
+
+namespace world_builder
+{
+
+/**
+ * @brief Which Voronoi cells share an edge, as CSR
+ * @details Cell c borders neighbors[neighbor_start[c] .. neighbor_start[c + 1]),
+ * in ascending order. Every link is listed from both ends.
+ */
+struct Cell_graph
+{
+  // Attributes
+  /**
+   * @brief Start of every cell's neighbors, one past the last at the end
+   */
+  std::vector<uint32_t> neighbor_start;
+
+  /**
+   * @brief Neighbors grouped by cell
+   */
+  std::vector<int> neighbors;
+
+  // Implementation
+  /**
+   * @brief Number of cells
+   */
+  size_t Size() const { return neighbor_start.empty() ? 0 : neighbor_start.size() - 1; }
+};
+}
+
+#endif
@@ -0,0 +1,86 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+
+// Application files
+#include <geo_models/voronoi/cell_hierarchy.h>
+
+///////////////////////////////////////////////////////////////////////
+
+using ch = world_builder::Cell_hierarchy;
+
+///////////////////////////////////////////////////////////////////////
+
+ch::Cell_hierarchy()
+  :
+  m_parents(),
+  m_child_start(1, 0),
+  m_children(),
+  m_fine_sites()
+{ }
+
+///////////////////////////////////////////////////////////////////////
+
+void ch::Build(Voronoi_builder& coarse, const Voronoi_builder& fine)
+{
+  const std::vector<Cell>& fine_cells = fine.Get_cells();
+  m_fine_sites.resize(fine_cells.size());
+  for (size_t i = 0; i < fine_cells.size(); i++)
+  {
+    m_fine_sites[i] = fine_cells[i].site;
+  }
+  const size_t coarse_count = coarse.Get_cells().size();
+  if (coarse_count == 0)
+  {
+    m_parents.clear();
+    m_child_start.assign(1, 0);
+    m_children.clear();
+    return;
+  }
+  coarse.Locate_points(m_fine_sites, m_parents);
+
+  // Counting sort of the fine cells by parent; filling in fine order keeps
+  // every child range ascending
+  m_child_start.assign(coarse_count + 1, 0);
+  for (int parent : m_parents)
+  {
+    m_child_start[parent + 1]++;
+  }
+  for (size_t c = 0; c < coarse_count; c++)
+  {
+    m_child_start[c + 1] += m_child_start[c];
+  }
+
+  m_children.resize(m_parents.size());
+  std::vector<uint32_t> next(m_child_start.begin(), m_child_start.end() - 1);
+  for (size_t i = 0; i < m_parents.size(); i++)
+  {
+    m_children[next[m_parents[i]]++] = static_cast<int>(i);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void ch::Gather_mean(const std::vector<double>& fine_values, std::vector<double>& coarse_values) const
+{
+  const size_t coarse_count = Get_coarse_count();
+  coarse_values.resize(coarse_count);
+  Task_scheduler::Instance().Parallel_for(0, coarse_count, 64, [&](size_t lo, size_t hi)
+  {
+    for (size_t c = lo; c < hi; c++)
+    {
+      const uint32_t begin = m_child_start[c];
+      const uint32_t end = m_child_start[c + 1];
+      double sum = 0;
+      for (uint32_t k = begin; k < end; k++)
+      {
+        sum += fine_values[m_children[k]];
+      }
+      coarse_values[c] = (end > begin) ? sum / (end - begin) : 0.0;
+    }
+  });
+}
+
+///////////////////////////////////////////////////////////////////////
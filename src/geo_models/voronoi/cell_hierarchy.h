@@ -0,0 +1,113 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef CELL_HIERARCHY_H
+#define CELL_HIERARCHY_H
+
+// Standard libs
+#include <cstdint>
+#include <vector>
+
+// Application files
+#include <geo_models/voronoi/voronoi_builder.h>
+#include <utils/task_scheduler.h>
+
+namespace world_builder
+{
+
+/**
+ * @brief Links a coarse Voronoi layer to a fine one over the same map, so
+ * large-scale structure (continents, plates) can be decided on a few thousand
+ * coarse cells and handed down to millions of fine cells
+ * @details The parent of a fine cell is the coarse cell containing its site.
+ * The children of every coarse cell are kept as CSR: coarse cell c owns
+ * Get_children()[Get_child_start()[c] .. Get_child_start()[c + 1]), in
+ * ascending order. Both directions are one linear pass.
+ */
+class Cell_hierarchy
+{
+public:
+  // Implementation
+  /**
+   * @brief Constructor, with no cells
+   */
+  Cell_hierarchy();
+
+  /**
+   * @brief Link the current cells of two layers; nothing is linked if the
+   * coarse layer has no cells
+   * @param coarse The coarse layer; its point locator is built if stale
+   * @param fine The fine layer
+   */
+  void Build(Voronoi_builder& coarse, const Voronoi_builder& fine);
+
+  /**
+   * @brief Hand coarse values down to the fine cells, in parallel
+   * @param coarse_values One value per coarse cell
+   * @param fine_values Filled with one value per fine cell, its parent's
+   */
+  template <typename T>
+  void Propagate(const std::vector<T>& coarse_values, std::vector<T>& fine_values) const
+  {
+    fine_values.resize(m_parents.size());
+    Task_scheduler::Instance().Parallel_for(0, m_parents.size(), 4096, [&](size_t lo, size_t hi)
+    {
+      for (size_t i = lo; i < hi; i++)
+      {
+        fine_values[i] = coarse_values[m_parents[i]];
+      }
+    });
+  }
+
+  /**
+   * @brief Average fine values over each coarse cell's children, in parallel
+   * @param fine_values One value per fine cell
+   * @param coarse_values Filled with one value per coarse cell, 0 for a cell
+   * without children
+   */
+  void Gather_mean(const std::vector<double>& fine_values, std::vector<double>& coarse_values) const;
+
+  /**
+   * @brief Coarse cell of every fine cell
+   */
+  const std::vector<int>& Get_parents() const { return m_parents; }
+
+  /**
+   * @brief Start of every coarse cell's children, one past the last cell at
+   * the end
+   */
+  const std::vector<uint32_t>& Get_child_start() const { return m_child_start; }
+
+  /**
+   * @brief Fine cells grouped by parent
+   */
+  const std::vector<int>& Get_children() const { return m_children; }
+
+  /**
+   * @brief Layer sizes
+   */
+  size_t Get_coarse_count() const { return m_child_start.size() - 1; }
+  size_t Get_fine_count() const { return m_parents.size(); }
+
+private:
+  // Attributes
+  /**
+   * @brief Coarse cell of every fine cell
+   */
+  std::vector<int> m_parents;
+
+  /**
+   * @brief Children of every coarse cell, see Get_child_start()
+   */
+  std::vector<uint32_t> m_child_start;
+  std::vector<int> m_children;
+
+  /**
+   * @brief Fine sites, as located in the coarse layer
+   */
+  std::vector<Point> m_fine_sites;
+};
+}
+
+#endif
@@ -0,0 +1,150 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Application files
+#include <geo_models/voronoi/cell_locator.h>
+
+///////////////////////////////////////////////////////////////////////
+
+using cl = world_builder::Cell_locator;
+
+///////////////////////////////////////////////////////////////////////
+
+cl::Cell_locator()
+  :
+  m_width(0),
+  m_height(0),
+  m_grid_width(1),
+  m_grid_height(1),
+  m_cell_width(1),
+  m_cell_height(1),
+  m_grid_start(2, 0),
+  m_site_x(),
+  m_site_y(),
+  m_site_index()
+{ }
+
+///////////////////////////////////////////////////////////////////////
+
+void cl::Build(const std::vector<Point>& sites, double width, double height)
+{
+  m_width = width;
+  m_height = height;
+
+  // About one site per bucket, with a whole number of columns across the map
+  double spacing = std::sqrt(width * height / std::max<size_t>(1, sites.size()));
+  m_grid_width = std::max(1, static_cast<int>(width / spacing));
+  m_grid_height = std::max(1, static_cast<int>(height / spacing));
+  m_cell_width = width / m_grid_width;
+  m_cell_height = height / m_grid_height;
+
+  // Counting sort of the sites by bucket
+  auto bucket_of = [&](const Point& p)
+  {
+    int gx = std::clamp(static_cast<int>(p.x / m_cell_width), 0, m_grid_width - 1);
+    int gy = std::clamp(static_cast<int>(p.y / m_cell_height), 0, m_grid_height - 1);
+    return static_cast<size_t>(gy) * m_grid_width + gx;
+  };
+  m_grid_start.assign(static_cast<size_t>(m_grid_width) * m_grid_height + 1, 0);
+  for (const auto& p : sites)
+  {
+    m_grid_start[bucket_of(p) + 1]++;
+  }
+  for (size_t g = 1; g < m_grid_start.size(); g++)
+  {
+    m_grid_start[g] += m_grid_start[g - 1];
+  }
+
+  m_site_x.resize(sites.size());
+  m_site_y.resize(sites.size());
+  m_site_index.resize(sites.size());
+  std::vector<uint32_t> next(m_grid_start.begin(), m_grid_start.end() - 1);
+  for (size_t i = 0; i < sites.size(); i++)
+  {
+    uint32_t slot = next[bucket_of(sites[i])]++;
+    m_site_x[slot] = sites[i].x;
+    m_site_y[slot] = sites[i].y;
+    m_site_index[slot] = static_cast<int>(i);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+
+int cl::Nearest(double x, double y) const
+{
+  if (m_site_index.empty())
+    return -1;
+
+  x -= m_width * std::floor(x / m_width);
+  const int gx = std::clamp(static_cast<int>(x / m_cell_width), 0, m_grid_width - 1);
+  const int gy = std::clamp(static_cast<int>(y / m_cell_height), 0, m_grid_height - 1);
+
+  // Column offsets that reach each column once around the seam
+  const int left_reach = (m_grid_width - 1) / 2;
+  const int right_reach = m_grid_width / 2;
+  const int last_ring = std::max(std::max(gy, m_grid_height - 1 - gy), right_reach);
+  const double ring_step = std::min(m_cell_width, m_cell_height);
+
+  double best_d2 = std::numeric_limits<double>::max();
+  int best = -1;
+  auto scan = [&](int row, int dc)
+  {
+    int col = gx + dc;
+    if (col < 0) col += m_grid_width;
+    if (col >= m_grid_width) col -= m_grid_width;
+    size_t g = static_cast<size_t>(row) * m_grid_width + col;
+    for (uint32_t k = m_grid_start[g]; k < m_grid_start[g + 1]; k++)
+    {
+      double dx = std::abs(m_site_x[k] - x);
+      dx = std::min(dx, m_width - dx);
+      double dy = m_site_y[k] - y;
+      double d2 = dx*dx + dy*dy;
+      if (d2 < best_d2 || (d2 == best_d2 && m_site_index[k] < best))
+      {
+        best_d2 = d2;
+        best = m_site_index[k];
+      }
+    }
+  };
+
+  for (int ring = 0; ring <= last_ring; ring++)
+  {
+    const int dc_lo = -std::min(ring, left_reach);
+    const int dc_hi = std::min(ring, right_reach);
+    for (int dr = -ring; dr <= ring; dr++)
+    {
+      int row = gy + dr;
+      if (row < 0 || row >= m_grid_height)
+        continue;
+
+      if (dr == -ring || dr == ring)
+      {
+        // Full top and bottom rows of the ring
+        for (int dc = dc_lo; dc <= dc_hi; dc++)
+          scan(row, dc);
+      }
+      else
+      {
+        // Side columns, unless the seam already folded them into earlier rings
+        if (-ring == dc_lo)
+          scan(row, -ring);
+        if (ring == dc_hi && ring != 0)
+          scan(row, ring);
+      }
+    }
+
+    // Every unscanned site is more than `ring` buckets away
+    double reach = ring * ring_step;
+    if (best >= 0 && best_d2 <= reach * reach)
+      break;
+  }
+  return best;
+}
+
+///////////////////////////////////////////////////////////////////////
@@ -0,0 +1,80 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef CELL_LOCATOR_H
+#define CELL_LOCATOR_H
+
+// Standard libs
+#include <cstdint>
+#include <vector>
+
+// Application files
+#include <geo_models/voronoi/poisson_disc.h>
+
+namespace world_builder
+{
+
+/**
+ * @brief Finds the site nearest a map position, which is the Voronoi cell
+ * containing it, with the map wrapping east to west
+ * @details Sites are bucketed into a uniform grid about one site spacing on
+ * a side, like the background grid of Poisson_disc, whose columns divide the
+ * map width exactly so buckets wrap across the seam. A query searches rings
+ * of buckets around its own until the ring is further away than the best
+ * site found, which for evenly spaced sites is one or two rings: O(1)
+ * expected time, independent of the site count.
+ */
+class Cell_locator
+{
+public:
+  // Implementation
+  /**
+   * @brief Constructor, with no sites
+   */
+  Cell_locator();
+
+  /**
+   * @brief Index the sites
+   * @param sites Sites inside [0, width) x [0, height)
+   * @param width Map width
+   * @param height Map height
+   */
+  void Build(const std::vector<Point>& sites, double width, double height);
+
+  /**
+   * @brief Nearest site to (x, y), measuring x the short way around the
+   * seam; equally near sites resolve to the lowest index. Any x is wrapped
+   * onto the map.
+   * @return Index into the indexed sites, -1 if there are none
+   */
+  int Nearest(double x, double y) const;
+
+private:
+  // Attributes
+  /**
+   * @brief Map size
+   */
+  double m_width;
+  double m_height;
+
+  /**
+   * @brief Bucket grid size and bucket sides
+   */
+  int m_grid_width;
+  int m_grid_height;
+  double m_cell_width;
+  double m_cell_height;
+
+  /**
+   * @brief Sites of bucket g are entries m_grid_start[g] .. m_grid_start[g + 1]
+   * of the arrays below, which hold them bucket by bucket for locality
+   */
+  std::vector<uint32_t> m_grid_start;
+  std::vector<double> m_site_x;
+  std::vector<double> m_site_y;
+  std::vector<int> m_site_index;
+};
+}
+
+#endif
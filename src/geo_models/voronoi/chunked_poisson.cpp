@@ -0,0 +1,260 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+#include <cmath>
+#include <stdexcept>
+
+// Application files
+#include <geo_models/voronoi/chunked_poisson.h>
+#include <utils/task_scheduler.h>
+
+///////////////////////////////////////////////////////////////////////
+
+using cp = world_builder::Chunked_poisson;
+
+///////////////////////////////////////////////////////////////////////
+
+namespace
+{
+/**
+ * @brief SplitMix64 finalizer
+ */
+uint64_t Mix_bits(uint64_t value)
+{
+  value += 0x9e3779b97f4a7c15ULL;
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+  return value ^ (value >> 31);
+}
+}
+
+///////////////////////////////////////////////////////////////////////
+
+size_t cp::Chunk_key_hash::operator()(const Chunk_key& key) const
+{
+  return static_cast<size_t>(Mix_bits(static_cast<uint64_t>(key.first) ^
+                                      Mix_bits(static_cast<uint64_t>(key.second))));
+}
+
+///////////////////////////////////////////////////////////////////////
+
+cp::Chunked_poisson(double chunk_size,
+                    double radius,
+                    int attempts,
+                    uint64_t seed,
+                    size_t cache_capacity)
+  :
+  m_chunk_size(chunk_size),
+  m_radius(radius),
+  m_attempts(attempts),
+  m_seed(seed),
+  m_cache_capacity(std::max<size_t>(1, cache_capacity)),
+  m_cache(),
+  m_lru(),
+  m_cache_mutex()
+{
+  // Neighbors' points within 2r of a chunk must all come from the eight
+  // chunks around it
+  if(m_chunk_size < 2.0 * m_radius)
+  {
+    throw std::invalid_argument("Chunk size must be at least twice the point radius");
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<const cp::Chunk_points> cp::Get_chunk(int64_t chunk_x, int64_t chunk_y)
+{
+  return get_chunk(chunk_x, chunk_y, nullptr);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+std::vector<world_builder::Point> cp::Generate_region(double min_x, double min_y, double max_x, double max_y)
+{
+  int64_t first_x = static_cast<int64_t>(std::floor(min_x / m_chunk_size));
+  int64_t first_y = static_cast<int64_t>(std::floor(min_y / m_chunk_size));
+  int64_t last_x = static_cast<int64_t>(std::ceil(max_x / m_chunk_size)) - 1;
+  int64_t last_y = static_cast<int64_t>(std::ceil(max_y / m_chunk_size)) - 1;
+
+  // Phase p chunks reach back through at most 3 - p earlier phases, so
+  // generate each phase over the region grown by that many chunks. Chunks of
+  // one phase are independent of each other. Every chunk is pinned until the
+  // region is done, so a small cache never forces regeneration.
+  auto& scheduler = world_builder::Task_scheduler::Instance();
+  Pinned_chunks pinned;
+  for(int p = 0; p < 4; ++p)
+  {
+    int64_t grow = 3 - p;
+    std::vector<Chunk_key> keys;
+    for(int64_t y = first_y - grow; y <= last_y + grow; ++y)
+    {
+      for(int64_t x = first_x - grow; x <= last_x + grow; ++x)
+      {
+        if(phase(x, y) == p)
+        {
+          keys.push_back({x, y});
+        }
+      }
+    }
+
+    std::vector<std::shared_ptr<const Chunk_points>> generated(keys.size());
+    scheduler.Parallel_for(0, keys.size(), 1, [&](size_t lo, size_t hi)
+    {
+      for(size_t i = lo; i < hi; ++i)
+      {
+        generated[i] = get_chunk(keys[i].first, keys[i].second, &pinned);
+      }
+    });
+
+    for(size_t i = 0; i < keys.size(); ++i)
+    {
+      pinned.emplace(keys[i], std::move(generated[i]));
+    }
+  }
+
+  std::vector<Point> points;
+  for(int64_t y = first_y; y <= last_y; ++y)
+  {
+    for(int64_t x = first_x; x <= last_x; ++x)
+    {
+      for(const auto& p : *pinned.at({x, y}))
+      {
+        if(p.x >= min_x && p.x < max_x && p.y >= min_y && p.y < max_y)
+        {
+          points.push_back(p);
+        }
+      }
+    }
+  }
+  return points;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+size_t cp::Get_cached_count()
+{
+  std::lock_guard<std::mutex> lock(m_cache_mutex);
+  return m_cache.size();
+}
+
+///////////////////////////////////////////////////////////////////////
+
+int cp::phase(int64_t chunk_x, int64_t chunk_y)
+{
+  return static_cast<int>(chunk_x & 1) + 2 * static_cast<int>(chunk_y & 1);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<const cp::Chunk_points> cp::get_chunk(int64_t chunk_x,
+                                                      int64_t chunk_y,
+                                                      const Pinned_chunks* pinned)
+{
+  Chunk_key key{chunk_x, chunk_y};
+  if(pinned)
+  {
+    auto it = pinned->find(key);
+    if(it != pinned->end())
+    {
+      return it->second;
+    }
+  }
+  if(auto cached = find_cached(key))
+  {
+    return cached;
+  }
+
+  // Generated outside the lock; a concurrent duplicate produces identical
+  // points and the first insert wins
+  auto points = std::make_shared<const Chunk_points>(generate_chunk(chunk_x, chunk_y, pinned));
+  return insert_cached(key, std::move(points));
+}
+
+///////////////////////////////////////////////////////////////////////
+
+cp::Chunk_points cp::generate_chunk(int64_t chunk_x, int64_t chunk_y, const Pinned_chunks* pinned)
+{
+  const double origin_x = chunk_x * m_chunk_size;
+  const double origin_y = chunk_y * m_chunk_size;
+  const double reach = 2.0 * m_radius;
+  const int my_phase = phase(chunk_x, chunk_y);
+
+  // Points of earlier-phase neighbors close enough to block or seed this
+  // chunk, in chunk-local coordinates
+  std::vector<Point> fixed_points;
+  for(int64_t dy = -1; dy <= 1; ++dy)
+  {
+    for(int64_t dx = -1; dx <= 1; ++dx)
+    {
+      if((dx == 0 && dy == 0) || phase(chunk_x + dx, chunk_y + dy) >= my_phase)
+      {
+        continue;
+      }
+
+      for(const auto& p : *get_chunk(chunk_x + dx, chunk_y + dy, pinned))
+      {
+        double local_x = p.x - origin_x;
+        double local_y = p.y - origin_y;
+        if(local_x >= -reach && local_x < m_chunk_size + reach &&
+           local_y >= -reach && local_y < m_chunk_size + reach)
+        {
+          fixed_points.push_back(Point{local_x, local_y});
+        }
+      }
+    }
+  }
+
+  uint64_t chunk_seed = Mix_bits(m_seed ^ Mix_bits(static_cast<uint64_t>(chunk_x) ^
+                                                   Mix_bits(static_cast<uint64_t>(chunk_y))));
+  Poisson_disc sampler(m_chunk_size, m_chunk_size, m_radius, m_attempts, chunk_seed);
+  Chunk_points points = sampler.Generate(fixed_points);
+  for(auto& p : points)
+  {
+    p.x += origin_x;
+    p.y += origin_y;
+  }
+  return points;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<const cp::Chunk_points> cp::find_cached(const Chunk_key& key)
+{
+  std::lock_guard<std::mutex> lock(m_cache_mutex);
+  auto it = m_cache.find(key);
+  if(it == m_cache.end())
+  {
+    return nullptr;
+  }
+  m_lru.splice(m_lru.begin(), m_lru, it->second.lru_position);
+  return it->second.points;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<const cp::Chunk_points> cp::insert_cached(const Chunk_key& key,
+                                                          std::shared_ptr<const Chunk_points> points)
+{
+  std::lock_guard<std::mutex> lock(m_cache_mutex);
+  auto it = m_cache.find(key);
+  if(it != m_cache.end())
+  {
+    m_lru.splice(m_lru.begin(), m_lru, it->second.lru_position);
+    return it->second.points;
+  }
+
+  m_lru.push_front(key);
+  m_cache.emplace(key, Cache_entry{points, m_lru.begin()});
+
+  while(m_cache.size() > m_cache_capacity)
+  {
+    m_cache.erase(m_lru.back());
+    m_lru.pop_back();
+  }
+  return points;
+}
+
+///////////////////////////////////////////////////////////////////////
@@ -0,0 +1,192 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef CHUNKED_POISSON_H
+#define CHUNKED_POISSON_H
+
+// Standard libs
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Application files
+#include <geo_models/voronoi/poisson_disc.h>
+
+namespace world_builder
+{
+
+/**
+ * @brief Poisson disc sampling of an unbounded plane, one square chunk at a
+ * time
+ * @details A chunk's points are a pure function of (seed, chunk coordinates),
+ * whatever order chunks are requested in, and they join seamlessly with the
+ * points of neighboring chunks.
+ *
+ * Chunks are coloured by coordinate parity into four phases. A chunk only
+ * depends on its neighbors in earlier phases: their points near the shared
+ * border are fixed obstacles and growth seeds for the chunk's own sampler.
+ * Chunks in the same phase are never adjacent, so they are independent and
+ * can be generated in parallel, and the dependency chain is at most three
+ * chunks deep.
+ *
+ * Generated chunks live in an LRU cache of bounded size; evicted chunks are
+ * simply regenerated, identically, when next needed.
+ */
+class Chunked_poisson
+{
+public:
+  // Attributes
+  /**
+   * @brief Chunk coordinates, (x, y) in units of the chunk size
+   */
+  using Chunk_key = std::pair<int64_t, int64_t>;
+
+  /**
+   * @brief Points of one chunk, in world coordinates
+   */
+  using Chunk_points = std::vector<Point>;
+
+  // Implementation
+  /**
+   * @brief Constructor
+   * @param chunk_size Side of a chunk, at least twice `radius`
+   * @param radius Minimum distance between points
+   * @param attempts Candidates tried per active point
+   * @param seed World seed
+   * @param cache_capacity Most chunks kept in memory
+   */
+  Chunked_poisson(double chunk_size,
+                  double radius,
+                  int attempts,
+                  uint64_t seed,
+                  size_t cache_capacity = 256);
+
+  /**
+   * @brief Points of one chunk, generating it (and any missing
+   * dependencies) if needed. Safe to call from several threads.
+   * @param chunk_x Chunk column
+   * @param chunk_y Chunk row
+   * @return The points; stays valid after the chunk is evicted
+   */
+  std::shared_ptr<const Chunk_points> Get_chunk(int64_t chunk_x, int64_t chunk_y);
+
+  /**
+   * @brief All points inside a rectangle, generating the chunks it covers
+   * phase by phase in parallel
+   * @param min_x
+   * @param min_y
+   * @param max_x Exclusive
+   * @param max_y Exclusive
+   * @return The points, ordered by chunk row, then chunk column
+   */
+  std::vector<Point> Generate_region(double min_x, double min_y, double max_x, double max_y);
+
+  /**
+   * @brief Number of chunks currently cached
+   */
+  size_t Get_cached_count();
+
+private:
+  // Attributes
+  /**
+   * @brief Hash for chunk keys
+   */
+  struct Chunk_key_hash
+  {
+    size_t operator()(const Chunk_key& key) const;
+  };
+
+  /**
+   * @brief A cached chunk and its place in the LRU list
+   */
+  struct Cache_entry
+  {
+    std::shared_ptr<const Chunk_points> points;
+    std::list<Chunk_key>::iterator lru_position;
+  };
+
+  /**
+   * @brief Side of a chunk
+   */
+  double m_chunk_size;
+
+  /**
+   * @brief Minimum distance between points
+   */
+  double m_radius;
+
+  /**
+   * @brief Candidates tried per active point
+   */
+  int m_attempts;
+
+  /**
+   * @brief World seed
+   */
+  uint64_t m_seed;
+
+  /**
+   * @brief Most chunks kept in memory
+   */
+  size_t m_cache_capacity;
+
+  /**
+   * @brief Cached chunks
+   */
+  std::unordered_map<Chunk_key, Cache_entry, Chunk_key_hash> m_cache;
+
+  /**
+   * @brief Cached keys, most recently used first
+   */
+  std::list<Chunk_key> m_lru;
+
+  /**
+   * @brief Guards m_cache and m_lru
+   */
+  std::mutex m_cache_mutex;
+
+  // Implementation
+  /**
+   * @brief Phase of a chunk, 0 to 3, from its coordinate parity
+   */
+  static int phase(int64_t chunk_x, int64_t chunk_y);
+
+  /**
+   * @brief Chunks held by Generate_region while it runs, so dependencies
+   * never have to be regenerated after an eviction
+   */
+  using Pinned_chunks = std::unordered_map<Chunk_key, std::shared_ptr<const Chunk_points>, Chunk_key_hash>;
+
+  /**
+   * @brief Get_chunk, checking `pinned` before the cache
+   */
+  std::shared_ptr<const Chunk_points> get_chunk(int64_t chunk_x, int64_t chunk_y, const Pinned_chunks* pinned);
+
+  /**
+   * @brief Sample one chunk given its earlier-phase neighbors
+   */
+  Chunk_points generate_chunk(int64_t chunk_x, int64_t chunk_y, const Pinned_chunks* pinned);
+
+  /**
+   * @brief Look up a chunk, marking it most recently used
+   * @return The points, or null if not cached
+   */
+  std::shared_ptr<const Chunk_points> find_cached(const Chunk_key& key);
+
+  /**
+   * @brief Cache a chunk, evicting the least recently used beyond capacity
+   * @return The cached points, which are an earlier copy if another thread
+   * got there first
+   */
+  std::shared_ptr<const Chunk_points> insert_cached(const Chunk_key& key,
+                                                    std::shared_ptr<const Chunk_points> points);
+};
+}
+
+#endif
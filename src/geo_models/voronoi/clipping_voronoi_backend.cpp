@@ -0,0 +1,296 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+#include <algorithm>
+#include <cmath>
+
+// Application files
+#include <geo_models/voronoi/clipping_voronoi_backend.h>
+#include <utils/task_scheduler.h>
+
+///////////////////////////////////////////////////////////////////////
+
+using cvb = world_builder::Clipping_voronoi_backend;
+
+///////////////////////////////////////////////////////////////////////
+
+cvb::Clipping_voronoi_backend()
+  :
+  m_min_x(0),
+  m_min_y(0),
+  m_max_x(0),
+  m_max_y(0),
+  m_cell_size(1),
+  m_grid_width(1),
+  m_grid_height(1),
+  m_grid_start(),
+  m_grid_sites(),
+  m_blocks()
+{ }
+
+///////////////////////////////////////////////////////////////////////
+
+void cvb::Prepare(double /*width*/, double /*height*/, size_t /*site_count*/)
+{ }
+
+///////////////////////////////////////////////////////////////////////
+
+void cvb::Build(const std::vector<Point>& sites,
+                const std::vector<unsigned char>& wanted,
+                Flat_diagram& out)
+{
+  const size_t count = sites.size();
+  out.Reset(count);
+  if (count == 0)
+    return;
+
+  bucket_sites(sites);
+
+  const size_t block_count = (count + BLOCK_SITES - 1) / BLOCK_SITES;
+  m_blocks.resize(block_count);
+  world_builder::Task_scheduler::Instance().Parallel_for(0, block_count, 1, [&](size_t lo, size_t hi)
+  {
+    Polygon polygon;
+    Polygon scratch;
+    for (size_t b = lo; b < hi; b++)
+    {
+      Block& block = m_blocks[b];
+      const size_t first = b * BLOCK_SITES;
+      const size_t last = std::min(count, first + BLOCK_SITES);
+      block.counts.assign(last - first, 0);
+      block.vertices.clear();
+
+      for (size_t i = first; i < last; i++)
+      {
+        if (!wanted[i] || !build_cell(sites, static_cast<int>(i), polygon, scratch))
+          continue;
+
+        // A cell still touching the box is unbounded; keep only the vertices
+        // where two bisectors meet, as a full diagram would have
+        const size_t n = polygon.vertices.size();
+        bool bounded = std::none_of(polygon.edge_site.begin(), polygon.edge_site.end(),
+                                    [](int s) { return s == BOX_EDGE; });
+        size_t before = block.vertices.size();
+        for (size_t k = 0; k < n; k++)
+        {
+          if (bounded || (polygon.edge_site[k] != BOX_EDGE &&
+                          polygon.edge_site[(k + n - 1) % n] != BOX_EDGE))
+          {
+            block.vertices.push_back(polygon.vertices[k]);
+          }
+        }
+        block.counts[i - first] = static_cast<uint32_t>(block.vertices.size() - before);
+        out.has_cell[i] = 1;
+        out.bounded[i] = bounded;
+      }
+    }
+  });
+
+  // Join the blocks in order
+  uint32_t offset = 0;
+  for (size_t b = 0; b < block_count; b++)
+  {
+    const Block& block = m_blocks[b];
+    for (size_t k = 0; k < block.counts.size(); k++)
+    {
+      out.cell_start[b * BLOCK_SITES + k] = offset;
+      offset += block.counts[k];
+    }
+    out.vertices.insert(out.vertices.end(), block.vertices.begin(), block.vertices.end());
+  }
+  out.cell_start[count] = offset;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void cvb::bucket_sites(const std::vector<Point>& sites)
+{
+  m_min_x = m_max_x = sites[0].x;
+  m_min_y = m_max_y = sites[0].y;
+  for (const auto& p : sites)
+  {
+    m_min_x = std::min(m_min_x, p.x);
+    m_max_x = std::max(m_max_x, p.x);
+    m_min_y = std::min(m_min_y, p.y);
+    m_max_y = std::max(m_max_y, p.y);
+  }
+
+  // About one site per grid cell
+  double extent_x = m_max_x - m_min_x;
+  double extent_y = m_max_y - m_min_y;
+  double area = extent_x * extent_y;
+  m_cell_size = (area > 0) ? std::sqrt(area / sites.size())
+                           : std::max(1.0, std::max(extent_x, extent_y));
+  m_grid_width = static_cast<int>(extent_x / m_cell_size) + 1;
+  m_grid_height = static_cast<int>(extent_y / m_cell_size) + 1;
+
+  // Counting sort of the sites by grid cell
+  auto cell_of = [&](const Point& p)
+  {
+    int gx = std::min(static_cast<int>((p.x - m_min_x) / m_cell_size), m_grid_width - 1);
+    int gy = std::min(static_cast<int>((p.y - m_min_y) / m_cell_size), m_grid_height - 1);
+    return static_cast<size_t>(gy) * m_grid_width + gx;
+  };
+  m_grid_start.assign(static_cast<size_t>(m_grid_width) * m_grid_height + 1, 0);
+  for (const auto& p : sites)
+  {
+    m_grid_start[cell_of(p) + 1]++;
+  }
+  for (size_t g = 1; g < m_grid_start.size(); g++)
+  {
+    m_grid_start[g] += m_grid_start[g - 1];
+  }
+  m_grid_sites.resize(sites.size());
+  for (size_t i = 0; i < sites.size(); i++)
+  {
+    m_grid_sites[m_grid_start[cell_of(sites[i])]++] = static_cast<int>(i);
+  }
+
+  // The fill loop advanced every start to the next cell's; shift them back
+  for (size_t g = m_grid_start.size() - 1; g > 0; g--)
+  {
+    m_grid_start[g] = m_grid_start[g - 1];
+  }
+  m_grid_start[0] = 0;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+bool cvb::build_cell(const std::vector<Point>& sites, int site, Polygon& polygon, Polygon& scratch) const
+{
+  const Point& p = sites[site];
+
+  // Start from a box well beyond every site, so any vertex of a bounded cell
+  // is inside it
+  double margin = std::max(m_max_x - m_min_x, m_max_y - m_min_y) + m_cell_size;
+  double x0 = m_min_x - margin;
+  double y0 = m_min_y - margin;
+  double x1 = m_max_x + margin;
+  double y1 = m_max_y + margin;
+  polygon.vertices.assign({Point{x0, y0}, Point{x1, y0}, Point{x1, y1}, Point{x0, y1}});
+  polygon.edge_site.assign(4, BOX_EDGE);
+
+  const int gx = std::min(static_cast<int>((p.x - m_min_x) / m_cell_size), m_grid_width - 1);
+  const int gy = std::min(static_cast<int>((p.y - m_min_y) / m_cell_size), m_grid_height - 1);
+  const int last_ring = std::max(std::max(gx, m_grid_width - 1 - gx),
+                                 std::max(gy, m_grid_height - 1 - gy));
+
+  for (int ring = 0; ring <= last_ring; ring++)
+  {
+    // Grid cells at Chebyshev distance `ring`: full top and bottom rows, then
+    // the two side columns between them
+    int row_lo = std::max(0, gy - ring);
+    int row_hi = std::min(m_grid_height - 1, gy + ring);
+    for (int row = row_lo; row <= row_hi; row++)
+    {
+      bool full_row = (row == gy - ring || row == gy + ring);
+      int step = full_row ? 1 : 2 * ring;
+      for (int col = gx - ring; col <= gx + ring; col += std::max(1, step))
+      {
+        if (col < 0 || col >= m_grid_width)
+          continue;
+
+        size_t g = static_cast<size_t>(row) * m_grid_width + col;
+        for (uint32_t k = m_grid_start[g]; k < m_grid_start[g + 1]; k++)
+        {
+          int other = m_grid_sites[k];
+          if (other == site)
+            continue;
+
+          const Point& q = sites[other];
+          if (q.x == p.x && q.y == p.y)
+          {
+            // Coincident sites share one cell, owned by the first
+            if (other < site)
+              return false;
+            continue;
+          }
+          clip(p, q, other, polygon, scratch);
+        }
+      }
+    }
+
+    // Unvisited sites are at least `ring` grid cells away, and a site can
+    // only cut the cell if it is nearer than twice the farthest vertex
+    const size_t n = polygon.vertices.size();
+    bool on_box = false;
+    double farthest = 0;
+    for (size_t k = 0; k < n; k++)
+    {
+      bool box_vertex = polygon.edge_site[k] == BOX_EDGE ||
+                        polygon.edge_site[(k + n - 1) % n] == BOX_EDGE;
+      on_box |= box_vertex;
+      if (!box_vertex)
+      {
+        double dx = polygon.vertices[k].x - p.x;
+        double dy = polygon.vertices[k].y - p.y;
+        farthest = std::max(farthest, dx*dx + dy*dy);
+      }
+    }
+    double reach = ring * m_cell_size;
+    if ((!on_box || ring >= HULL_RINGS) && 4.0 * farthest <= reach * reach)
+      break;
+    if (ring >= MAX_RINGS)
+      break;
+  }
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+bool cvb::clip(const Point& site, const Point& other, int other_index, Polygon& polygon, Polygon& scratch)
+{
+  // Signed distance past the bisector, scaled by |d|: positive is nearer
+  // `other`
+  const double dx = other.x - site.x;
+  const double dy = other.y - site.y;
+  const double half = 0.5 * (dx*dx + dy*dy);
+  auto side = [&](const Point& v) { return (v.x - site.x) * dx + (v.y - site.y) * dy - half; };
+
+  const size_t n = polygon.vertices.size();
+  bool any_out = false;
+  for (size_t k = 0; k < n && !any_out; k++)
+  {
+    any_out = side(polygon.vertices[k]) > 0;
+  }
+  if (!any_out)
+    return false;
+
+  // Sutherland-Hodgman against one half-plane; the edge that leaves the
+  // kept side and the one that re-enters are joined along the bisector
+  scratch.vertices.clear();
+  scratch.edge_site.clear();
+  for (size_t k = 0; k < n; k++)
+  {
+    const Point& a = polygon.vertices[k];
+    const Point& b = polygon.vertices[(k + 1) % n];
+    double sa = side(a);
+    double sb = side(b);
+    if (sa <= 0)
+    {
+      bool leaving = sb > 0;
+      scratch.vertices.push_back(a);
+      scratch.edge_site.push_back((leaving && sa == 0) ? other_index : polygon.edge_site[k]);
+      if (leaving && sa < 0)
+      {
+        double t = sa / (sa - sb);
+        scratch.vertices.push_back(Point{a.x + t * (b.x - a.x), a.y + t * (b.y - a.y)});
+        scratch.edge_site.push_back(other_index);
+      }
+    }
+    else if (sb < 0)
+    {
+      double t = sa / (sa - sb);
+      scratch.vertices.push_back(Point{a.x + t * (b.x - a.x), a.y + t * (b.y - a.y)});
+      scratch.edge_site.push_back(polygon.edge_site[k]);
+    }
+  }
+
+  polygon.vertices.swap(scratch.vertices);
+  polygon.edge_site.swap(scratch.edge_site);
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////
@@ -0,0 +1,156 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef CLIPPING_VORONOI_BACKEND_H
+#define CLIPPING_VORONOI_BACKEND_H
+
+// Standard libs
+#include <cstdint>
+#include <vector>
+
+// Application files
+#include <geo_models/voronoi/voronoi_backend.h>
+
+namespace world_builder
+{
+
+/**
+ * @brief Voronoi backend that builds each cell on its own by clipping with
+ * the bisectors of nearby sites, for evenly spaced input like Poisson disc
+ * points
+ * @details Sites are bucketed into a uniform grid about one site spacing on
+ * a side. A cell starts as a box around all the sites and is cut by the
+ * bisector with every site in rings of grid cells around its own, nearest
+ * ring first. Once the ring reaches twice the distance from the site to its
+ * farthest vertex, no site further out can cut the cell and it is final. With
+ * blue-noise input that is two or three rings, so a cell costs a few dozen
+ * half-plane cuts regardless of the map size, and cells are independent, so
+ * they are built in parallel.
+ *
+ * Coordinates stay in doubles, so there is no integer conversion and no site
+ * is lost to rounding; exactly coincident sites keep the first. The search
+ * is capped at a fixed number of rings, which only cells on or next to the
+ * hull reach: their far vertices, where bisectors of near-collinear sites
+ * meet, may be off or missing, as may the hull cells' unbounded edges.
+ */
+class Clipping_voronoi_backend : public Voronoi_backend
+{
+public:
+  // Implementation
+  /**
+   * @brief Constructor
+   */
+  Clipping_voronoi_backend();
+
+  /**
+   * @brief Nothing is fixed per map
+   */
+  void Prepare(double width, double height, size_t site_count) override;
+
+  /**
+   * @brief Build the cells of the wanted sites
+   */
+  void Build(const std::vector<Point>& sites,
+             const std::vector<unsigned char>& wanted,
+             Flat_diagram& out) override;
+
+private:
+  // Attributes
+  /**
+   * @brief Sites per cell block; blocks are built in parallel and their
+   * vertices joined in block order, so the output never depends on the
+   * thread count
+   */
+  static constexpr size_t BLOCK_SITES = 1024;
+
+  /**
+   * @brief Rings searched around a cell that still touches the box before
+   * calling it unbounded, once its bisector vertices are settled
+   */
+  static constexpr int HULL_RINGS = 4;
+
+  /**
+   * @brief Rings searched around any cell at most. Only cells along the
+   * top and bottom of the map get this far, chasing vertices where
+   * near-collinear edge sites meet far off the map.
+   */
+  static constexpr int MAX_RINGS = 16;
+
+  /**
+   * @brief Label of a polygon edge on the starting box rather than a bisector
+   */
+  static constexpr int BOX_EDGE = -1;
+
+  /**
+   * @brief A cell under construction: vertex k starts the edge to vertex
+   * k + 1, which lies on the bisector with site `edge_site[k]`
+   */
+  struct Polygon
+  {
+    std::vector<Point> vertices;
+    std::vector<int> edge_site;
+  };
+
+  /**
+   * @brief Vertices and the cells they make for one block of sites
+   */
+  struct Block
+  {
+    std::vector<uint32_t> counts;
+    std::vector<Point> vertices;
+  };
+
+  /**
+   * @brief Bounds of the sites
+   */
+  double m_min_x;
+  double m_min_y;
+  double m_max_x;
+  double m_max_y;
+
+  /**
+   * @brief Side of a grid cell, and the grid size
+   */
+  double m_cell_size;
+  int m_grid_width;
+  int m_grid_height;
+
+  /**
+   * @brief Sites of grid cell g are m_grid_sites[m_grid_start[g] ..
+   * m_grid_start[g + 1])
+   */
+  std::vector<uint32_t> m_grid_start;
+  std::vector<int> m_grid_sites;
+
+  /**
+   * @brief Per block output, kept between builds
+   */
+  std::vector<Block> m_blocks;
+
+  // Implementation
+  /**
+   * @brief Bucket the sites into the grid
+   */
+  void bucket_sites(const std::vector<Point>& sites);
+
+  /**
+   * @brief Build one site's cell
+   * @param sites All sites
+   * @param site The site
+   * @param polygon Scratch polygon, left holding the cell
+   * @param scratch Second scratch polygon
+   * @return False if an earlier site sits exactly on this one, so it has no
+   * cell
+   */
+  bool build_cell(const std::vector<Point>& sites, int site, Polygon& polygon, Polygon& scratch) const;
+
+  /**
+   * @brief Cut away the part of `polygon` closer to `other` than to `site`
+   * @return Whether anything was cut
+   */
+  static bool clip(const Point& site, const Point& other, int other_index, Polygon& polygon, Polygon& scratch);
+};
+}
+
+#endif
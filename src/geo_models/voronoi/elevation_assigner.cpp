@@ -0,0 +1,169 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+#include <algorithm>
+#include <cmath>
+
+// Application files
+#include <defs/batch_rng.h>
+#include <geo_models/voronoi/elevation_assigner.h>
+#include <utils/task_scheduler.h>
+
+///////////////////////////////////////////////////////////////////////
+
+using ea = world_builder::Elevation_assigner;
+
+///////////////////////////////////////////////////////////////////////
+
+ea::Elevation_assigner(double island_radius, int mountain_seeds, int mountain_radius)
+  :
+  m_island_radius(island_radius),
+  m_mountain_seeds(mountain_seeds),
+  m_mountain_radius(std::max(1, mountain_radius)),
+  m_bfs(),
+  m_coast(),
+  m_sources(),
+  m_land(),
+  m_coast_distance(),
+  m_mountain_distance(),
+  m_elevation()
+{ }
+
+///////////////////////////////////////////////////////////////////////
+
+const std::vector<double>& ea::Assign(const std::vector<Cell>& cells,
+                                      const Cell_graph& graph,
+                                      double width,
+                                      double height)
+{
+  const size_t N = cells.size();
+  Task_scheduler& scheduler = Task_scheduler::Instance();
+  dice::Batch_rng rng(dice::ERng_stream::ERNG_STREAM_Elevation, 0);
+
+  // Island edge: radius times 1 + sum of a_k sin(k theta + phi_k)
+  double amplitude[COAST_HARMONICS];
+  double phase[COAST_HARMONICS];
+  for (int h = 0; h < COAST_HARMONICS; h++)
+  {
+    amplitude[h] = rng.Next_uniform(0.0, COAST_WOBBLE * 2.0 / (h + 2));
+    phase[h] = rng.Next_uniform(0.0, 2.0 * M_PI);
+  }
+
+  m_land.resize(N);
+  scheduler.Parallel_for(0, N, 1024, [&](size_t lo, size_t hi)
+  {
+    for (size_t i = lo; i < hi; i++)
+    {
+      const double nx = (cells[i].site.x - width * 0.5) / (width * 0.5);
+      const double ny = (cells[i].site.y - height * 0.5) / (height * 0.5);
+      const double theta = std::atan2(ny, nx);
+      double edge = 1.0;
+      for (int h = 0; h < COAST_HARMONICS; h++)
+      {
+        edge += amplitude[h] * std::sin((h + 2) * theta + phase[h]);
+      }
+      m_land[i] = (std::sqrt(nx*nx + ny*ny) < m_island_radius * edge);
+    }
+  });
+
+  // The coast is every cell with a neighbor across the shoreline
+  m_coast.resize(N);
+  scheduler.Parallel_for(0, N, 1024, [&](size_t lo, size_t hi)
+  {
+    for (size_t i = lo; i < hi; i++)
+    {
+      unsigned char coast = 0;
+      for (uint32_t k = graph.neighbor_start[i]; k < graph.neighbor_start[i + 1]; k++)
+      {
+        coast |= (m_land[graph.neighbors[k]] != m_land[i]);
+      }
+      m_coast[i] = coast;
+    }
+  });
+  m_sources.clear();
+  for (size_t i = 0; i < N; i++)
+  {
+    if (m_coast[i])
+      m_sources.push_back(static_cast<int>(i));
+  }
+  m_bfs.Run(graph, m_sources, m_coast_distance);
+
+  // Mountains rise around distinct random land cells
+  m_sources.clear();
+  for (size_t i = 0; i < N; i++)
+  {
+    if (m_land[i])
+      m_sources.push_back(static_cast<int>(i));
+  }
+  const size_t land_count = m_sources.size();
+  const size_t seed_count = std::min<size_t>(std::max(0, m_mountain_seeds), land_count);
+  for (size_t s = 0; s < seed_count; s++)
+  {
+    std::swap(m_sources[s], m_sources[s + rng.Next_below(land_count - s)]);
+  }
+  m_sources.resize(seed_count);
+  m_bfs.Run(graph, m_sources, m_mountain_distance);
+
+  // Normalize by the furthest cell from the coast on each side; a cell no
+  // coast reaches counts as furthest
+  int max_land = 0;
+  int max_ocean = 0;
+  for (size_t i = 0; i < N; i++)
+  {
+    int& furthest = m_land[i] ? max_land : max_ocean;
+    furthest = std::max(furthest, m_coast_distance[i]);
+  }
+
+  m_elevation.resize(N);
+  scheduler.Parallel_for(0, N, 1024, [&](size_t lo, size_t hi)
+  {
+    for (size_t i = lo; i < hi; i++)
+    {
+      const int coast = m_coast_distance[i];
+      if (!m_land[i])
+      {
+        const int depth = (coast == Cell_bfs::UNREACHED) ? max_ocean : coast;
+        m_elevation[i] = -(depth + 1.0) / (max_ocean + 1.0);
+        continue;
+      }
+
+      const int inland = (coast == Cell_bfs::UNREACHED) ? max_land : coast;
+      const double base = (inland + 1.0) / (max_land + 1.0);
+      const int to_mountain = m_mountain_distance[i];
+      const double mountain = (to_mountain == Cell_bfs::UNREACHED)
+                            ? 0.0
+                            : std::max(0.0, 1.0 - static_cast<double>(to_mountain) / m_mountain_radius);
+      m_elevation[i] = (1.0 - MOUNTAIN_WEIGHT) * base + MOUNTAIN_WEIGHT * mountain;
+    }
+  });
+  return m_elevation;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+std::array<unsigned char, 3> ea::Elevation_color(double elevation)
+{
+  // Colors at evenly spaced stops from the deepest ocean up to sea level,
+  // and from sea level up to the highest peaks
+  static constexpr int STOPS = 4;
+  static constexpr double OCEAN[STOPS][3] = {{10, 25, 80}, {25, 60, 140}, {50, 105, 185}, {90, 150, 210}};
+  static constexpr double LAND[STOPS][3] = {{70, 150, 60}, {150, 145, 80}, {125, 100, 75}, {245, 245, 245}};
+
+  const double (*ramp)[3] = (elevation < 0) ? OCEAN : LAND;
+  const double t = (elevation < 0) ? std::clamp(elevation + 1.0, 0.0, 1.0)
+                                   : std::clamp(elevation, 0.0, 1.0);
+  const double scaled = t * (STOPS - 1);
+  const int stop = std::min(static_cast<int>(scaled), STOPS - 2);
+  const double f = scaled - stop;
+
+  std::array<unsigned char, 3> color;
+  for (int c = 0; c < 3; c++)
+  {
+    color[c] = static_cast<unsigned char>(std::lround(ramp[stop][c] + f * (ramp[stop + 1][c] - ramp[stop][c])));
+  }
+  return color;
+}
+
+///////////////////////////////////////////////////////////////////////
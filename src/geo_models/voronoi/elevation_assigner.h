@@ -0,0 +1,124 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef ELEVATION_ASSIGNER_H
+#define ELEVATION_ASSIGNER_H
+
+// Standard libs
+#include <array>
+#include <vector>
+
+// Application files
+#include <geo_models/voronoi/cell_bfs.h>
+#include <geo_models/voronoi/cell_graph.h>
+#include <geo_models/voronoi/voronoi_builder.h>
+
+namespace world_builder
+{
+
+/**
+ * @brief Gives every Voronoi cell an elevation from its distance to the
+ * coast and to a few random mountain seeds
+ * @details An island mask, an ellipse filling the map whose edge is wobbled
+ * by a few random harmonics, decides land and ocean. One search outward from
+ * every coastal cell, on either side of the coast, gives land its height
+ * above the sea and ocean its depth, and a second one from the mountain
+ * seeds raises land near them. Both are breadth-first over the cell graph,
+ * so the stage is linear in the cells and the searches reuse their buffers
+ * from one call to the next.
+ */
+class Elevation_assigner
+{
+public:
+  // Attributes
+
+  // Implementation
+  /**
+   * @brief Constructor
+   * @param island_radius Island size as a fraction of the way from the map
+   * center to its edges
+   * @param mountain_seeds Number of land cells mountains rise around
+   * @param mountain_radius Cell hops over which a mountain falls away
+   */
+  Elevation_assigner(double island_radius, int mountain_seeds, int mountain_radius);
+
+  /**
+   * @brief Assign an elevation to every cell; the coast and the mountains
+   * depend only on the seed
+   * @param cells The cells
+   * @param graph Their adjacency
+   * @param width Map width
+   * @param height Map height
+   * @return Elevation of every cell, in (0, 1] on land and [-1, 0) in the
+   * ocean, valid until the next call
+   */
+  const std::vector<double>& Assign(const std::vector<Cell>& cells,
+                                    const Cell_graph& graph,
+                                    double width,
+                                    double height);
+
+  /**
+   * @brief Elevation of every cell from the last call
+   */
+  const std::vector<double>& Get_elevation() const { return m_elevation; }
+
+  /**
+   * @brief Whether every cell is land, from the last call
+   */
+  const std::vector<unsigned char>& Get_land() const { return m_land; }
+
+  /**
+   * @brief Hops from every cell to the coast from the last call, 0 for the
+   * cells either side of it
+   */
+  const std::vector<int>& Get_coast_distance() const { return m_coast_distance; }
+
+  /**
+   * @brief Map color for an elevation: blues deepening below sea level,
+   * green through brown to snow above it
+   * @param elevation Elevation in [-1, 1]
+   * @return The color
+   */
+  static std::array<unsigned char, 3> Elevation_color(double elevation);
+
+private:
+  // Attributes
+  /**
+   * @brief Harmonics wobbling the island edge, starting at 2 turns, and the
+   * largest amplitude of the first, falling off as 1 / k
+   */
+  static constexpr int COAST_HARMONICS = 5;
+  static constexpr double COAST_WOBBLE = 0.3;
+
+  /**
+   * @brief Share of land elevation taken from the mountains rather than the
+   * distance to the coast
+   */
+  static constexpr double MOUNTAIN_WEIGHT = 0.6;
+
+  /**
+   * @brief Island size, mountain count and mountain falloff
+   */
+  double m_island_radius;
+  int m_mountain_seeds;
+  int m_mountain_radius;
+
+  /**
+   * @brief Search buffers, kept between calls
+   */
+  Cell_bfs m_bfs;
+  std::vector<unsigned char> m_coast;
+  std::vector<int> m_sources;
+
+  /**
+   * @brief Per-cell results of the last call
+   */
+  std::vector<unsigned char> m_land;
+  std::vector<int> m_coast_distance;
+  std::vector<int> m_mountain_distance;
+  std::vector<double> m_elevation;
+};
+}
+
+#endif
@@ -3,6 +3,7 @@
  */
 
 // Standard libs
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 
@@ -11,6 +12,7 @@
 // Application files
 #include <geo_models/voronoi/poisson_disc.h>
 #include <defs/dice_rolls.h>
+#include <utils/task_scheduler.h>
 
 ///////////////////////////////////////////////////////////////////////
 
@@ -19,81 +21,142 @@ using pd = world_builder::Poisson_disc;
 ///////////////////////////////////////////////////////////////////////
 
 pd::Poisson_disc(double width, double height, double radius, int attempts)
+    :
+    Poisson_disc(width, height, radius, attempts, dice::Draw_seed())
+{ }
+
+///////////////////////////////////////////////////////////////////////
+
+pd::Poisson_disc(double width, double height, double radius, int attempts, uint64_t seed)
     :
     m_width(width),
     m_height(height),
     m_radius(radius),
+    m_wrap_x(false),
     m_k_attempts(attempts),
     m_cell_size(),
     m_grid_width(),
     m_grid_height(),
-    m_map_grid(),
+    m_grid_stride(),
+    m_grid_x(),
+    m_grid_y(),
     m_grid_points(),
-    m_active_points()
+    m_active_points(),
+    m_rng(seed),
+    m_candidate_x(attempts),
+    m_candidate_y(attempts),
+    m_candidate_distances(attempts),
+    m_candidate_ok(attempts)
 {
-  // Individual cell size
-  m_cell_size = m_radius / std::sqrt(2.0);
+  // Number of cells in the grid, as a function of height/width and the
+  // largest cell size that holds one point
+  m_grid_width = std::max(1, static_cast<int>(std::ceil(m_width / (m_radius / std::sqrt(2.0)))));
 
-  // Number of cells in the grid, as a function of height/width and cell size
-  m_grid_width = static_cast<int>(std::ceil(m_width / m_cell_size));
+  // Individual cell size, a whole number of cells across the map
+  m_cell_size = m_width / m_grid_width;
   m_grid_height = static_cast<int>(std::ceil(m_height / m_cell_size));
 
-  // Pre-size the vector with default, -1 values.
-  m_map_grid.assign(m_grid_width * m_grid_height, POINT_UNDEFINED);
+  // Pre-size the padded grid with empty cells
+  m_grid_stride = m_grid_width + 2 * GRID_PAD;
+  size_t cells = static_cast<size_t>(m_grid_stride) * (m_grid_height + 2 * GRID_PAD);
+  m_grid_x.assign(cells, EMPTY_CELL);
+  m_grid_y.assign(cells, EMPTY_CELL);
 }
 
 ///////////////////////////////////////////////////////////////////////
 
 std::vector<world_builder::Point> pd::Generate()
 {
-  // Pick first random point using dice
-  Point first{dice::Make_a_roll<double>(0, m_width),
-              dice::Make_a_roll<double>(0, m_height)};
+  return Generate({});
+}
 
-  // Add to the grid
-  m_grid_points.push_back(first);
+///////////////////////////////////////////////////////////////////////
 
-  // Add to 'active', meaning this point can have potential neighboring points
-  m_active_points.push_back(0);
+std::vector<world_builder::Point> pd::Generate(const std::vector<Point>& fixed_points)
+{
+  // Fixed points go first, active so growth continues from them, and are
+  // dropped from the result at the end
+  for (const auto& p : fixed_points)
+  {
+    m_grid_points.push_back(p);
+    m_active_points.push_back(static_cast<int>(m_grid_points.size()) - 1);
+    place_in_grid(p);
+  }
+  const size_t fixed_count = fixed_points.size();
 
-  // Place this point in the grid
-  place_in_grid(0, first);
+  // Pick first random point, which must clear any fixed points
+  for (int i = 0; i < m_k_attempts; i++)
+  {
+    Point first{m_rng.Next_uniform(0, m_width),
+                m_rng.Next_uniform(0, m_height)};
+    if (!no_neighbors(first.x, first.y))
+    {
+      continue;
+    }
+
+    // Add to the grid
+    m_grid_points.push_back(first);
+
+    // Add to 'active', meaning this point can have potential neighboring points
+    m_active_points.push_back(static_cast<int>(m_grid_points.size()) - 1);
+
+    // Place this point in the grid
+    place_in_grid(first);
+    break;
+  }
+
+  // Points accepted from the current batch of candidates
+  std::vector<Point> accepted;
+  accepted.reserve(m_k_attempts);
 
   // Process active list. New points will be added to this vector, and the
   // loop will continue until no new points can be added
   while (!m_active_points.empty())
   {
     // Random index from active points
-    int index = dice::Make_a_roll<int>(0, static_cast<int>(m_active_points.size()) - 1);
+    int index = static_cast<int>(m_rng.Next_below(m_active_points.size()));
     // The specific index of a point (from m_grid_points) that was cached in m_active_points
     int point_index = m_active_points[index];
     // The actual point
     Point p = m_grid_points[point_index];
 
-    // A new point was found
-    bool found = false;
+    // Generate and test all k samples against the grid at once
+    generate_candidates(p);
 
-    // Try k random samples
+    // Accept survivors in order. A survivor only has to be re-checked against
+    // points accepted earlier in this batch, since the grid test already
+    // covered everything placed before it.
+    accepted.clear();
     for (int i = 0; i < m_k_attempts; i++)
     {
-      // Create a new point
-      Point new_point = random_around(p);
+      if (!m_candidate_ok[i])
+      {
+        continue;
+      }
 
-      // In bounds and not too far
-      if (in_bounds(new_point) && no_neighbors(new_point))
+      double x = m_candidate_x[i];
+      double y = m_candidate_y[i];
+      bool clear = true;
+      for (const auto& other : accepted)
       {
-        // Add the point
-        m_grid_points.push_back(new_point);
-        // Cache the new point's index
-        m_active_points.push_back(static_cast<int>(m_grid_points.size()) - 1);
-        // Put it in the grid
-        place_in_grid(static_cast<int>(m_grid_points.size()) - 1, new_point);
-        // Flag
-        found = true;
+        clear &= (distance_sq(other.x, other.y, x, y) >= m_radius * m_radius);
+      }
+      if (!clear)
+      {
+        continue;
       }
+
+      Point new_point{x, y};
+      accepted.push_back(new_point);
+      // Add the point
+      m_grid_points.push_back(new_point);
+      // Cache the new point's index
+      m_active_points.push_back(static_cast<int>(m_grid_points.size()) - 1);
+      // Put it in the grid
+      place_in_grid(new_point);
     }
 
-    if (!found)
+    if (accepted.empty())
     {
       // Point not valid, remove the source point from the active points
       // Copy the last element over the element we want to remove
@@ -103,39 +166,68 @@ std::vector<world_builder::Point> pd::Generate()
     }
   }
 
+  m_grid_points.erase(m_grid_points.begin(), m_grid_points.begin() + fixed_count);
   return m_grid_points;
 }
 
 ///////////////////////////////////////////////////////////////////////
 
+void pd::Set_wrap_x(bool wrap_x)
+{
+  m_wrap_x = wrap_x;
+}
+
+///////////////////////////////////////////////////////////////////////
+
 void pd::Save_points_as_ppm(const std::string& filename)
+{
+  world_builder::Save_points_as_ppm(m_grid_points, m_width, m_height, filename);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void world_builder::Save_points_as_ppm(const std::vector<Point>& points,
+                                       double width,
+                                       double height,
+                                       const std::string& filename)
 {
   std::ofstream ofs(filename);
-  ofs << "P3\n" << m_width << " " << m_height << "\n255\n";
+  ofs << "P3\n" << width << " " << height << "\n255\n";
 
   // Create a blank white canvas
-  std::vector<std::vector<int>> canvas(m_height,
-                                       std::vector<int>(m_width, 255));
+  std::vector<std::vector<int>> canvas(height,
+                                       std::vector<int>(width, 255));
 
   // Draw black dots for each point
-  for (const auto& p : m_grid_points)
+  for (const auto& p : points)
   {
     int ix = static_cast<int>(p.x);
     int iy = static_cast<int>(p.y);
-    if (ix >= 0 && ix < m_width && iy >= 0 && iy < m_height)
+    if (ix >= 0 && ix < width && iy >= 0 && iy < height)
     {
       // black dot
       canvas[iy][ix] = 0;
     }
   }
 
-  // Write out RGB values
-  for (int y = 0; y < m_height; ++y)
+  // Write out RGB values, formatting rows in parallel and writing them in order
+  std::vector<std::string> rows(canvas.size());
+  world_builder::Task_scheduler::Instance().Parallel_for(0, rows.size(), 1,
+                                                         [&](size_t row_lo, size_t row_hi)
   {
-    for (int x = 0; x < m_width; ++x)
+    for (size_t y = row_lo; y < row_hi; ++y)
     {
-      ofs << canvas[y][x] << " " << canvas[y][x] << " " << canvas[y][x] << "\n";
+      for (int value : canvas[y])
+      {
+        std::string v = std::to_string(value);
+        rows[y] += v + " " + v + " " + v + "\n";
+      }
     }
+  });
+
+  for (const auto& row : rows)
+  {
+    ofs << row;
   }
 }
 
@@ -148,86 +240,129 @@ bool pd::in_bounds(const world_builder::Point& p)
 
 ///////////////////////////////////////////////////////////////////////
 
-void pd::place_in_grid(int index, const Point& point)
+world_builder::Point pd::wrap_around(const Point& p) const
 {
-  // Convert the continuous x, y position of the point into grid cell coordinates.
-  int grid_x = int(point.x / m_cell_size);
-  int grid_y = int(point.y / m_cell_size);
+  return Point{p.x - m_width * std::floor(p.x / m_width), p.y};
+}
 
-  // Guard against out-of-range indices
-  if (grid_x < 0 || grid_x >= m_grid_width)
+///////////////////////////////////////////////////////////////////////
+
+double pd::distance_sq(double ax, double ay, double bx, double by) const
+{
+  double dx = ax - bx;
+  double dy = ay - by;
+  if (m_wrap_x)
   {
-    return;
+    dx -= m_width * std::round(dx / m_width);
   }
-  if (grid_y < 0 || grid_y >= m_grid_height)
+  return dx*dx + dy*dy;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+size_t pd::grid_index(double x, double y) const
+{
+  // Convert the continuous x, y position of the point into grid cell
+  // coordinates, then offset into the padded grid
+  int grid_x = std::min(int(x / m_cell_size), m_grid_width - 1);
+  int grid_y = std::min(int(y / m_cell_size), m_grid_height - 1);
+  return static_cast<size_t>(grid_y + GRID_PAD) * m_grid_stride + (grid_x + GRID_PAD);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void pd::place_in_grid(const Point& point)
+{
+  // The seam copies land exactly GRID_PAD or fewer columns beyond the other
+  // side, since the cells tile the width exactly
+  if (m_wrap_x)
   {
-    return;
+    int column = static_cast<int>(std::floor(point.x / m_cell_size));
+    if (column < GRID_PAD)
+    {
+      store_in_grid(Point{point.x + m_width, point.y});
+    }
+    if (column >= m_grid_width - GRID_PAD)
+    {
+      store_in_grid(Point{point.x - m_width, point.y});
+    }
   }
-
-  // Convert the 2D coordinates into a 1D index for the flat vector m_map_grid
-  m_map_grid[grid_y * m_grid_width + grid_x] = index;
+  store_in_grid(point);
 }
 
 ///////////////////////////////////////////////////////////////////////
 
-bool pd::no_neighbors(const Point& point)
+void pd::store_in_grid(const Point& point)
 {
-  // Convert the continuous (x, y) coordinates of the point into discrete grid cell coordinates
-  // Each grid cell has side length m_cell_size, computed as radius / sqrt(2)
-  int grid_x = int(point.x / m_cell_size);
-  int grid_y = int(point.y / m_cell_size);
+  // Points outside the map may still sit in the padding
+  int grid_x = static_cast<int>(std::floor(point.x / m_cell_size));
+  int grid_y = static_cast<int>(std::floor(point.y / m_cell_size));
+  if (grid_x < -GRID_PAD || grid_x >= m_grid_width + GRID_PAD ||
+      grid_y < -GRID_PAD || grid_y >= m_grid_height + GRID_PAD)
+  {
+    return;
+  }
+  size_t cell = static_cast<size_t>(grid_y + GRID_PAD) * m_grid_stride + (grid_x + GRID_PAD);
+  m_grid_x[cell] = point.x;
+  m_grid_y[cell] = point.y;
+}
+
+///////////////////////////////////////////////////////////////////////
 
+bool pd::no_neighbors(double x, double y) const
+{
   // Loop over the 5x5 neighborhood of cells centered on the candidate cell
   // -2..2 is used because points can affect neighbors up to 2 cells away due to the cell size
-  // This ensures we check all possible points that could violate the minimum distance
-  for (int y = -2; y <= 2; y++)
+  // The padding means every one of the 25 cells exists, and empty cells are
+  // so far away they never fail the test
+  const double radius_sq = m_radius * m_radius;
+  const size_t center = grid_index(x, y);
+  bool too_close = false;
+  for (int row = -2; row <= 2; row++)
   {
-    for (int x = -2; x <= 2; x++)
+    const size_t first = center + row * m_grid_stride - 2;
+    const double* gx = m_grid_x.data() + first;
+    const double* gy = m_grid_y.data() + first;
+    for (int col = 0; col < 5; col++)
     {
-      int nx = grid_x + x;
-      int ny = grid_y + y;
-
-      // Skip cells that are outside the bounds
-      if (nx < 0 || nx >= m_grid_width)
-      {
-        continue;
-      }
-      if (ny < 0 || ny >= m_grid_height)
-      {
-        continue;
-      }
-
-      // Get the index of any existing point in this grid cell
-      int idx = m_map_grid[ny * m_grid_width + nx];
-
-      // If the cell contains a point
-      if (idx != POINT_UNDEFINED)
-      {
-        double dx = m_grid_points[idx].x - point.x;
-        double dy = m_grid_points[idx].y - point.y;
-
-        // Check if distance is less than minimum allowed (radius)
-        // Using squared distance avoids a square root for efficiency
-        if (dx*dx + dy*dy < m_radius * m_radius)
-        {
-          // Candidate point is too close to an existing point
-          return false;
-        }
-      }
+      double dx = gx[col] - x;
+      double dy = gy[col] - y;
+      // Using squared distance avoids a square root for efficiency
+      too_close |= (dx*dx + dy*dy < radius_sq);
     }
   }
-  // No neighboring points were too close; candidate is valid
-  return true;
+  return !too_close;
 }
 
 ///////////////////////////////////////////////////////////////////////
 
-world_builder::Point pd::random_around(const Point& point)
+void pd::generate_candidates(const Point& point)
 {
-  double a = dice::Make_a_roll<double>(0, 2*M_PI);
-  double r = dice::Make_a_roll<double>(m_radius, 2*m_radius);
-  Point new_point{point.x + r * std::cos(a), point.y + r * std::sin(a)};
-  return new_point;
+  // Random directions and distances for every candidate in one go
+  m_rng.Fill_directions(m_candidate_x.data(), m_candidate_y.data(), m_k_attempts);
+  m_rng.Fill_uniform(m_candidate_distances.data(), m_k_attempts, m_radius, 2*m_radius);
+
+  for (int i = 0; i < m_k_attempts; i++)
+  {
+    m_candidate_x[i] = point.x + m_candidate_distances[i] * m_candidate_x[i];
+    m_candidate_y[i] = point.y + m_candidate_distances[i] * m_candidate_y[i];
+  }
+
+  // When wrapping, candidates that leave one side re-enter on the other
+  if (m_wrap_x)
+  {
+    for (int i = 0; i < m_k_attempts; i++)
+    {
+      m_candidate_x[i] = wrap_around(Point{m_candidate_x[i], 0}).x;
+    }
+  }
+
+  // In bounds and not too close to anything already in the grid
+  for (int i = 0; i < m_k_attempts; i++)
+  {
+    Point candidate{m_candidate_x[i], m_candidate_y[i]};
+    m_candidate_ok[i] = in_bounds(candidate) && no_neighbors(candidate.x, candidate.y);
+  }
 }
 
 ///////////////////////////////////////////////////////////////////////
@@ -6,10 +6,12 @@
 #define POISSON_DISC_H
 
 // Standard libs
+#include <cstdint>
 #include <vector>
 #include <string>
 
 // Application files
+#include <defs/batch_rng.h>
 
 namespace world_builder
 {
@@ -30,6 +32,18 @@ struct Point
   double y;
 };
 
+/**
+ * @brief Save points as a simple image, a black pixel per point on white
+ * @param points The points
+ * @param width Image width
+ * @param height Image height
+ * @param filename Output filename
+ */
+void Save_points_as_ppm(const std::vector<Point>& points,
+                        double width,
+                        double height,
+                        const std::string& filename);
+
 /**
  * @brief Implementation of the Poisson disc sampling algorithm for generating
  * the underlying points to be used in the generated map.
@@ -50,6 +64,17 @@ public:
    */
   Poisson_disc(double width, double height, double radius, int attempts = 30);
 
+  /**
+   * @brief Constructor with its own seed, independent of the shared dice, so
+   * samplers can run concurrently and reproducibly
+   * @param width
+   * @param height
+   * @param radius
+   * @param attempts
+   * @param seed Seed for this sampler's generator
+   */
+  Poisson_disc(double width, double height, double radius, int attempts, uint64_t seed);
+
   /**
    * @brief Generate all points using Poisson disc sampling
    * @return Vector of points generated
@@ -57,10 +82,25 @@ public:
   std::vector<Point> Generate();
 
   /**
-   * @brief Save a Poisson_disc points vector as a simple image
-   * @param points
-   * @param width
-   * @param height
+   * @brief Generate points around existing ones
+   * @details `fixed_points` keep new points at least `m_radius` away and seed
+   * growth, so the result continues them seamlessly. They may lie outside the
+   * map (e.g. points of a neighboring region) and are not returned.
+   * @param fixed_points Points already placed, in this sampler's coordinates
+   * @return Vector of new points generated, all inside the map
+   */
+  std::vector<Point> Generate(const std::vector<Point>& fixed_points);
+
+  /**
+   * @brief Make the map periodic in x, matching the horizontal wrap of
+   * Voronoi_builder: candidates leaving one side re-enter on the other, and
+   * neighbor tests see across the seam. Call before Generate.
+   * @param wrap_x
+   */
+  void Set_wrap_x(bool wrap_x);
+
+  /**
+   * @brief Save the generated points as a simple image
    * @param filename
    */
   void Save_points_as_ppm(const std::string& filename);
@@ -68,9 +108,16 @@ public:
 private:
   // Attributes
   /**
-   * @brief Default value for points, to facilitate checks on undefined points
+   * @brief Empty grid cells hold this coordinate, far enough from the map
+   * that the distance test always passes without a branch
+   */
+  static constexpr double EMPTY_CELL = 1e30;
+
+  /**
+   * @brief Cells of padding on every side of the grid, so the 5x5
+   * neighborhood scan never needs bounds checks
    */
-  const int POINT_UNDEFINED = -1;
+  static constexpr int GRID_PAD = 2;
 
   /**
    * @brief Map width
@@ -87,6 +134,11 @@ private:
    */
   double m_radius;
 
+  /**
+   * @brief Whether the map is periodic in x
+   */
+  bool m_wrap_x;
+
   /**
    * @brief Attempts to find a new neighboring point. Higher values will create
    * more points
@@ -99,8 +151,9 @@ private:
    * the radius is the minimum distance. The idea is that if two points are
    * closer than r, they must lie in the same cell or a neighboring cell.
    * Using `m_radius / std::sqrt(2.0)` ensures at most one point per cell, so
-   * we never need to scan the entire list of points — just the 3×3 neighborhood
-   * of cells.
+   * we never need to scan the entire list of points — just the 5×5
+   * neighborhood of cells. The size is rounded down so a whole number of
+   * cells spans the width, which lets the grid wrap in x.
    */
   double m_cell_size;
 
@@ -117,9 +170,18 @@ private:
   int m_grid_height;
 
   /**
-   * @brief The m_map_grid, a conceptual layer that will help create points
+   * @brief Row length of the padded grid, m_grid_width + 2 * GRID_PAD
+   */
+  int m_grid_stride;
+
+  /**
+   * @brief The background grid, padded by GRID_PAD on every side. Each cell
+   * stores the coordinates of its point (or EMPTY_CELL) rather than an index,
+   * so a neighborhood test reads five contiguous runs of five cells and never
+   * chases into m_grid_points.
    */
-  std::vector<int> m_map_grid;
+  std::vector<double> m_grid_x;
+  std::vector<double> m_grid_y;
 
   /**
    * @brief The m_grid_points produced on this grid
@@ -131,6 +193,20 @@ private:
    */
   std::vector<int> m_active_points;
 
+  /**
+   * @brief Randomness for the sampler, drawn a block at a time
+   */
+  dice::Batch_rng m_rng;
+
+  /**
+   * @brief The k candidates around the current active point, generated
+   * together, and whether each passed the grid test
+   */
+  std::vector<double> m_candidate_x;
+  std::vector<double> m_candidate_y;
+  std::vector<double> m_candidate_distances;
+  std::vector<unsigned char> m_candidate_ok;
+
   // Implementation
   /**
    * @brief Whether a point is within the valid bounds of the map (vertical only)
@@ -140,34 +216,57 @@ private:
   bool in_bounds(const Point& p);
 
   /**
-   * @brief Wrap x-coordinate around horizontally
+   * @brief Wrap x-coordinate around horizontally, into [0, m_width)
    */
   Point wrap_around(const Point& p) const;
 
   /**
-   * @brief Maps a point’s real coordinates to a cell in the overlay grid,
-   * wrapping horizontally, and stores its index so neighbor checks are fast.
-   * @param index The index of the stored point
+   * @brief Squared distance between two points, the short way around the
+   * seam when wrapping
+   */
+  double distance_sq(double ax, double ay, double bx, double by) const;
+
+  /**
+   * @brief Padded grid index of the cell containing an in-bounds point
+   */
+  size_t grid_index(double x, double y) const;
+
+  /**
+   * @brief Maps a point’s real coordinates to a cell in the overlay grid and
+   * stores its coordinates there, so neighbor checks are fast. Points beyond
+   * the padding are too far away to matter and are skipped. When wrapping,
+   * points near either side are also copied, shifted by the map width, into
+   * the padding beyond the other side.
    * @param point The point to place in the grid
    */
-  void place_in_grid(int index, const Point& point);
+  void place_in_grid(const Point& point);
+
+  /**
+   * @brief Store one copy of a point in the cell its coordinates fall in, if
+   * that cell exists
+   * @param point The point to store
+   */
+  void store_in_grid(const Point& point);
 
   /**
    * @brief Whether this point has neighbors. New points are not valid if they
    * are with m_radius of another point.
-   * @param point The point to check
-   * @return True if no neighboring points were too close to `point`; candidate is valid.
+   * @details Tests all 25 cells of the neighborhood without early exit, so
+   * the distance checks vectorize.
+   * @param x Candidate x, must be in bounds
+   * @param y Candidate y, must be in bounds
+   * @return True if no neighboring points were too close; candidate is valid.
    * Otherwise false.
    */
-  bool no_neighbors(const Point& point);
+  bool no_neighbors(double x, double y) const;
 
   /**
-   * @brief Picks a random spot somewhere in the ring around `point`, that ring
-   * having an inner radius m_radius and outer radius 2*m_radius.
+   * @brief Generate all k candidates in the ring around `point`, that ring
+   * having an inner radius m_radius and outer radius 2*m_radius, and test
+   * each against the grid as it stands.
    * @param point
-   * @return The new point, wrapped horizontally
    */
-  Point random_around(const Point& point);
+  void generate_candidates(const Point& point);
 
 };
 }
@@ -0,0 +1,353 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+// Application files
+#include <geo_models/voronoi/river_network.h>
+#include <utils/task_scheduler.h>
+
+///////////////////////////////////////////////////////////////////////
+
+using rn = world_builder::River_network;
+
+///////////////////////////////////////////////////////////////////////
+
+rn::River_network()
+  :
+  m_receivers(),
+  m_donor_start(1, 0),
+  m_donors(),
+  m_order(),
+  m_flow(),
+  m_lake_count(0),
+  m_land(),
+  m_flat_seen(),
+  m_flat_queue(),
+  m_is_river(),
+  m_traced(),
+  m_river_start(1, 0),
+  m_river_points(),
+  m_river_cells(),
+  m_river_discharge(),
+  m_min_flow(0)
+{ }
+
+///////////////////////////////////////////////////////////////////////
+
+void rn::Route(const Cell_graph& graph,
+               const std::vector<double>& elevation,
+               const std::vector<double>* rainfall)
+{
+  const size_t N = graph.Size();
+  if (elevation.size() != N)
+    throw std::invalid_argument("River routing needs one elevation per cell");
+  if (rainfall && rainfall->size() != N)
+    throw std::invalid_argument("River routing needs one rainfall value per cell");
+  Task_scheduler& scheduler = Task_scheduler::Instance();
+
+  // Steepest descent: the lowest neighbor, the lowest index among equals
+  m_land.resize(N);
+  m_receivers.resize(N);
+  scheduler.Parallel_for(0, N, 1024, [&](size_t lo, size_t hi)
+  {
+    for (size_t i = lo; i < hi; i++)
+    {
+      m_land[i] = (elevation[i] > 0);
+      int receiver = NO_RECEIVER;
+      if (m_land[i])
+      {
+        double lowest = elevation[i];
+        for (uint32_t k = graph.neighbor_start[i]; k < graph.neighbor_start[i + 1]; k++)
+        {
+          const int j = graph.neighbors[k];
+          if (elevation[j] < lowest)
+          {
+            lowest = elevation[j];
+            receiver = j;
+          }
+        }
+      }
+      m_receivers[i] = receiver;
+    }
+  });
+
+  // Flat ground: a land cell with no lower neighbor but one of the same
+  // height drains across the flat, breadth first, toward the nearest of its
+  // cells that has a way down. A flat with no way down, a true depression,
+  // drains to its lowest index cell, its one lake.
+  m_flat_seen.assign(N, 0);
+  m_flat_queue.clear();
+  auto stuck = [&](int c)
+  {
+    return m_land[c] && m_receivers[c] == NO_RECEIVER && !m_flat_seen[c];
+  };
+  auto spread = [&](size_t head)
+  {
+    for (; head < m_flat_queue.size(); head++)
+    {
+      const int c = m_flat_queue[head];
+      for (uint32_t k = graph.neighbor_start[c]; k < graph.neighbor_start[c + 1]; k++)
+      {
+        const int j = graph.neighbors[k];
+        if (stuck(j) && elevation[j] == elevation[c])
+        {
+          m_receivers[j] = c;
+          m_flat_seen[j] = 1;
+          m_flat_queue.push_back(j);
+        }
+      }
+    }
+  };
+  for (size_t i = 0; i < N; i++)
+  {
+    if (!stuck(static_cast<int>(i)))
+      continue;
+    for (uint32_t k = graph.neighbor_start[i]; k < graph.neighbor_start[i + 1]; k++)
+    {
+      const int j = graph.neighbors[k];
+      if (m_receivers[j] != NO_RECEIVER && !m_flat_seen[j] && elevation[j] == elevation[i])
+      {
+        m_receivers[i] = j;
+        m_flat_seen[i] = 1;
+        m_flat_queue.push_back(static_cast<int>(i));
+        break;
+      }
+    }
+  }
+  spread(0);
+  for (size_t i = 0; i < N; i++)
+  {
+    if (!stuck(static_cast<int>(i)))
+      continue;
+    m_flat_seen[i] = 1;
+    m_flat_queue.push_back(static_cast<int>(i));
+    spread(m_flat_queue.size() - 1);
+  }
+
+  // Donors by counting sort on the receiver
+  m_donor_start.assign(N + 1, 0);
+  for (size_t i = 0; i < N; i++)
+  {
+    if (m_receivers[i] != NO_RECEIVER)
+      m_donor_start[m_receivers[i] + 1]++;
+  }
+  for (size_t i = 0; i < N; i++)
+  {
+    m_donor_start[i + 1] += m_donor_start[i];
+  }
+  m_donors.resize(m_donor_start[N]);
+  std::vector<uint32_t> next(m_donor_start.begin(), m_donor_start.end() - 1);
+  for (size_t i = 0; i < N; i++)
+  {
+    if (m_receivers[i] != NO_RECEIVER)
+      m_donors[next[m_receivers[i]]++] = static_cast<int>(i);
+  }
+
+  // Outlets first, then every cell's donors after it. Receivers are
+  // strictly lower, so there are no cycles and every cell is reached.
+  m_order.clear();
+  m_order.reserve(N);
+  m_lake_count = 0;
+  for (size_t i = 0; i < N; i++)
+  {
+    if (m_receivers[i] == NO_RECEIVER)
+    {
+      m_order.push_back(static_cast<int>(i));
+      m_lake_count += m_land[i];
+    }
+  }
+  for (size_t head = 0; head < m_order.size(); head++)
+  {
+    const int c = m_order[head];
+    m_order.insert(m_order.end(), m_donors.begin() + m_donor_start[c], m_donors.begin() + m_donor_start[c + 1]);
+  }
+
+  // Downstream in reverse, so all donors have added their flow to a cell
+  // before it passes it on
+  if (rainfall)
+    m_flow.assign(rainfall->begin(), rainfall->end());
+  else
+    m_flow.assign(N, 1.0);
+  for (size_t k = m_order.size(); k-- > 0;)
+  {
+    const int c = m_order[k];
+    if (m_receivers[c] != NO_RECEIVER)
+      m_flow[m_receivers[c]] += m_flow[c];
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void rn::Trace(const std::vector<Cell>& cells, double width, double min_flow)
+{
+  const size_t N = m_receivers.size();
+  m_min_flow = min_flow;
+  m_is_river.resize(N);
+  Task_scheduler& scheduler = Task_scheduler::Instance();
+  scheduler.Parallel_for(0, N, 4096, [&](size_t lo, size_t hi)
+  {
+    for (size_t i = lo; i < hi; i++)
+    {
+      m_is_river[i] = m_land[i] && m_flow[i] >= min_flow;
+    }
+  });
+
+  // Every river starts at a river cell no other river cell drains into,
+  // and runs down until it leaves the land or meets one traced before.
+  // After the source, each cell is listed where its water leaves it.
+  m_traced.assign(N, 0);
+  m_river_start.assign(1, 0);
+  m_river_cells.clear();
+  for (size_t source = 0; source < N; source++)
+  {
+    if (!m_is_river[source])
+      continue;
+    bool headwater = true;
+    for (uint32_t k = m_donor_start[source]; k < m_donor_start[source + 1] && headwater; k++)
+    {
+      headwater = !m_is_river[m_donors[k]];
+    }
+    if (!headwater)
+      continue;
+
+    int c = static_cast<int>(source);
+    m_river_cells.push_back(c);
+    while (m_land[c] && m_receivers[c] != NO_RECEIVER)
+    {
+      m_river_cells.push_back(c);
+      if (m_traced[c])
+        break;
+      m_traced[c] = 1;
+      c = m_receivers[c];
+    }
+
+    // A lone lake cell is no river
+    if (m_river_cells.size() - m_river_start.back() < 2)
+      m_river_cells.resize(m_river_start.back());
+    else
+      m_river_start.push_back(static_cast<uint32_t>(m_river_cells.size()));
+  }
+
+  // Points and discharges, river by river in parallel
+  m_river_points.resize(m_river_cells.size());
+  m_river_discharge.resize(m_river_cells.size());
+  scheduler.Parallel_for(0, Get_river_count(), 64, [&](size_t lo, size_t hi)
+  {
+    for (size_t r = lo; r < hi; r++)
+    {
+      for (uint32_t k = m_river_start[r]; k < m_river_start[r + 1]; k++)
+      {
+        const int c = m_river_cells[k];
+        m_river_points[k] = (k == m_river_start[r]) ? cells[c].site : crossing(cells[c], cells[m_receivers[c]], width);
+        m_river_discharge[k] = m_flow[c];
+      }
+    }
+  });
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void rn::Draw(int image_width,
+              int image_height,
+              std::vector<std::array<unsigned char, 3>>& image) const
+{
+  auto plot = [&](double x, double y, int radius)
+  {
+    const int cx = static_cast<int>(std::floor(x));
+    const int cy = static_cast<int>(std::floor(y));
+    for (int dy = -radius; dy <= radius; dy++)
+    {
+      for (int dx = -radius; dx <= radius; dx++)
+      {
+        if (dx*dx + dy*dy > radius*radius)
+          continue;
+        int px = (cx + dx) % image_width;
+        if (px < 0)
+          px += image_width;
+        const int py = cy + dy;
+        if (py >= 0 && py < image_height)
+          image[static_cast<size_t>(py) * image_width + px] = {RIVER_COLOR[0], RIVER_COLOR[1], RIVER_COLOR[2]};
+      }
+    }
+  };
+
+  for (size_t r = 0; r < Get_river_count(); r++)
+  {
+    for (uint32_t k = m_river_start[r]; k + 1 < m_river_start[r + 1]; k++)
+    {
+      const Point& a = m_river_points[k];
+      const Point& b = m_river_points[k + 1];
+      double dx = b.x - a.x;
+      if (dx >  image_width * 0.5) dx -= image_width;
+      if (dx < -image_width * 0.5) dx += image_width;
+      const double dy = b.y - a.y;
+
+      // Half-pixel steps along the segment, sized by the discharge of the
+      // cell it crosses
+      const int radius = (m_river_discharge[k + 1] >= WIDEN_FLOW * m_min_flow) ? 1 : 0;
+      const int steps = std::max(1, static_cast<int>(std::ceil(2.0 * std::sqrt(dx*dx + dy*dy))));
+      for (int s = 0; s <= steps; s++)
+      {
+        const double t = static_cast<double>(s) / steps;
+        plot(a.x + t * dx, a.y + t * dy, radius);
+      }
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+
+world_builder::Point rn::crossing(const Cell& from, const Cell& to, double width)
+{
+  // The neighbor's site relative to this one, unwrapped across the seam
+  double to_x = to.site.x - from.site.x;
+  if (to_x >  width * 0.5) to_x -= width;
+  if (to_x < -width * 0.5) to_x += width;
+  const double to_y = to.site.y - from.site.y;
+
+  // The shared edge is the one the site mirrors onto its neighbor across;
+  // without one, the midpoint of the sites
+  Point middle{0.5 * to_x, 0.5 * to_y};
+  double best = std::numeric_limits<double>::infinity();
+  const size_t count = from.vertices.size();
+  for (size_t k = 0; k < count; k++)
+  {
+    Point ends[2];
+    for (int e = 0; e < 2; e++)
+    {
+      const Point& v = from.vertices[(k + e) % count];
+      double dx = v.x - from.site.x;
+      if (dx >  width * 0.5) dx -= width;
+      if (dx < -width * 0.5) dx += width;
+      ends[e] = Point{dx, v.y - from.site.y};
+    }
+    const double ex = ends[1].x - ends[0].x;
+    const double ey = ends[1].y - ends[0].y;
+    const double length2 = ex*ex + ey*ey;
+    if (length2 <= 0)
+      continue;
+
+    const double t = -(ends[0].x * ex + ends[0].y * ey) / length2;
+    const double miss_x = 2.0 * (ends[0].x + t * ex) - to_x;
+    const double miss_y = 2.0 * (ends[0].y + t * ey) - to_y;
+    const double miss2 = miss_x*miss_x + miss_y*miss_y;
+    if (miss2 < best)
+    {
+      best = miss2;
+      middle = Point{0.5 * (ends[0].x + ends[1].x), 0.5 * (ends[0].y + ends[1].y)};
+    }
+  }
+
+  double x = std::fmod(from.site.x + middle.x, width);
+  if (x < 0)
+    x += width;
+  return Point{x, from.site.y + middle.y};
+}
+
+///////////////////////////////////////////////////////////////////////
@@ -0,0 +1,200 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef RIVER_NETWORK_H
+#define RIVER_NETWORK_H
+
+// Standard libs
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Application files
+#include <geo_models/voronoi/cell_graph.h>
+#include <geo_models/voronoi/voronoi_builder.h>
+
+namespace world_builder
+{
+
+/**
+ * @brief Routes rain downhill over the Voronoi cell graph and traces the
+ * rivers it gathers into
+ * @details Every land cell drains to its lowest neighbor if that is lower,
+ * its receiver; ocean cells and land pits, the lakes, drain nowhere. Cells
+ * on flat ground drain across it to the nearest cell of the flat with a way
+ * down, so only a flat with none is a lake, and then a single one. The
+ * receivers form a forest rooted at those outlets. Its donor lists are a
+ * counting sort of the cells by receiver, and a breadth-first walk down
+ * from the outlets lists every cell after its receiver, so one pass over
+ * that list backwards hands each cell's flow on after all of its donors
+ * have added theirs. Everything is linear in the cells and links.
+ *
+ * Rivers are kept as CSR polylines along the cell edges: river r runs
+ * through points Get_river_start()[r] .. Get_river_start()[r + 1] of
+ * Get_river_points(), Get_river_cells() and Get_river_discharge(). It
+ * starts at its source's site, and every later point is where the water of
+ * its cell leaves it for its receiver, the middle of the edge they share.
+ * So a river reaches the sea on the coast and a lake on its shore, and one
+ * that meets a river traced before takes one more point, where the joined
+ * cell drains on, which lies on the other river. The discharge at each
+ * point is the flow of its cell.
+ */
+class River_network
+{
+public:
+  // Attributes
+  /**
+   * @brief Receiver of a cell that drains nowhere
+   */
+  static constexpr int NO_RECEIVER = -1;
+
+  // Implementation
+  /**
+   * @brief Constructor, with no cells
+   */
+  River_network();
+
+  /**
+   * @brief Route the flow of every cell downhill
+   * @param graph The cell graph
+   * @param elevation Elevation of every cell, land above 0
+   * @param rainfall Water each cell adds to the flow; null adds 1 per cell,
+   * so flow counts the cells draining through
+   * @throws std::invalid_argument If elevation or rainfall does not have one
+   * value per cell
+   */
+  void Route(const Cell_graph& graph,
+             const std::vector<double>& elevation,
+             const std::vector<double>* rainfall = nullptr);
+
+  /**
+   * @brief Trace the rivers of the last route
+   * @param cells The cells routed over
+   * @param width Map width, which the cells wrap east to west across
+   * @param min_flow Flow a land cell needs to carry a river
+   */
+  void Trace(const std::vector<Cell>& cells, double width, double min_flow);
+
+  /**
+   * @brief Draw the rivers over an image of the map at one pixel per map
+   * unit, thicker where the discharge is larger, wrapping east to west
+   * @param image_width Image width, the map width
+   * @param image_height Image height
+   * @param image Pixels, row by row
+   */
+  void Draw(int image_width,
+            int image_height,
+            std::vector<std::array<unsigned char, 3>>& image) const;
+
+  /**
+   * @brief Downhill neighbor of every cell, NO_RECEIVER for an outlet
+   */
+  const std::vector<int>& Get_receivers() const { return m_receivers; }
+
+  /**
+   * @brief Flow through every cell, its own rain included
+   */
+  const std::vector<double>& Get_flow() const { return m_flow; }
+
+  /**
+   * @brief Cells in upstream order: every cell comes after its receiver
+   */
+  const std::vector<int>& Get_order() const { return m_order; }
+
+  /**
+   * @brief Land cells that drain nowhere
+   */
+  size_t Get_lake_count() const { return m_lake_count; }
+
+  /**
+   * @brief River polylines, see the class description
+   */
+  const std::vector<uint32_t>& Get_river_start() const { return m_river_start; }
+  const std::vector<Point>& Get_river_points() const { return m_river_points; }
+  const std::vector<int>& Get_river_cells() const { return m_river_cells; }
+  const std::vector<double>& Get_river_discharge() const { return m_river_discharge; }
+  size_t Get_river_count() const { return m_river_start.size() - 1; }
+
+private:
+  // Attributes
+  /**
+   * @brief River color and the discharge, in multiples of the minimum
+   * river flow, at which a river widens by a pixel
+   */
+  static constexpr unsigned char RIVER_COLOR[3] = {40, 90, 220};
+  static constexpr double WIDEN_FLOW = 8.0;
+
+  /**
+   * @brief Downhill neighbor of every cell
+   */
+  std::vector<int> m_receivers;
+
+  /**
+   * @brief Donors of every cell as CSR, grouped by receiver
+   */
+  std::vector<uint32_t> m_donor_start;
+  std::vector<int> m_donors;
+
+  /**
+   * @brief Cells in upstream order
+   */
+  std::vector<int> m_order;
+
+  /**
+   * @brief Flow through every cell
+   */
+  std::vector<double> m_flow;
+
+  /**
+   * @brief Land cells that drain nowhere
+   */
+  size_t m_lake_count;
+
+  /**
+   * @brief Whether every cell is land
+   */
+  std::vector<unsigned char> m_land;
+
+  /**
+   * @brief Flat cells already given a receiver or made a lake, and the
+   * breadth-first queue across the flats
+   */
+  std::vector<unsigned char> m_flat_seen;
+  std::vector<int> m_flat_queue;
+
+  /**
+   * @brief Whether every cell carries a river, and whether a traced river
+   * already passes through it
+   */
+  std::vector<unsigned char> m_is_river;
+  std::vector<unsigned char> m_traced;
+
+  /**
+   * @brief River polylines: the points, the cell whose water passes each,
+   * and its discharge
+   */
+  std::vector<uint32_t> m_river_start;
+  std::vector<Point> m_river_points;
+  std::vector<int> m_river_cells;
+  std::vector<double> m_river_discharge;
+
+  /**
+   * @brief Minimum river flow of the last trace
+   */
+  double m_min_flow;
+
+  // Implementation
+  /**
+   * @brief Middle of the edge two neighboring cells share, where water
+   * crosses from one to the other
+   * @param from The cell the water leaves
+   * @param to The cell it enters
+   * @param width Map width
+   * @return The point, with x wrapped into [0, width)
+   */
+  static Point crossing(const Cell& from, const Cell& to, double width);
+};
+}
+
+#endif
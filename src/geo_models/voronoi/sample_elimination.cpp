@@ -0,0 +1,287 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Application files
+#include <defs/batch_rng.h>
+#include <geo_models/voronoi/sample_elimination.h>
+#include <utils/task_scheduler.h>
+
+///////////////////////////////////////////////////////////////////////
+
+using se = world_builder::Sample_elimination;
+
+///////////////////////////////////////////////////////////////////////
+
+namespace
+{
+/**
+ * @brief Binary max-heap of candidate indices keyed by an external weight
+ * array, tracking each index's position so a weight can be lowered in place
+ */
+class Indexed_max_heap
+{
+public:
+  Indexed_max_heap(const std::vector<double>& weights)
+    :
+    m_weights(weights),
+    m_heap(weights.size()),
+    m_position(weights.size())
+  {
+    for(uint32_t i = 0; i < m_heap.size(); ++i)
+    {
+      m_heap[i] = i;
+      m_position[i] = i;
+    }
+    for(size_t i = m_heap.size() / 2; i-- > 0;)
+    {
+      sift_down(i);
+    }
+  }
+
+  size_t Size() const { return m_heap.size(); }
+
+  uint32_t Pop()
+  {
+    uint32_t top = m_heap.front();
+    move(m_heap.back(), 0);
+    m_heap.pop_back();
+    if(!m_heap.empty())
+    {
+      sift_down(0);
+    }
+    return top;
+  }
+
+  /**
+   * @brief Restore order after the weight of `index` decreased
+   */
+  void Decreased(uint32_t index)
+  {
+    sift_down(m_position[index]);
+  }
+
+private:
+  const std::vector<double>& m_weights;
+  std::vector<uint32_t> m_heap;
+  std::vector<uint32_t> m_position;
+
+  void move(uint32_t index, size_t slot)
+  {
+    m_heap[slot] = index;
+    m_position[index] = static_cast<uint32_t>(slot);
+  }
+
+  void sift_down(size_t slot)
+  {
+    uint32_t index = m_heap[slot];
+    double value = m_weights[index];
+    size_t count = m_heap.size();
+    while(true)
+    {
+      size_t child = 2 * slot + 1;
+      if(child >= count)
+      {
+        break;
+      }
+      if(child + 1 < count && m_weights[m_heap[child + 1]] > m_weights[m_heap[child]])
+      {
+        child++;
+      }
+      if(m_weights[m_heap[child]] <= value)
+      {
+        break;
+      }
+      move(m_heap[child], slot);
+      slot = child;
+    }
+    move(index, slot);
+  }
+};
+}
+
+///////////////////////////////////////////////////////////////////////
+
+se::Sample_elimination(double width,
+                       double height,
+                       size_t target_count,
+                       double candidate_ratio)
+  :
+  m_width(width),
+  m_height(height),
+  m_target_count(target_count),
+  m_candidate_ratio(std::max(1.0, candidate_ratio)),
+  m_r_max(),
+  m_r_min(),
+  m_candidates(),
+  m_grid_width(),
+  m_grid_height(),
+  m_grid_cell_size(),
+  m_cell_start(),
+  m_cell_items(),
+  m_weights()
+{
+  if(m_target_count == 0)
+  {
+    throw std::invalid_argument("Sample elimination needs a target count above zero");
+  }
+
+  // Spacing of the densest packing of N points on the map
+  m_r_max = std::sqrt(m_width * m_height / (2.0 * std::sqrt(3.0) * m_target_count));
+  m_r_min = m_r_max * (1.0 - std::pow(1.0 / m_candidate_ratio, WEIGHT_GAMMA)) * WEIGHT_BETA;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+std::vector<world_builder::Point> se::Generate()
+{
+  //------------------------------------------------------------------
+  // 1. Dense uniform candidates
+  //------------------------------------------------------------------
+  size_t candidate_count = static_cast<size_t>(std::ceil(m_target_count * m_candidate_ratio));
+  std::vector<double> xs(candidate_count);
+  std::vector<double> ys(candidate_count);
+  dice::Batch_rng rng;
+  rng.Fill_uniform(xs.data(), candidate_count, 0.0, m_width);
+  rng.Fill_uniform(ys.data(), candidate_count, 0.0, m_height);
+
+  m_candidates.resize(candidate_count);
+  for(size_t i = 0; i < candidate_count; ++i)
+  {
+    m_candidates[i] = Point{xs[i], ys[i]};
+  }
+
+  build_grid();
+
+  //------------------------------------------------------------------
+  // 2. Initial weights, independent per candidate
+  //------------------------------------------------------------------
+  m_weights.assign(candidate_count, 0.0);
+  world_builder::Task_scheduler::Instance().Parallel_for(0, candidate_count, 0, [&](size_t lo, size_t hi)
+  {
+    for(size_t i = lo; i < hi; ++i)
+    {
+      double total = 0.0;
+      for_each_neighbor(static_cast<uint32_t>(i), [&](uint32_t, double distance)
+      {
+        total += weight(distance);
+      });
+      m_weights[i] = total;
+    }
+  });
+
+  //------------------------------------------------------------------
+  // 3. Remove the most crowded candidate until N remain
+  //------------------------------------------------------------------
+  std::vector<unsigned char> alive(candidate_count, 1);
+  Indexed_max_heap heap(m_weights);
+  while(heap.Size() > m_target_count)
+  {
+    uint32_t removed = heap.Pop();
+    alive[removed] = 0;
+
+    // The removed candidate no longer crowds its neighbors
+    for_each_neighbor(removed, [&](uint32_t neighbor, double distance)
+    {
+      if(alive[neighbor])
+      {
+        m_weights[neighbor] -= weight(distance);
+        heap.Decreased(neighbor);
+      }
+    });
+  }
+
+  std::vector<Point> points;
+  points.reserve(m_target_count);
+  for(size_t i = 0; i < candidate_count; ++i)
+  {
+    if(alive[i])
+    {
+      points.push_back(m_candidates[i]);
+    }
+  }
+  return points;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void se::build_grid()
+{
+  m_grid_cell_size = 2.0 * m_r_max;
+  m_grid_width = std::max(1, static_cast<int>(std::ceil(m_width / m_grid_cell_size)));
+  m_grid_height = std::max(1, static_cast<int>(std::ceil(m_height / m_grid_cell_size)));
+  size_t cells = static_cast<size_t>(m_grid_width) * m_grid_height;
+
+  // Counting sort of candidates by cell
+  std::vector<uint32_t> cell_of(m_candidates.size());
+  m_cell_start.assign(cells + 1, 0);
+  for(size_t i = 0; i < m_candidates.size(); ++i)
+  {
+    int gx = std::min(static_cast<int>(m_candidates[i].x / m_grid_cell_size), m_grid_width - 1);
+    int gy = std::min(static_cast<int>(m_candidates[i].y / m_grid_cell_size), m_grid_height - 1);
+    cell_of[i] = static_cast<uint32_t>(gy * m_grid_width + gx);
+    m_cell_start[cell_of[i] + 1]++;
+  }
+  for(size_t c = 0; c < cells; ++c)
+  {
+    m_cell_start[c + 1] += m_cell_start[c];
+  }
+
+  m_cell_items.resize(m_candidates.size());
+  std::vector<uint32_t> fill(m_cell_start.begin(), m_cell_start.end() - 1);
+  for(size_t i = 0; i < m_candidates.size(); ++i)
+  {
+    m_cell_items[fill[cell_of[i]]++] = static_cast<uint32_t>(i);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+
+double se::weight(double distance) const
+{
+  double d = std::max(distance, m_r_min);
+  return std::pow(1.0 - d / (2.0 * m_r_max), WEIGHT_ALPHA);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+template<typename F>
+void se::for_each_neighbor(uint32_t index, F&& fn) const
+{
+  const Point& p = m_candidates[index];
+  const double reach = 2.0 * m_r_max;
+  const double reach_sq = reach * reach;
+  int gx = std::min(static_cast<int>(p.x / m_grid_cell_size), m_grid_width - 1);
+  int gy = std::min(static_cast<int>(p.y / m_grid_cell_size), m_grid_height - 1);
+
+  // Cells are as wide as the interaction radius, so the 3x3 block covers it
+  for(int y = std::max(0, gy - 1); y <= std::min(m_grid_height - 1, gy + 1); ++y)
+  {
+    for(int x = std::max(0, gx - 1); x <= std::min(m_grid_width - 1, gx + 1); ++x)
+    {
+      size_t cell = static_cast<size_t>(y) * m_grid_width + x;
+      for(uint32_t k = m_cell_start[cell]; k < m_cell_start[cell + 1]; ++k)
+      {
+        uint32_t other = m_cell_items[k];
+        if(other == index)
+        {
+          continue;
+        }
+        double dx = m_candidates[other].x - p.x;
+        double dy = m_candidates[other].y - p.y;
+        double d2 = dx*dx + dy*dy;
+        if(d2 < reach_sq)
+        {
+          fn(other, std::sqrt(d2));
+        }
+      }
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
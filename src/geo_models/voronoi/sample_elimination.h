@@ -0,0 +1,139 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef SAMPLE_ELIMINATION_H
+#define SAMPLE_ELIMINATION_H
+
+// Standard libs
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Application files
+#include <geo_models/voronoi/poisson_disc.h>
+
+namespace world_builder
+{
+
+/**
+ * @brief Blue-noise sampler that produces an exact number of points, by
+ * weighted sample elimination (Yuksel 2015)
+ * @details A dense uniform candidate set is generated, each candidate is
+ * weighted by how crowded its neighborhood is, and the most crowded candidate
+ * is removed (updating its neighbors' weights) until exactly the target count
+ * remains. Unlike Poisson_disc, the output size is fixed up front, so memory
+ * and runtime of every later stage can be budgeted.
+ */
+class Sample_elimination
+{
+public:
+  // Attributes
+
+  // Implementation
+  /**
+   * @brief Constructor
+   * @param width Map width
+   * @param height Map height
+   * @param target_count Number of points to produce
+   * @param candidate_ratio Candidates generated per output point; higher
+   * gives better blue noise at proportionally higher cost
+   */
+  Sample_elimination(double width,
+                     double height,
+                     size_t target_count,
+                     double candidate_ratio = 5.0);
+
+  /**
+   * @brief Generate exactly the target number of points
+   * @return The points, in candidate order
+   */
+  std::vector<Point> Generate();
+
+private:
+  // Attributes
+  /**
+   * @brief Exponent of the weight falloff; the paper's default
+   */
+  static constexpr double WEIGHT_ALPHA = 8.0;
+
+  /**
+   * @brief Weight limiting: distances below `r_min` count as `r_min`, with
+   * r_min = r_max * (1 - (N / M)^GAMMA) * BETA
+   */
+  static constexpr double WEIGHT_BETA = 0.65;
+  static constexpr double WEIGHT_GAMMA = 1.5;
+
+  /**
+   * @brief Map width
+   */
+  double m_width;
+
+  /**
+   * @brief Map height
+   */
+  double m_height;
+
+  /**
+   * @brief Number of points to produce
+   */
+  size_t m_target_count;
+
+  /**
+   * @brief Candidates generated per output point
+   */
+  double m_candidate_ratio;
+
+  /**
+   * @brief Largest possible spacing of `m_target_count` points on the map
+   * (hexagonal packing); two candidates interact within 2 * m_r_max
+   */
+  double m_r_max;
+
+  /**
+   * @brief Lower clamp on the distance used for weights
+   */
+  double m_r_min;
+
+  /**
+   * @brief The candidates
+   */
+  std::vector<Point> m_candidates;
+
+  /**
+   * @brief Bucket grid over the candidates with cells of side 2 * m_r_max,
+   * as CSR: candidates of cell c are m_cell_items[m_cell_start[c] ..
+   * m_cell_start[c + 1])
+   */
+  int m_grid_width;
+  int m_grid_height;
+  double m_grid_cell_size;
+  std::vector<uint32_t> m_cell_start;
+  std::vector<uint32_t> m_cell_items;
+
+  /**
+   * @brief Current weight of every candidate
+   */
+  std::vector<double> m_weights;
+
+  // Implementation
+  /**
+   * @brief Bucket the candidates into the grid
+   */
+  void build_grid();
+
+  /**
+   * @brief Weight contributed to a candidate by a neighbor at `distance`
+   */
+  double weight(double distance) const;
+
+  /**
+   * @brief Call `fn(neighbor, distance)` for every other candidate within
+   * 2 * m_r_max of candidate `index`
+   */
+  template<typename F>
+  void for_each_neighbor(uint32_t index, F&& fn) const;
+};
+}
+
+#endif
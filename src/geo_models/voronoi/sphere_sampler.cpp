@@ -0,0 +1,76 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+#include <algorithm>
+#include <cmath>
+
+// Application files
+#include <defs/batch_rng.h>
+#include <geo_models/voronoi/sphere_sampler.h>
+
+///////////////////////////////////////////////////////////////////////
+
+using ss = world_builder::Sphere_sampler;
+
+///////////////////////////////////////////////////////////////////////
+
+ss::Sphere_sampler(size_t count, double jitter)
+  :
+  m_count(count),
+  m_jitter(jitter)
+{ }
+
+///////////////////////////////////////////////////////////////////////
+
+size_t ss::Count_for_spacing(double width, double spacing)
+{
+  // The equator is the map width, so the sphere has radius width / 2π
+  const double radius = width / (2.0 * M_PI);
+  const double area = 4.0 * M_PI * radius * radius;
+  return std::max<size_t>(4, static_cast<size_t>(area / (POISSON_AREA_PER_SITE * spacing * spacing)));
+}
+
+///////////////////////////////////////////////////////////////////////
+
+std::vector<world_builder::Vec3> ss::Generate()
+{
+  const size_t n = m_count;
+  std::vector<Vec3> sites(n);
+  if (n == 0)
+    return sites;
+
+  // Random pushes, drawn in blocks: a direction and a distance uniform over
+  // the disc of radius jitter * spacing
+  std::vector<double> push_cos(n);
+  std::vector<double> push_sin(n);
+  std::vector<double> push_area(n);
+  dice::Batch_rng rng;
+  rng.Fill_directions(push_cos.data(), push_sin.data(), n);
+  rng.Fill_uniform(push_area.data(), n, 0.0, 1.0);
+
+  const double golden_angle = M_PI * (3.0 - std::sqrt(5.0));
+  const double spacing = std::sqrt(4.0 * M_PI / n);
+  for (size_t i = 0; i < n; i++)
+  {
+    double z = 1.0 - (2.0 * i + 1.0) / n;
+    double ring = std::sqrt(std::max(0.0, 1.0 - z*z));
+    double longitude = golden_angle * i;
+    Vec3 p{ring * std::cos(longitude), ring * std::sin(longitude), z};
+
+    // Tangent frame: east along the latitude circle, north toward the pole.
+    // The lattice never lands on a pole, so `ring` is never 0.
+    Vec3 east{-std::sin(longitude), std::cos(longitude), 0.0};
+    Vec3 north = Cross(p, east);
+    double push = m_jitter * spacing * std::sqrt(push_area[i]);
+    double de = push * push_cos[i];
+    double dn = push * push_sin[i];
+    sites[i] = Normalized(Vec3{p.x + de*east.x + dn*north.x,
+                               p.y + de*east.y + dn*north.y,
+                               p.z + de*east.z + dn*north.z});
+  }
+  return sites;
+}
+
+///////////////////////////////////////////////////////////////////////
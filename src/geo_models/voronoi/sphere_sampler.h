@@ -0,0 +1,113 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef SPHERE_SAMPLER_H
+#define SPHERE_SAMPLER_H
+
+// Standard libs
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Application files
+
+namespace world_builder
+{
+
+/**
+ * @brief A point or direction in 3D, for sites on the planet sphere
+ */
+struct Vec3
+{
+  /**
+   * @brief Coordinates; the poles are at z = +-1
+   */
+  double x;
+  double y;
+  double z;
+};
+
+/**
+ * @brief Dot product
+ */
+inline double Dot(const Vec3& a, const Vec3& b)
+{
+  return a.x*b.x + a.y*b.y + a.z*b.z;
+}
+
+/**
+ * @brief Cross product
+ */
+inline Vec3 Cross(const Vec3& a, const Vec3& b)
+{
+  return Vec3{a.y*b.z - a.z*b.y, a.z*b.x - a.x*b.z, a.x*b.y - a.y*b.x};
+}
+
+/**
+ * @brief `v` scaled to unit length, unchanged if it is zero
+ */
+inline Vec3 Normalized(const Vec3& v)
+{
+  double length = std::sqrt(Dot(v, v));
+  return (length > 0) ? Vec3{v.x / length, v.y / length, v.z / length} : v;
+}
+
+/**
+ * @brief Blue-noise sites on the unit sphere: a Fibonacci lattice with
+ * jitter
+ * @details Site i of n sits at height z = 1 - (2i + 1) / n and longitude
+ * i times the golden angle, which spreads sites evenly with equal area per
+ * site at any latitude, so there is no pole crowding and no seam. Each site
+ * is then pushed a random distance in a random tangent direction to break
+ * up the spiral pattern.
+ */
+class Sphere_sampler
+{
+public:
+  // Attributes
+
+  // Implementation
+  /**
+   * @brief Constructor
+   * @param count Number of sites
+   * @param jitter Largest push as a fraction of the mean site spacing; 0
+   * keeps the exact lattice, 0.5 or less keeps sites from crossing
+   */
+  Sphere_sampler(size_t count, double jitter = 0.1);
+
+  /**
+   * @brief Site count matching a flat map's Poisson disc spacing on a planet
+   * whose equator is the map width
+   * @param width Map width, the planet's circumference
+   * @param spacing Minimum distance between Poisson disc points
+   * @return The count
+   */
+  static size_t Count_for_spacing(double width, double spacing);
+
+  /**
+   * @brief Generate the sites; the generator is seeded from the shared dice
+   * @return Unit vectors, in lattice order from the north pole
+   */
+  std::vector<Vec3> Generate();
+
+private:
+  // Attributes
+  /**
+   * @brief Map area per Poisson disc point at unit spacing, measured
+   */
+  static constexpr double POISSON_AREA_PER_SITE = 1.5;
+
+  /**
+   * @brief Number of sites
+   */
+  size_t m_count;
+
+  /**
+   * @brief Largest push as a fraction of the mean site spacing
+   */
+  double m_jitter;
+};
+}
+
+#endif
@@ -0,0 +1,659 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+// Application files
+#include <defs/batch_rng.h>
+#include <utils/task_scheduler.h>
+#include <utils/world_builder_utils.h>
+#include <geo_models/voronoi/spherical_voronoi.h>
+
+///////////////////////////////////////////////////////////////////////
+
+using sv = world_builder::Spherical_voronoi;
+
+///////////////////////////////////////////////////////////////////////
+
+namespace
+{
+/**
+ * @brief a - b
+ */
+world_builder::Vec3 Minus(const world_builder::Vec3& a, const world_builder::Vec3& b)
+{
+  return world_builder::Vec3{a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+/**
+ * @brief Area of the spherical triangle with unit corners a, b, c, by the
+ * formula of Van Oosterom and Strackee
+ */
+double Triangle_area(const world_builder::Vec3& a, const world_builder::Vec3& b, const world_builder::Vec3& c)
+{
+  double triple = std::abs(world_builder::Dot(a, world_builder::Cross(b, c)));
+  double denominator = 1.0 + world_builder::Dot(a, b) + world_builder::Dot(b, c) + world_builder::Dot(c, a);
+  return 2.0 * std::atan2(triple, denominator);
+}
+}
+
+///////////////////////////////////////////////////////////////////////
+
+world_builder::Point world_builder::Equirectangular_point(const Vec3& p, double width, double height)
+{
+  double longitude = std::atan2(p.y, p.x);
+  double latitude = std::asin(std::clamp(p.z, -1.0, 1.0));
+  double x = (longitude + M_PI) / (2.0 * M_PI) * width;
+  return Point{(x >= width) ? x - width : x, (0.5 * M_PI - latitude) / M_PI * height};
+}
+
+///////////////////////////////////////////////////////////////////////
+
+world_builder::Vec3 world_builder::Equirectangular_direction(double x, double y, double width, double height)
+{
+  double longitude = 2.0 * M_PI * x / width - M_PI;
+  double latitude = 0.5 * M_PI - M_PI * y / height;
+  double ring = std::cos(latitude);
+  return Vec3{ring * std::cos(longitude), ring * std::sin(longitude), std::sin(latitude)};
+}
+
+///////////////////////////////////////////////////////////////////////
+
+sv::Spherical_voronoi()
+  :
+  m_sites(),
+  m_colors(),
+  m_vertices(),
+  m_cell_start(1, 0),
+  m_cell_vertices(),
+  m_cell_neighbors(),
+  m_first_cell(-1),
+  m_faces(),
+  m_free_faces(),
+  m_visible(),
+  m_face_mark(),
+  m_mark(0),
+  m_horizon(),
+  m_fan(),
+  m_fan_face_from()
+{ }
+
+///////////////////////////////////////////////////////////////////////
+
+bool sv::Build_cells(const std::vector<Vec3>& sites)
+{
+  m_sites = sites;
+  const size_t n = m_sites.size();
+
+  // Colors keyed by site, the same stream as the flat map's cells
+  m_colors.resize(n);
+  dice::Batch_rng(dice::ERng_stream::ERNG_STREAM_Cell_colors, 0).Fill_colors(m_colors.data(), n);
+
+  m_vertices.clear();
+  m_cell_vertices.clear();
+  m_cell_neighbors.clear();
+  m_cell_start.assign(n + 1, 0);
+  m_first_cell = -1;
+  if (!build_hull())
+    return false;
+  collect_cells();
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+bool sv::Relax_cells(int iterations)
+{
+  std::vector<Vec3> moved;
+  for (int pass = 0; pass < iterations; pass++)
+  {
+    // Centroid of the fan of triangles from the site around the cell, each
+    // weighted by its area
+    moved.resize(m_sites.size());
+    world_builder::Task_scheduler::Instance().Parallel_for(0, m_sites.size(), 256, [&](size_t lo, size_t hi)
+    {
+      for (size_t i = lo; i < hi; i++)
+      {
+        const Vec3& s = m_sites[i];
+        const uint32_t begin = m_cell_start[i];
+        const uint32_t end = m_cell_start[i + 1];
+        Vec3 sum{0, 0, 0};
+        for (uint32_t k = begin; k < end; k++)
+        {
+          const Vec3& a = m_vertices[m_cell_vertices[k]];
+          const Vec3& b = m_vertices[m_cell_vertices[(k + 1 < end) ? k + 1 : begin]];
+          double area = Triangle_area(s, a, b);
+          Vec3 center = Normalized(Vec3{s.x + a.x + b.x, s.y + a.y + b.y, s.z + a.z + b.z});
+          sum = Vec3{sum.x + area * center.x, sum.y + area * center.y, sum.z + area * center.z};
+        }
+        moved[i] = (begin == end) ? s : Normalized(sum);
+      }
+    });
+    if (!Build_cells(moved))
+      return false;
+  }
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void sv::Export_PPM(const std::string& filename, int width, int height) const
+{
+  if (width <= 0 || height <= 0)
+  {
+    std::cerr << "PPM export: invalid image dimensions\n";
+    return;
+  }
+
+  if (m_first_cell < 0)
+  {
+    std::cerr << "PPM export: no Voronoi cells to draw\n";
+    return;
+  }
+
+  std::vector<std::array<unsigned char, 3>> image(static_cast<size_t>(width) * height);
+
+  // Each pixel's walk starts from the cell of the pixel before it, so a row
+  // costs one long walk and then a step or two per pixel
+  world_builder::Task_scheduler::Instance().Parallel_for(0, height, 1, [&](size_t row_lo, size_t row_hi)
+  {
+    for (size_t y = row_lo; y < row_hi; ++y)
+    {
+      int cell = -1;
+      for (int x = 0; x < width; ++x)
+      {
+        cell = Locate_cell(Equirectangular_direction(x + 0.5, y + 0.5, width, height), cell);
+        image[y * width + x] = m_colors[cell];
+      }
+    }
+  });
+
+  // Sites on top, wrapping across the seam
+  const int point_radius = 2;
+  for (size_t i = 0; i < m_sites.size(); i++)
+  {
+    if (m_cell_start[i] == m_cell_start[i + 1])
+      continue;
+
+    Point p = Equirectangular_point(m_sites[i], width, height);
+    int cx = static_cast<int>(p.x);
+    int cy = static_cast<int>(p.y);
+    for (int dy = -point_radius; dy <= point_radius; ++dy)
+    {
+      for (int dx = -point_radius; dx <= point_radius; ++dx)
+      {
+        int py = cy + dy;
+        if (dx*dx + dy*dy > point_radius * point_radius || py < 0 || py >= height)
+          continue;
+
+        int px = (cx + dx + width) % width;
+        image[py * width + px] = {255, 255, 255};
+      }
+    }
+  }
+
+  world_builder::Write_ppm(filename, width, height, image);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+int sv::Locate_cell(const Vec3& direction, int hint) const
+{
+  if (m_first_cell < 0)
+    return -1;
+
+  int cell = m_first_cell;
+  if (hint >= 0 && static_cast<size_t>(hint) < m_sites.size() && m_cell_start[hint] != m_cell_start[hint + 1])
+    cell = hint;
+
+  // Step to the nearest neighbor while one is nearer; on the sphere nearer
+  // means a larger dot product
+  double best = Dot(m_sites[cell], direction);
+  while (true)
+  {
+    int next = cell;
+    for (uint32_t k = m_cell_start[cell]; k < m_cell_start[cell + 1]; k++)
+    {
+      int neighbor = m_cell_neighbors[k];
+      double d = Dot(m_sites[neighbor], direction);
+      if (d > best)
+      {
+        best = d;
+        next = neighbor;
+      }
+    }
+    if (next == cell)
+      return cell;
+    cell = next;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+
+double sv::Cell_area(size_t cell) const
+{
+  const uint32_t begin = m_cell_start[cell];
+  const uint32_t end = m_cell_start[cell + 1];
+  double area = 0;
+  for (uint32_t k = begin; k < end; k++)
+  {
+    area += Triangle_area(m_sites[cell],
+                          m_vertices[m_cell_vertices[k]],
+                          m_vertices[m_cell_vertices[(k + 1 < end) ? k + 1 : begin]]);
+  }
+  return area;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+bool sv::build_hull()
+{
+  const size_t n = m_sites.size();
+  m_faces.clear();
+  m_free_faces.clear();
+  m_face_mark.clear();
+  m_mark = 0;
+  m_fan_face_from.assign(n, -1);
+  if (n < 4)
+    return false;
+
+  std::array<int, 4> start;
+  if (!find_start(start))
+    return false;
+
+  // The fourth corner must be below the first face
+  const Vec3 normal = Cross(Minus(m_sites[start[1]], m_sites[start[0]]),
+                            Minus(m_sites[start[2]], m_sites[start[0]]));
+  if (Dot(normal, Minus(m_sites[start[3]], m_sites[start[0]])) > 0)
+    std::swap(start[1], start[2]);
+
+  m_fan.assign({add_face(start[0], start[1], start[2]), add_face(start[0], start[3], start[1]),
+                add_face(start[1], start[3], start[2]), add_face(start[2], start[3], start[0])});
+  for (int f : m_fan)
+  {
+    // Walking and the Voronoi vertices both need the center inside the hull
+    if (m_faces[f].offset <= VISIBLE_EPSILON)
+      return false;
+
+    for (int k = 0; k < 3; k++)
+    {
+      const int a = m_faces[f].v[k];
+      const int b = m_faces[f].v[(k + 1) % 3];
+      for (int g : m_fan)
+      {
+        for (int j = 0; j < 3; j++)
+        {
+          if (m_faces[g].v[j] == b && m_faces[g].v[(j + 1) % 3] == a)
+            m_faces[f].adj[k] = g;
+        }
+      }
+    }
+  }
+
+  // Biased randomized insertion order: random rounds, each twice the size of
+  // the one before, so the hull stays well shaped as it grows, with each
+  // round sorted along latitude bands so the walk to the next site is short
+  std::vector<int> order;
+  order.reserve(n);
+  for (size_t i = 0; i < n; i++)
+  {
+    int site = static_cast<int>(i);
+    if (std::find(start.begin(), start.end(), site) == start.end())
+      order.push_back(site);
+  }
+  dice::Batch_rng rng(INSERT_ORDER_SEED);
+  for (size_t i = order.size(); i > 1; i--)
+  {
+    std::swap(order[i - 1], order[rng.Next_below(i)]);
+  }
+
+  std::vector<std::pair<uint64_t, int>> keyed;
+  for (size_t round_end = order.size(); round_end > 0; )
+  {
+    size_t round_begin = (round_end > BRIO_FIRST_ROUND) ? round_end / 2 : 0;
+    const size_t count = round_end - round_begin;
+    const int bands = std::max(1, static_cast<int>(std::sqrt(0.5 * count)));
+    const int columns = 2 * bands;
+    keyed.clear();
+    for (size_t i = round_begin; i < round_end; i++)
+    {
+      const Vec3& q = m_sites[order[i]];
+      int band = std::min(bands - 1, static_cast<int>((1.0 - q.z) * 0.5 * bands));
+      int column = std::min(columns - 1, static_cast<int>((std::atan2(q.y, q.x) + M_PI) / (2.0 * M_PI) * columns));
+      if (band % 2 == 1)
+        column = columns - 1 - column;
+      keyed.push_back({static_cast<uint64_t>(band) * columns + column, order[i]});
+    }
+    std::sort(keyed.begin(), keyed.end());
+    for (size_t i = 0; i < count; i++)
+    {
+      order[round_begin + i] = keyed[i].second;
+    }
+    round_end = round_begin;
+  }
+
+  int face = m_fan[0];
+  for (int p : order)
+  {
+    face = find_visible_face(p, face);
+    if (face < 0)
+    {
+      // A repeated site, which sees no face
+      face = m_fan[0];
+      continue;
+    }
+    face = add_site(p, face);
+  }
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+bool sv::find_start(std::array<int, 4>& start) const
+{
+  const size_t n = m_sites.size();
+
+  // Distance from the center to the plane of face (a, b, c), positive when
+  // the center is on the same side as d
+  auto depth = [&](int a, int b, int c, int d)
+  {
+    const Vec3 normal = Normalized(Cross(Minus(m_sites[b], m_sites[a]), Minus(m_sites[c], m_sites[a])));
+    const double offset = Dot(normal, m_sites[a]);
+    return (Dot(normal, m_sites[d]) < offset) ? offset : -offset;
+  };
+
+  // How deep the center is inside a tetrahedron, through its shallowest
+  // face; written so a flat tetrahedron's NaN depths never count as inside
+  auto inside = [&](const std::array<int, 4>& t)
+  {
+    const double faces[4] = {depth(t[0], t[1], t[2], t[3]), depth(t[0], t[1], t[3], t[2]),
+                             depth(t[0], t[2], t[3], t[1]), depth(t[1], t[2], t[3], t[0])};
+    double shallowest = std::numeric_limits<double>::infinity();
+    for (double face : faces)
+    {
+      shallowest = (face > VISIBLE_EPSILON) ? std::min(shallowest, face) : -1.0;
+      if (shallowest < 0)
+        break;
+    }
+    return shallowest;
+  };
+
+  // Usually the sites nearest the corners of a regular tetrahedron, so the
+  // center of the sphere is well inside it
+  const std::array<Vec3, 4> corners = {Vec3{1, 1, 1}, Vec3{1, -1, -1}, Vec3{-1, 1, -1}, Vec3{-1, -1, 1}};
+  start = {-1, -1, -1, -1};
+  for (size_t c = 0; c < corners.size(); c++)
+  {
+    double best = -4.0;
+    for (size_t i = 0; i < n; i++)
+    {
+      double d = Dot(corners[c], m_sites[i]);
+      if (d > best && std::find(start.begin(), start.end(), static_cast<int>(i)) == start.end())
+      {
+        best = d;
+        start[c] = static_cast<int>(i);
+      }
+    }
+  }
+  if (start[3] >= 0 && inside(start) > 0)
+    return true;
+
+  // Otherwise the four candidates with the center deepest inside. Small
+  // site sets try every site; larger ones the sites nearest the corners,
+  // edges and faces of a cube, which surround the center for any set
+  // spread over the sphere
+  std::vector<int> candidates;
+  if (n <= EXHAUSTIVE_START)
+  {
+    for (size_t i = 0; i < n; i++)
+      candidates.push_back(static_cast<int>(i));
+  }
+  else
+  {
+    for (int x = -1; x <= 1; x++)
+    {
+      for (int y = -1; y <= 1; y++)
+      {
+        for (int z = -1; z <= 1; z++)
+        {
+          if (x == 0 && y == 0 && z == 0)
+            continue;
+          const Vec3 direction{static_cast<double>(x), static_cast<double>(y), static_cast<double>(z)};
+          int nearest = 0;
+          for (size_t i = 1; i < n; i++)
+          {
+            if (Dot(direction, m_sites[i]) > Dot(direction, m_sites[nearest]))
+              nearest = static_cast<int>(i);
+          }
+          if (std::find(candidates.begin(), candidates.end(), nearest) == candidates.end())
+            candidates.push_back(nearest);
+        }
+      }
+    }
+  }
+
+  double best = 0;
+  start = {-1, -1, -1, -1};
+  const size_t count = candidates.size();
+  for (size_t i = 0; i < count; i++)
+  {
+    for (size_t j = i + 1; j < count; j++)
+    {
+      for (size_t k = j + 1; k < count; k++)
+      {
+        for (size_t l = k + 1; l < count; l++)
+        {
+          const std::array<int, 4> t = {candidates[i], candidates[j], candidates[k], candidates[l]};
+          const double depth_inside = inside(t);
+          if (depth_inside > best)
+          {
+            best = depth_inside;
+            start = t;
+          }
+        }
+      }
+    }
+  }
+  return start[0] >= 0;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+int sv::add_face(int a, int b, int c)
+{
+  Hull_face face;
+  face.v = {a, b, c};
+  face.adj = {-1, -1, -1};
+  face.normal = Normalized(Cross(Minus(m_sites[b], m_sites[a]), Minus(m_sites[c], m_sites[a])));
+  face.offset = Dot(face.normal, m_sites[a]);
+  face.alive = true;
+  if (!m_free_faces.empty())
+  {
+    int f = m_free_faces.back();
+    m_free_faces.pop_back();
+    m_faces[f] = face;
+    return f;
+  }
+  m_faces.push_back(face);
+  m_face_mark.push_back(0);
+  return static_cast<int>(m_faces.size()) - 1;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+int sv::find_visible_face(int p, int start) const
+{
+  // Every site is on the sphere, so it sees the face whose cone from the
+  // center holds it. Walk toward that cone across whichever edge has p on
+  // its far side; on a Delaunay triangulation this never cycles.
+  const Vec3& site = m_sites[p];
+  int f = start;
+  for (size_t step = 0; step <= m_faces.size(); step++)
+  {
+    const Hull_face& face = m_faces[f];
+    if (Dot(face.normal, site) - face.offset > VISIBLE_EPSILON)
+      return f;
+
+    int next = -1;
+    for (int k = 0; k < 3 && next < 0; k++)
+    {
+      if (Dot(Cross(m_sites[face.v[k]], m_sites[face.v[(k + 1) % 3]]), site) < 0)
+        next = face.adj[k];
+    }
+    if (next < 0)
+      return -1;
+    f = next;
+  }
+  return -1;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+int sv::add_site(int p, int face)
+{
+  const Vec3& site = m_sites[p];
+  auto sees = [&](int f) { return Dot(m_faces[f].normal, site) - m_faces[f].offset > VISIBLE_EPSILON; };
+
+  // Flood the faces p sees; every edge out of that region is on the horizon
+  m_mark++;
+  m_visible.assign(1, face);
+  m_face_mark[face] = m_mark;
+  m_horizon.clear();
+  for (size_t next = 0; next < m_visible.size(); next++)
+  {
+    const Hull_face& visible = m_faces[m_visible[next]];
+    for (int k = 0; k < 3; k++)
+    {
+      int beyond = visible.adj[k];
+      if (m_face_mark[beyond] == m_mark)
+        continue;
+
+      if (sees(beyond))
+      {
+        m_face_mark[beyond] = m_mark;
+        m_visible.push_back(beyond);
+      }
+      else
+      {
+        m_horizon.push_back({visible.v[k], visible.v[(k + 1) % 3], beyond});
+      }
+    }
+  }
+
+  // The seen faces are free once the fan replaces them
+  for (int f : m_visible)
+  {
+    m_faces[f].alive = false;
+    m_free_faces.push_back(f);
+  }
+
+  // Fan from p to the horizon, stitched to the faces beyond it and to itself
+  m_fan.clear();
+  for (const auto& edge : m_horizon)
+  {
+    int f = add_face(edge[0], edge[1], p);
+    Hull_face& beyond = m_faces[edge[2]];
+    for (int k = 0; k < 3; k++)
+    {
+      if (beyond.v[k] == edge[1] && beyond.v[(k + 1) % 3] == edge[0])
+        beyond.adj[k] = f;
+    }
+    m_faces[f].adj[0] = edge[2];
+    m_fan_face_from[edge[0]] = f;
+    m_fan.push_back(f);
+  }
+  for (int f : m_fan)
+  {
+    int next = m_fan_face_from[m_faces[f].v[1]];
+    m_faces[f].adj[1] = next;
+    m_faces[next].adj[2] = f;
+  }
+  return m_fan[0];
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void sv::collect_cells()
+{
+  const size_t n = m_sites.size();
+
+  // Every live face is a Voronoi vertex: its outward normal is the direction
+  // equally far from its three corners
+  std::vector<int> face_vertex(m_faces.size(), -1);
+  std::vector<int> site_face(n, -1);
+  for (size_t f = 0; f < m_faces.size(); f++)
+  {
+    const Hull_face& face = m_faces[f];
+    if (!face.alive)
+      continue;
+
+    face_vertex[f] = static_cast<int>(m_vertices.size());
+    m_vertices.push_back(face.normal);
+    for (int v : face.v)
+    {
+      site_face[v] = static_cast<int>(f);
+    }
+  }
+
+  // Around site s, the face after f (counterclockwise) is across the edge
+  // ending at s; that edge leads to the Delaunay neighbor
+  auto walk = [&](size_t s, auto&& visit)
+  {
+    const int start = site_face[s];
+    if (start < 0)
+      return;
+
+    int f = start;
+    do
+    {
+      const Hull_face& face = m_faces[f];
+      int k = (face.v[0] == static_cast<int>(s)) ? 0 : (face.v[1] == static_cast<int>(s)) ? 1 : 2;
+      visit(face_vertex[f], face.v[(k + 2) % 3]);
+      f = face.adj[(k + 2) % 3];
+    } while (f != start);
+  };
+
+  auto& scheduler = world_builder::Task_scheduler::Instance();
+  scheduler.Parallel_for(0, n, 256, [&](size_t lo, size_t hi)
+  {
+    for (size_t i = lo; i < hi; i++)
+    {
+      uint32_t count = 0;
+      walk(i, [&](int, int) { count++; });
+      m_cell_start[i + 1] = count;
+    }
+  });
+  for (size_t i = 0; i < n; i++)
+  {
+    m_cell_start[i + 1] += m_cell_start[i];
+  }
+
+  m_cell_vertices.resize(m_cell_start[n]);
+  m_cell_neighbors.resize(m_cell_start[n]);
+  scheduler.Parallel_for(0, n, 256, [&](size_t lo, size_t hi)
+  {
+    for (size_t i = lo; i < hi; i++)
+    {
+      uint32_t slot = m_cell_start[i];
+      walk(i, [&](int vertex, int neighbor)
+      {
+        m_cell_vertices[slot] = vertex;
+        m_cell_neighbors[slot] = neighbor;
+        slot++;
+      });
+    }
+  });
+
+  for (size_t i = 0; i < n && m_first_cell < 0; i++)
+  {
+    if (m_cell_start[i] != m_cell_start[i + 1])
+      m_first_cell = static_cast<int>(i);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
@@ -0,0 +1,270 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef SPHERICAL_VORONOI_H
+#define SPHERICAL_VORONOI_H
+
+// Standard libs
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Application files
+#include <geo_models/voronoi/poisson_disc.h>
+#include <geo_models/voronoi/sphere_sampler.h>
+
+namespace world_builder
+{
+
+/**
+ * @brief Equirectangular map position of a direction: longitude across the
+ * width from -π at x = 0, latitude down the height from the north pole
+ * @param p Unit vector
+ * @param width Map width
+ * @param height Map height
+ * @return The position, inside [0, width) x [0, height]
+ */
+Point Equirectangular_point(const Vec3& p, double width, double height);
+
+/**
+ * @brief Direction of an equirectangular map position, the inverse of
+ * Equirectangular_point
+ * @param x Map x
+ * @param y Map y
+ * @param width Map width
+ * @param height Map height
+ * @return Unit vector
+ */
+Vec3 Equirectangular_direction(double x, double y, double width, double height);
+
+/**
+ * @brief Builds Voronoi cells of sites on the unit sphere, for planets with
+ * no seam and no poles to distort
+ * @details The Delaunay triangulation of points on a sphere is their 3D
+ * convex hull, and the Voronoi vertex of each hull face is its outward
+ * normal, so no ghost copies of the sites are needed. The hull is built
+ * incrementally: every site is on the sphere, so a short walk over the hull
+ * from the last site added finds a face the next one sees, and adding it
+ * replaces the faces it sees with a fan to their horizon.
+ *
+ * Cells are kept flat, as CSR arrays: cell i is entries
+ * Get_cell_start()[i] .. Get_cell_start()[i + 1] of Get_cell_vertices() and
+ * Get_cell_neighbors(), counterclockwise seen from outside the sphere.
+ */
+class Spherical_voronoi
+{
+public:
+  // Implementation
+  /**
+   * @brief Constructor, with no cells
+   */
+  Spherical_voronoi();
+
+  /**
+   * @brief Build the cells of the sites
+   * @param sites Unit vectors spread over the whole sphere; a site that
+   * repeats an earlier one gets no cell, and sites too few or too lopsided to
+   * surround the center of the sphere give none
+   * @return False if the sites gave no cells
+   */
+  bool Build_cells(const std::vector<Vec3>& sites);
+
+  /**
+   * @brief Lloyd relaxation on the sphere: move every site to the centroid
+   * of its cell and rebuild, `iterations` times
+   * @param iterations Passes
+   * @return False if a rebuild gave no cells; relaxation stops there
+   */
+  bool Relax_cells(int iterations);
+
+  /**
+   * @brief Export the cells as an equirectangular PPM
+   * @param filename Output filename
+   * @param width Image width, the full circle of longitude
+   * @param height Image height, pole to pole
+   */
+  void Export_PPM(const std::string& filename, int width, int height) const;
+
+  /**
+   * @brief Cell containing a direction, i.e. the nearest site
+   * @details Walks the Delaunay graph from `hint` to whichever neighbor is
+   * nearer until none is, which on a Delaunay graph ends at the nearest
+   * site. A hint near the answer, like the cell of the previous pixel, makes
+   * this O(1).
+   * @param direction Unit vector
+   * @param hint Cell to start from, -1 for any
+   * @return Site index, -1 if there are no cells
+   */
+  int Locate_cell(const Vec3& direction, int hint = -1) const;
+
+  /**
+   * @brief Area of a cell on the unit sphere; all cells sum to 4π
+   * @param cell Site index
+   * @return The area, 0 for a site without a cell
+   */
+  double Cell_area(size_t cell) const;
+
+  /**
+   * @brief The sites of the last build
+   */
+  const std::vector<Vec3>& Get_sites() const { return m_sites; }
+
+  /**
+   * @brief Voronoi vertices, unit vectors
+   */
+  const std::vector<Vec3>& Get_vertices() const { return m_vertices; }
+
+  /**
+   * @brief Start of every cell's entries, one past the last cell at the end
+   */
+  const std::vector<uint32_t>& Get_cell_start() const { return m_cell_start; }
+
+  /**
+   * @brief Vertex indices of every cell
+   */
+  const std::vector<int>& Get_cell_vertices() const { return m_cell_vertices; }
+
+  /**
+   * @brief Site across the edge from each cell vertex to the next: the
+   * Delaunay neighbors
+   */
+  const std::vector<int>& Get_cell_neighbors() const { return m_cell_neighbors; }
+
+private:
+  // Attributes
+  /**
+   * @brief A face of the hull, counterclockwise seen from outside
+   */
+  struct Hull_face
+  {
+    /**
+     * @brief Corner sites
+     */
+    std::array<int, 3> v;
+
+    /**
+     * @brief Face across the edge from v[k] to v[k + 1]
+     */
+    std::array<int, 3> adj;
+
+    /**
+     * @brief Outward unit normal and plane offset: q is outside when
+     * Dot(normal, q) > offset
+     */
+    Vec3 normal;
+    double offset;
+
+    /**
+     * @brief False once replaced
+     */
+    bool alive;
+  };
+
+  /**
+   * @brief A site sees a face when it is more than this above the plane
+   */
+  static constexpr double VISIBLE_EPSILON = 1e-12;
+
+  /**
+   * @brief Most sites for which every four are tried as the starting
+   * tetrahedron
+   */
+  static constexpr size_t EXHAUSTIVE_START = 32;
+
+  /**
+   * @brief Seed of the insertion order; the hull does not depend on it
+   */
+  static constexpr uint64_t INSERT_ORDER_SEED = 0x5eed;
+
+  /**
+   * @brief Sites in the first round of the insertion order
+   */
+  static constexpr size_t BRIO_FIRST_ROUND = 64;
+
+  /**
+   * @brief Sites of the last build
+   */
+  std::vector<Vec3> m_sites;
+
+  /**
+   * @brief Cell colors keyed by site
+   */
+  std::vector<std::array<unsigned char, 3>> m_colors;
+
+  /**
+   * @brief Voronoi vertices and cells, see Get_cell_start()
+   */
+  std::vector<Vec3> m_vertices;
+  std::vector<uint32_t> m_cell_start;
+  std::vector<int> m_cell_vertices;
+  std::vector<int> m_cell_neighbors;
+
+  /**
+   * @brief A site with a cell, where walks start without a hint; -1 if none
+   */
+  int m_first_cell;
+
+  /**
+   * @brief Hull faces, and the replaced ones free for reuse
+   */
+  std::vector<Hull_face> m_faces;
+  std::vector<int> m_free_faces;
+
+  /**
+   * @brief Insertion scratch: faces seen by the new site, visit marks, the
+   * horizon as (from, to, face beyond), the fan of new faces and the fan's
+   * face starting at each horizon site
+   */
+  std::vector<int> m_visible;
+  std::vector<int> m_face_mark;
+  int m_mark;
+  std::vector<std::array<int, 3>> m_horizon;
+  std::vector<int> m_fan;
+  std::vector<int> m_fan_face_from;
+
+  // Implementation
+  /**
+   * @brief Build the hull of m_sites into m_faces
+   * @return False if no four sites surround the center of the sphere
+   */
+  bool build_hull();
+
+  /**
+   * @brief Pick four sites whose tetrahedron surrounds the center of the
+   * sphere, to start the hull from
+   * @param start The sites, in no particular orientation; build_hull()
+   * orients them
+   * @return False if no four sites surround the center
+   */
+  bool find_start(std::array<int, 4>& start) const;
+
+  /**
+   * @brief Add a hull face, with its plane and no neighbors or sites
+   * @return Index of the face
+   */
+  int add_face(int a, int b, int c);
+
+  /**
+   * @brief Find a hull face site p sees, walking from `start`
+   * @return The face, -1 if p sees none
+   */
+  int find_visible_face(int p, int start) const;
+
+  /**
+   * @brief Add site p to the hull
+   * @param p The site
+   * @param face A face p sees
+   * @return One of the new faces, where the next walk can start
+   */
+  int add_site(int p, int face);
+
+  /**
+   * @brief Turn the hull into Voronoi vertices and cells
+   */
+  void collect_cells();
+};
+}
+
+#endif
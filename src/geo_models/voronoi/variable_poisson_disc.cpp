@@ -0,0 +1,287 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+
+// Application files
+#include <defs/dice_rolls.h>
+#include <geo_models/voronoi/variable_poisson_disc.h>
+
+///////////////////////////////////////////////////////////////////////
+
+using vpd = world_builder::Variable_poisson_disc;
+
+///////////////////////////////////////////////////////////////////////
+
+namespace
+{
+/**
+ * @brief Next whitespace separated token of a plain PNM file, skipping
+ * comments
+ */
+bool Next_pnm_token(std::istream& is, std::string& token)
+{
+  while(is >> token)
+  {
+    if(token[0] != '#')
+    {
+      return true;
+    }
+    std::getline(is, token);
+  }
+  return false;
+}
+}
+
+///////////////////////////////////////////////////////////////////////
+
+vpd::Variable_poisson_disc(double width,
+                           double height,
+                           Radius_function radius,
+                           double min_radius,
+                           double max_radius,
+                           int attempts)
+  :
+  Variable_poisson_disc(width, height, std::move(radius), min_radius, max_radius, attempts,
+                        dice::Draw_seed())
+{ }
+
+///////////////////////////////////////////////////////////////////////
+
+vpd::Variable_poisson_disc(double width,
+                           double height,
+                           Radius_function radius,
+                           double min_radius,
+                           double max_radius,
+                           int attempts,
+                           uint64_t seed)
+  :
+  m_width(width),
+  m_height(height),
+  m_radius(std::move(radius)),
+  m_min_radius(min_radius),
+  m_max_radius(std::max(min_radius, max_radius)),
+  m_k_attempts(attempts),
+  m_levels(),
+  m_points(),
+  m_point_radii(),
+  m_active_points(),
+  m_rng(seed),
+  m_candidate_x(attempts),
+  m_candidate_y(attempts),
+  m_candidate_distances(attempts)
+{
+  if(m_min_radius <= 0)
+  {
+    throw std::invalid_argument("Variable Poisson disc needs a minimum radius above zero");
+  }
+
+  // One grid per octave of radius, up to the one holding m_max_radius
+  size_t level_count = static_cast<size_t>(std::floor(std::log2(m_max_radius / m_min_radius))) + 1;
+  m_levels.resize(level_count);
+  for(size_t l = 0; l < level_count; ++l)
+  {
+    Level& level = m_levels[l];
+    level.base_radius = std::ldexp(m_min_radius, static_cast<int>(l));
+    level.cell_size = level.base_radius / std::sqrt(2.0);
+    level.grid_width = std::max(1, static_cast<int>(std::ceil(m_width / level.cell_size)));
+    level.grid_height = std::max(1, static_cast<int>(std::ceil(m_height / level.cell_size)));
+    level.grid_stride = level.grid_width + 2 * GRID_PAD;
+    level.count = 0;
+
+    size_t cells = static_cast<size_t>(level.grid_stride) * (level.grid_height + 2 * GRID_PAD);
+    level.x.assign(cells, EMPTY_CELL);
+    level.y.assign(cells, EMPTY_CELL);
+    level.radius.assign(cells, 0.0);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+
+std::vector<world_builder::Point> vpd::Generate()
+{
+  // First point anywhere on the map
+  Point first{m_rng.Next_uniform(0, m_width), m_rng.Next_uniform(0, m_height)};
+  place(first, radius_at(first.x, first.y));
+
+  while(!m_active_points.empty())
+  {
+    int index = static_cast<int>(m_rng.Next_below(m_active_points.size()));
+    int point_index = m_active_points[index];
+    Point p = m_points[point_index];
+    double r = m_point_radii[point_index];
+
+    // Candidates in the ring [r, 2r) around the parent, at the parent's spacing
+    m_rng.Fill_directions(m_candidate_x.data(), m_candidate_y.data(), m_k_attempts);
+    m_rng.Fill_uniform(m_candidate_distances.data(), m_k_attempts, r, 2 * r);
+
+    // Each candidate is tested against everything placed so far, including
+    // earlier candidates of this batch
+    bool placed_any = false;
+    for(int i = 0; i < m_k_attempts; i++)
+    {
+      double x = p.x + m_candidate_distances[i] * m_candidate_x[i];
+      double y = p.y + m_candidate_distances[i] * m_candidate_y[i];
+      if(x < 0 || x >= m_width || y < 0 || y >= m_height)
+      {
+        continue;
+      }
+
+      double candidate_radius = radius_at(x, y);
+      if(no_neighbors(x, y, candidate_radius))
+      {
+        place(Point{x, y}, candidate_radius);
+        placed_any = true;
+      }
+    }
+
+    if(!placed_any)
+    {
+      m_active_points[index] = m_active_points.back();
+      m_active_points.pop_back();
+    }
+  }
+
+  return m_points;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+vpd::Radius_function vpd::Radius_from_image(const std::string& filename,
+                                            double width,
+                                            double height,
+                                            double min_radius,
+                                            double max_radius)
+{
+  std::ifstream ifs(filename);
+  if(!ifs)
+  {
+    throw std::runtime_error("Density map " + filename + " could not be opened");
+  }
+  std::string token;
+  if(!Next_pnm_token(ifs, token) || (token != "P2" && token != "P3"))
+  {
+    throw std::runtime_error("Density map " + filename + " is not a plain PGM (P2) or PPM (P3) image");
+  }
+  const int channels = (token == "P3") ? 3 : 1;
+
+  int header[3] = {};
+  for(int& value : header)
+  {
+    if(!Next_pnm_token(ifs, token))
+    {
+      throw std::runtime_error("Density map " + filename + " has a truncated header");
+    }
+    value = std::stoi(token);
+  }
+  const int image_width = header[0];
+  const int image_height = header[1];
+  const double max_value = std::max(1, header[2]);
+
+  // Brightness of every pixel, 0 to 1
+  auto brightness = std::make_shared<std::vector<double>>(static_cast<size_t>(image_width) * image_height);
+  for(double& pixel : *brightness)
+  {
+    double total = 0;
+    for(int c = 0; c < channels; ++c)
+    {
+      if(!Next_pnm_token(ifs, token))
+      {
+        throw std::runtime_error("Density map " + filename + " has too few pixels");
+      }
+      total += std::stoi(token);
+    }
+    pixel = total / (channels * max_value);
+  }
+
+  // Nearest pixel, with the image stretched over the whole map
+  const double scale_x = image_width / width;
+  const double scale_y = image_height / height;
+  return [=](double x, double y)
+  {
+    int ix = std::clamp(static_cast<int>(x * scale_x), 0, image_width - 1);
+    int iy = std::clamp(static_cast<int>(y * scale_y), 0, image_height - 1);
+    double value = (*brightness)[static_cast<size_t>(iy) * image_width + ix];
+    return min_radius + value * (max_radius - min_radius);
+  };
+}
+
+///////////////////////////////////////////////////////////////////////
+
+double vpd::radius_at(double x, double y) const
+{
+  return std::clamp(m_radius(x, y), m_min_radius, m_max_radius);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+size_t vpd::level_of(double radius) const
+{
+  int level = static_cast<int>(std::floor(std::log2(radius / m_min_radius)));
+  return static_cast<size_t>(std::clamp(level, 0, static_cast<int>(m_levels.size()) - 1));
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void vpd::place(const Point& point, double radius)
+{
+  m_points.push_back(point);
+  m_point_radii.push_back(radius);
+  m_active_points.push_back(static_cast<int>(m_points.size()) - 1);
+
+  Level& level = m_levels[level_of(radius)];
+  int grid_x = std::min(static_cast<int>(point.x / level.cell_size), level.grid_width - 1);
+  int grid_y = std::min(static_cast<int>(point.y / level.cell_size), level.grid_height - 1);
+  size_t cell = static_cast<size_t>(grid_y + GRID_PAD) * level.grid_stride + (grid_x + GRID_PAD);
+  level.x[cell] = point.x;
+  level.y[cell] = point.y;
+  level.radius[cell] = radius;
+  level.count++;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+bool vpd::no_neighbors(double x, double y, double radius) const
+{
+  bool too_close = false;
+  for(const Level& level : m_levels)
+  {
+    if(level.count == 0)
+    {
+      continue;
+    }
+
+    // Points on this level have radius below 2 * base_radius, so nothing
+    // further than that (or than our own radius) can conflict: at most 3
+    // cells away
+    double reach = std::min(radius, 2.0 * level.base_radius);
+    int span = std::min(GRID_PAD, static_cast<int>(std::ceil(reach / level.cell_size)));
+
+    int grid_x = std::min(static_cast<int>(x / level.cell_size), level.grid_width - 1);
+    int grid_y = std::min(static_cast<int>(y / level.cell_size), level.grid_height - 1);
+    size_t center = static_cast<size_t>(grid_y + GRID_PAD) * level.grid_stride + (grid_x + GRID_PAD);
+    for(int row = -span; row <= span; row++)
+    {
+      size_t first = center + row * level.grid_stride - span;
+      const double* gx = level.x.data() + first;
+      const double* gy = level.y.data() + first;
+      const double* gr = level.radius.data() + first;
+      for(int col = 0; col <= 2 * span; col++)
+      {
+        double dx = gx[col] - x;
+        double dy = gy[col] - y;
+        double limit = std::min(radius, gr[col]);
+        too_close |= (dx*dx + dy*dy < limit * limit);
+      }
+    }
+  }
+  return !too_close;
+}
+
+///////////////////////////////////////////////////////////////////////
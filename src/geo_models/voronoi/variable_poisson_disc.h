@@ -0,0 +1,213 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef VARIABLE_POISSON_DISC_H
+#define VARIABLE_POISSON_DISC_H
+
+// Standard libs
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Application files
+#include <defs/batch_rng.h>
+#include <geo_models/voronoi/poisson_disc.h>
+
+namespace world_builder
+{
+
+/**
+ * @brief Poisson disc sampling where the spacing varies over the map, so
+ * cells are only spent where detail matters
+ * @details The spacing at (x, y) comes from a radius function, clamped to
+ * [min_radius, max_radius]. Two points conflict when they are closer than the
+ * smaller of their radii, which for a smooth field is the same as the fixed
+ * radius test of Poisson_disc.
+ *
+ * Points are kept in a stack of background grids, one per octave of radius:
+ * level l holds points with radius in [min_radius * 2^l, min_radius * 2^(l+1))
+ * on cells of side min_radius * 2^l / sqrt(2), so a cell never holds more than
+ * one point and a neighbor test reads at most a 7x7 block per level, whatever
+ * the ratio between the largest and smallest radius.
+ */
+class Variable_poisson_disc
+{
+public:
+  // Attributes
+  /**
+   * @brief Minimum spacing at a map position
+   */
+  using Radius_function = std::function<double(double x, double y)>;
+
+  // Implementation
+  /**
+   * @brief Constructor
+   * @param width Map width
+   * @param height Map height
+   * @param radius Spacing at each position
+   * @param min_radius Smallest spacing `radius` returns
+   * @param max_radius Largest spacing `radius` returns
+   * @param attempts Candidates tried per active point
+   */
+  Variable_poisson_disc(double width,
+                        double height,
+                        Radius_function radius,
+                        double min_radius,
+                        double max_radius,
+                        int attempts = 30);
+
+  /**
+   * @brief Constructor with its own seed, independent of the shared dice
+   * @param width Map width
+   * @param height Map height
+   * @param radius Spacing at each position
+   * @param min_radius Smallest spacing `radius` returns
+   * @param max_radius Largest spacing `radius` returns
+   * @param attempts Candidates tried per active point
+   * @param seed Seed for this sampler's generator
+   */
+  Variable_poisson_disc(double width,
+                        double height,
+                        Radius_function radius,
+                        double min_radius,
+                        double max_radius,
+                        int attempts,
+                        uint64_t seed);
+
+  /**
+   * @brief Generate all points
+   * @return Vector of points generated
+   */
+  std::vector<Point> Generate();
+
+  /**
+   * @brief Radius function read from a grayscale or colour plain PPM/PGM
+   * (P2 or P3) image stretched over the map; black gives `min_radius`, white
+   * gives `max_radius`
+   * @param filename Image file
+   * @param width Map width
+   * @param height Map height
+   * @param min_radius Spacing for black pixels
+   * @param max_radius Spacing for white pixels
+   * @return The radius function
+   * @throws std::runtime_error If the image can't be read
+   */
+  static Radius_function Radius_from_image(const std::string& filename,
+                                           double width,
+                                           double height,
+                                           double min_radius,
+                                           double max_radius);
+
+private:
+  // Attributes
+  /**
+   * @brief Empty grid cells hold this coordinate, so the distance test
+   * always passes without a branch
+   */
+  static constexpr double EMPTY_CELL = 1e30;
+
+  /**
+   * @brief Cells of padding on every side of each grid, so the 7x7 scan
+   * never needs bounds checks
+   */
+  static constexpr int GRID_PAD = 3;
+
+  /**
+   * @brief One background grid, for points whose radius is within an octave
+   * of `base_radius`
+   */
+  struct Level
+  {
+    double base_radius;
+    double cell_size;
+    int grid_width;
+    int grid_height;
+    int grid_stride;
+    size_t count;
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> radius;
+  };
+
+  /**
+   * @brief Map width
+   */
+  double m_width;
+
+  /**
+   * @brief Map height
+   */
+  double m_height;
+
+  /**
+   * @brief Spacing at each position
+   */
+  Radius_function m_radius;
+
+  /**
+   * @brief Clamp range of m_radius
+   */
+  double m_min_radius;
+  double m_max_radius;
+
+  /**
+   * @brief Candidates tried per active point
+   */
+  int m_k_attempts;
+
+  /**
+   * @brief Background grids, finest first
+   */
+  std::vector<Level> m_levels;
+
+  /**
+   * @brief The points produced, and the radius of each
+   */
+  std::vector<Point> m_points;
+  std::vector<double> m_point_radii;
+
+  /**
+   * @brief Indices into m_points still eligible for neighbors
+   */
+  std::vector<int> m_active_points;
+
+  /**
+   * @brief Randomness for the sampler, drawn a block at a time
+   */
+  dice::Batch_rng m_rng;
+
+  /**
+   * @brief The k candidates around the current active point
+   */
+  std::vector<double> m_candidate_x;
+  std::vector<double> m_candidate_y;
+  std::vector<double> m_candidate_distances;
+
+  // Implementation
+  /**
+   * @brief Clamped spacing at a position
+   */
+  double radius_at(double x, double y) const;
+
+  /**
+   * @brief Level whose octave contains `radius`
+   */
+  size_t level_of(double radius) const;
+
+  /**
+   * @brief Add a point to the output, the active list and its level's grid
+   */
+  void place(const Point& point, double radius);
+
+  /**
+   * @brief Whether a candidate with spacing `radius` is clear of every
+   * placed point
+   */
+  bool no_neighbors(double x, double y, double radius) const;
+};
+}
+
+#endif
@@ -0,0 +1,51 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+#include <stdexcept>
+
+// Application files
+#include <geo_models/voronoi/boost_voronoi_backend.h>
+#include <geo_models/voronoi/clipping_voronoi_backend.h>
+#include <geo_models/voronoi/voronoi_backend.h>
+
+///////////////////////////////////////////////////////////////////////
+
+void world_builder::Flat_diagram::Reset(size_t site_count)
+{
+  cell_start.assign(site_count + 1, 0);
+  vertices.clear();
+  has_cell.assign(site_count, 0);
+  bounded.assign(site_count, 0);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+world_builder::EVoronoi_backend world_builder::Voronoi_backend_from_name(const std::string& name)
+{
+  if (name == "boost")
+    return EVoronoi_backend::EVORONOI_BACKEND_Boost;
+  if (name == "clipping")
+    return EVoronoi_backend::EVORONOI_BACKEND_Clipping;
+  throw std::invalid_argument("Unknown Voronoi backend \"" + name + "\"");
+}
+
+///////////////////////////////////////////////////////////////////////
+
+std::unique_ptr<world_builder::Voronoi_backend> world_builder::Make_voronoi_backend(EVoronoi_backend backend,
+                                                                                    ESite_input site_input,
+                                                                                    double scale_factor)
+{
+  switch (backend)
+  {
+    case EVoronoi_backend::EVORONOI_BACKEND_Boost:
+      return std::make_unique<Boost_voronoi_backend>(site_input, scale_factor);
+    case EVoronoi_backend::EVORONOI_BACKEND_Clipping:
+      return std::make_unique<Clipping_voronoi_backend>();
+    default:
+      throw std::invalid_argument("Unknown Voronoi backend");
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
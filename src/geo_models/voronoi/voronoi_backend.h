@@ -0,0 +1,127 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef VORONOI_BACKEND_H
+#define VORONOI_BACKEND_H
+
+// Standard libs
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Application files
+#include <geo_models/voronoi/poisson_disc.h>
+
+namespace world_builder
+{
+
+/**
+ * @brief Voronoi diagram of a site list, flattened: one polygon per site
+ */
+struct Flat_diagram
+{
+  /**
+   * @brief Polygon of site i is vertices[cell_start[i] .. cell_start[i + 1]),
+   * counterclockwise, finite vertices only
+   */
+  std::vector<uint32_t> cell_start;
+  std::vector<Point> vertices;
+
+  /**
+   * @brief Whether site i got a cell at all; duplicate sites don't
+   */
+  std::vector<unsigned char> has_cell;
+
+  /**
+   * @brief Whether site i's cell is bounded. Sites on the convex hull have
+   * unbounded cells, listed by their finite vertices alone.
+   */
+  std::vector<unsigned char> bounded;
+
+  /**
+   * @brief Size everything for `site_count` sites with no cells
+   */
+  void Reset(size_t site_count);
+};
+
+/**
+ * @brief How sites are handed to Boost's integer sweep-line
+ */
+enum class ESite_input : uint8_t
+{
+  ESITE_INPUT_Scaled,     ///< Multiplied by the configured scale factor, truncated to int32 by Boost
+  ESITE_INPUT_Quantized,  ///< Rounded onto an int32 grid sized from the map, duplicates dropped
+  ESITE_INPUT_Count       ///< Size of options enum
+};
+
+/**
+ * @brief Available Voronoi backends
+ */
+enum class EVoronoi_backend : uint8_t
+{
+  EVORONOI_BACKEND_Boost,     ///< Boost.Polygon sweep-line, exact predicates on int32 input
+  EVORONOI_BACKEND_Clipping,  ///< In-tree per-cell half-plane clipping over a spatial hash
+  EVORONOI_BACKEND_Count      ///< Size of options enum
+};
+
+/**
+ * @brief Something that turns sites into a Voronoi diagram
+ * @details An instance keeps whatever scratch storage it needs between
+ * builds and is used by one thread at a time; parallel builds each use their
+ * own instance.
+ */
+class Voronoi_backend
+{
+public:
+  // Implementation
+  /**
+   * @brief Destructor
+   */
+  virtual ~Voronoi_backend() = default;
+
+  /**
+   * @brief Fix anything that must be the same for every build of one map,
+   * e.g. an integer scale shared by all strips. Called before Build.
+   * @param width Map width
+   * @param height Map height
+   * @param site_count Real sites on the whole map
+   */
+  virtual void Prepare(double width, double height, size_t site_count) = 0;
+
+  /**
+   * @brief Build the diagram of `sites`
+   * @param sites The sites
+   * @param wanted Sites whose cells the caller reads; a backend may leave the
+   * others without a cell, though every site still shapes the diagram
+   * @param out The diagram, indexed like `sites`; existing contents are
+   * replaced
+   */
+  virtual void Build(const std::vector<Point>& sites,
+                     const std::vector<unsigned char>& wanted,
+                     Flat_diagram& out) = 0;
+};
+
+/**
+ * @brief Backend named in a config file
+ * @param name "boost" or "clipping"
+ * @return The backend
+ * @throws std::invalid_argument For any other name
+ */
+EVoronoi_backend Voronoi_backend_from_name(const std::string& name);
+
+/**
+ * @brief Make a backend
+ * @param backend Which backend
+ * @param site_input How the Boost backend converts sites
+ * @param scale_factor Scale for ESITE_INPUT_Scaled
+ * @return The backend
+ */
+std::unique_ptr<Voronoi_backend> Make_voronoi_backend(EVoronoi_backend backend,
+                                                      ESite_input site_input,
+                                                      double scale_factor);
+}
+
+#endif
@@ -3,9 +3,13 @@
  */
 
 // Standard libs
-#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
 
 // Application files
+#include <defs/batch_rng.h>
+#include <utils/task_scheduler.h>
 #include <utils/world_builder_utils.h>
 #include <geo_models/voronoi/voronoi_builder.h>
 
@@ -15,18 +19,86 @@ using vb = world_builder::Voronoi_builder;
 
 ///////////////////////////////////////////////////////////////////////
 
+world_builder::ERelax_method world_builder::Relax_method_from_name(const std::string& name)
+{
+  if (name == "lloyd")
+    return ERelax_method::ERELAX_METHOD_Lloyd;
+  if (name == "lbfgs")
+    return ERelax_method::ERELAX_METHOD_Lbfgs;
+  throw std::invalid_argument("Unknown relaxation method \"" + name + "\"");
+}
+
+///////////////////////////////////////////////////////////////////////
+
+namespace
+{
+/**
+ * @brief Keep the part of a convex polygon with min_y <= y <= max_y
+ * @param polygon The polygon, clipped in place
+ * @param min_y Lower bound
+ * @param max_y Upper bound
+ * @param scratch Scratch buffer
+ */
+void Clip_to_band(std::vector<world_builder::Point>& polygon,
+                  double min_y,
+                  double max_y,
+                  std::vector<world_builder::Point>& scratch)
+{
+  // Signed distance inside each bound in turn
+  for (int side = 0; side < 2; side++)
+  {
+    auto inside = [&](const world_builder::Point& p) { return side == 0 ? p.y - min_y : max_y - p.y; };
+    scratch.clear();
+    const size_t count = polygon.size();
+    for (size_t k = 0; k < count; k++)
+    {
+      const world_builder::Point& a = polygon[k];
+      const world_builder::Point& b = polygon[(k + 1) % count];
+      double da = inside(a);
+      double db = inside(b);
+      if (da >= 0)
+        scratch.push_back(a);
+      if ((da >= 0) != (db >= 0))
+      {
+        double t = da / (da - db);
+        scratch.push_back(world_builder::Point{a.x + t * (b.x - a.x), a.y + t * (b.y - a.y)});
+      }
+    }
+    polygon.swap(scratch);
+  }
+}
+}
+
+///////////////////////////////////////////////////////////////////////
+
 vb::Voronoi_builder(double width, double height, double scale_factor)
     : m_width(width),
     m_height(height),
     m_scale_factor(scale_factor),
-    m_cells()
+    m_site_input(scale_factor > 0 ? ESite_input::ESITE_INPUT_Scaled
+                                  : ESite_input::ESITE_INPUT_Quantized),
+    m_backend(EVoronoi_backend::EVORONOI_BACKEND_Boost),
+    m_collapsed_sites(0),
+    m_strip_count(0),
+    m_cells(),
+    m_workspace(),
+    m_strip_workspaces(),
+    m_relax_method(ERelax_method::ERELAX_METHOD_Lloyd),
+    m_relax_energy(),
+    m_relax_rebuilds(0),
+    m_locator(),
+    m_locator_stale(true),
+    m_locator_sites(),
+    m_graph(),
+    m_graph_stale(true)
 { }
 
 ///////////////////////////////////////////////////////////////////////
 
-std::vector<world_builder::Cell> vb::Build_cells(const std::vector<Point>& incoming)
+const std::vector<world_builder::Cell>& vb::Build_cells(const std::vector<Point>& incoming)
 {
-  m_cells.clear();
+  Voronoi_workspace& ws = m_workspace;
+  const bool use_strips = m_strip_count > 1;
 
   //------------------------------------------------------------------
   // 1. Detect if input is original-only or already ghost-expanded
@@ -42,216 +114,387 @@ std::vector<world_builder::Cell> vb::Build_cells(const std::vector<Point>& incom
   }
 
   //------------------------------------------------------------------
-  // 2. Rebuild ghosted point list
+  // 2. Recover originals, and for a serial build the ghosted point list.
+  // Strips pick their own ghosts.
   //------------------------------------------------------------------
-  std::vector<Point> pts;
-  std::vector<bool> is_real;
-
   if (!incoming_extended)
   {
     // Save originals in canonical order
-    m_original_points = incoming;
+    m_original_points.assign(incoming.begin(), incoming.end());
 
     // WRAP FIX:
     // Use full left+right tiling. No bounding radius heuristics.
-    pts.reserve(incoming.size() * 3);
-    is_real.reserve(incoming.size() * 3);
-
-    for (const auto& p : incoming)
-    {
-      // 1. Original
-      pts.push_back(p);
-      is_real.push_back(true);
-
-      // 2. Ghost: left tile (p.x - width)
-      pts.push_back(Point{p.x - m_width, p.y});
-      is_real.push_back(false);
-
-      // 3. Ghost: right tile (p.x + m_width)
-      pts.push_back(Point{p.x + m_width, p.y});
-      is_real.push_back(false);
-    }
+    if (!use_strips)
+      world_wrap_points(incoming, ws.points);
   }
   else
   {
     // Already extended: trust ordering (originals first)
-    pts = incoming;
-    is_real.reserve(pts.size());
-
-    for (const auto& p : pts)
-      is_real.push_back(p.x >= 0.0 && p.x < m_width);
-
-    // recover originals
     m_original_points.clear();
-    for (size_t i = 0; i < pts.size(); i++)
-      if (is_real[i])
-        m_original_points.push_back(pts[i]);
+    for (const auto& p : incoming)
+      if (p.x >= 0.0 && p.x < m_width)
+        m_original_points.push_back(p);
+
+    if (!use_strips)
+      ws.points.assign(incoming.begin(), incoming.end());
   }
 
   const size_t N = m_original_points.size();
 
   //------------------------------------------------------------------
-  // 3. Convert to scaled Boost points
+  // 3. Prepare output slots. Cells are reused in place, keeping their
+  // vertex buffers.
   //------------------------------------------------------------------
-  std::vector<point_data<double>> boost_pts;
-  boost_pts.reserve(pts.size());
+  m_cells.resize(N);
+  ws.filled.assign(N, 0);
 
-  for (const auto& p : pts)
-    boost_pts.emplace_back(p.x * m_scale_factor, p.y * m_scale_factor);
+  // Colors keyed by id, drawn in one block so a cell keeps its color through
+  // relaxation
+  ws.colors.resize(N);
+  dice::Batch_rng(dice::ERng_stream::ERNG_STREAM_Cell_colors, 0).Fill_colors(ws.colors.data(), N);
 
   //------------------------------------------------------------------
-  // 4. Build diagram
+  // 4. Build the diagram and convert its cells into polygons
   //------------------------------------------------------------------
-  voronoi_diagram<double> vd;
-  construct_voronoi(boost_pts.begin(), boost_pts.end(), &vd);
+  if (use_strips)
+  {
+    build_strips();
+  }
+  else
+  {
+    // Which entries are real, and which real site each one is
+    ws.is_real.resize(ws.points.size());
+    ws.real_index.resize(ws.points.size());
+    int real_count = 0;
+    for (size_t i = 0; i < ws.points.size(); i++)
+    {
+      ws.is_real[i] = (ws.points[i].x >= 0.0 && ws.points[i].x < m_width);
+      ws.real_index[i] = real_count;
+      real_count += ws.is_real[i];
+    }
 
-  //------------------------------------------------------------------
-  // 5. Prepare output slots
-  //------------------------------------------------------------------
-  std::vector<Cell> result(N);
-  std::vector<bool> filled(N, false);
+    build_diagram(ws);
+    collect_cells(ws, nullptr);
+  }
 
   //------------------------------------------------------------------
-  // 6. Convert Voronoi cells into polygons
+  // 5. Placeholders for sites the diagram dropped, keeping stable ordering
   //------------------------------------------------------------------
-  for (const auto& c : vd.cells())
+  m_locator_stale = true;
+  m_graph_stale = true;
+  m_collapsed_sites = 0;
+  for (size_t i = 0; i < N; i++)
   {
-    int idx = c.source_index();
-    if (idx < 0 || idx >= (int)pts.size())
-      continue;
+    if (!ws.filled[i])
+    {
+      m_collapsed_sites++;
+      Cell& c = m_cells[i];
+      c.site = m_original_points[i];
+      c.id = i;
+      c.color = ws.colors[i];
+      c.vertices.clear();
+    }
+  }
 
-    if (!is_real[idx])
-      continue;
+  return m_cells;
+}
 
-    // Determine original index
-    int real_index = 0;
-    for (int i = 0; i < idx; i++)
-      if (is_real[i])
-        real_index++;
+///////////////////////////////////////////////////////////////////////
 
-    int orig = real_index;
-    if (orig < 0 || orig >= (int)N)
-      continue;
+void vb::Set_strip_count(int strip_count)
+{
+  m_strip_count = strip_count;
+}
 
-    Cell out;
-    out.site = pts[idx];
-    out.id   = orig;
-    out.color = dice::Create_random_color();
+///////////////////////////////////////////////////////////////////////
 
-    const auto* e = c.incident_edge();
-    if (!e)
-    {
-      result[orig] = std::move(out);
-      filled[orig] = true;
-      continue;
-    }
+void vb::Set_site_input(ESite_input input)
+{
+  m_site_input = input;
+  reset_backends();
+}
 
-    const auto* start = e;
-    std::vector<Point> poly;
-    poly.reserve(16);
+///////////////////////////////////////////////////////////////////////
 
-    do
-    {
-      if (e->is_primary() && e->vertex0())
-      {
-        double vx = e->vertex0()->x() / m_scale_factor;
-        double vy = e->vertex0()->y() / m_scale_factor;
+void vb::Set_backend(EVoronoi_backend backend)
+{
+  m_backend = backend;
+  reset_backends();
+}
 
-        // VERTEX FIX: wrap ONLY horizontally into the base domain
-        if (vx < 0)      vx += m_width;
-        if (vx >= m_width) vx -= m_width;
+///////////////////////////////////////////////////////////////////////
 
-        poly.push_back(Point{vx, vy});
-      }
+void vb::Set_relax_method(ERelax_method method)
+{
+  m_relax_method = method;
+}
 
-      e = e->next();
-    }
-    while (e != start);
+///////////////////////////////////////////////////////////////////////
 
-    out.vertices = std::move(poly);
-    result[orig] = std::move(out);
-    filled[orig] = true;
-  }
+void vb::Relax_cells(int iterations)
+{
+  m_relax_energy.clear();
+  m_relax_rebuilds = 0;
+  if (m_relax_method == ERelax_method::ERELAX_METHOD_Lbfgs)
+    relax_lbfgs(iterations);
+  else
+    relax_lloyd(iterations);
+}
 
-  //------------------------------------------------------------------
-  // 7. Ensure stable ordering
-  //------------------------------------------------------------------
-  m_cells.clear();
-  m_cells.reserve(N);
+///////////////////////////////////////////////////////////////////////
 
-  for (size_t i = 0; i < N; i++)
+int vb::Locate_cell(double x, double y)
+{
+  update_locator();
+  return m_locator.Nearest(x, y);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void vb::Locate_cells(int raster_width, int raster_height, std::vector<int>& out)
+{
+  update_locator();
+  out.resize(static_cast<size_t>(raster_width) * raster_height);
+
+  const double step_x = m_width / raster_width;
+  const double step_y = m_height / raster_height;
+  world_builder::Task_scheduler::Instance().Parallel_for(0, raster_height, 1, [&](size_t row_lo, size_t row_hi)
   {
-    if (filled[i])
+    for (size_t y = row_lo; y < row_hi; y++)
     {
-      m_cells.push_back(std::move(result[i]));
+      int* row = out.data() + y * raster_width;
+      for (int x = 0; x < raster_width; x++)
+      {
+        row[x] = m_locator.Nearest(x * step_x, y * step_y);
+      }
     }
-    else
+  });
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void vb::Locate_points(const std::vector<Point>& points, std::vector<int>& out)
+{
+  update_locator();
+  out.resize(points.size());
+  world_builder::Task_scheduler::Instance().Parallel_for(0, points.size(), 1024, [&](size_t lo, size_t hi)
+  {
+    for (size_t i = lo; i < hi; i++)
     {
-      // placeholder
-      Cell c;
-      c.site = m_original_points[i];
-      c.id = i;
-      c.color = dice::Create_random_color();
-      m_cells.push_back(std::move(c));
+      out[i] = m_locator.Nearest(points[i].x, points[i].y);
     }
+  });
+}
+
+///////////////////////////////////////////////////////////////////////
+
+const world_builder::Cell_graph& vb::Get_cell_graph()
+{
+  update_graph();
+  return m_graph;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void vb::Export_PPM(const std::string& filename)
+{
+  std::vector<std::array<unsigned char, 3>> cell_colors(m_cells.size());
+  for (size_t i = 0; i < m_cells.size(); i++)
+  {
+    cell_colors[i] = m_cells[i].color;
   }
+  export_ppm(filename, cell_colors, true);
+}
 
-  return m_cells;
+///////////////////////////////////////////////////////////////////////
+
+void vb::Export_PPM(const std::string& filename,
+                    const std::vector<std::array<unsigned char, 3>>& cell_colors)
+{
+  export_ppm(filename, cell_colors, false);
 }
 
 ///////////////////////////////////////////////////////////////////////
 
-void vb::Relax_cells(int iterations)
+void vb::world_wrap_points(const std::vector<Point>& pts, std::vector<Point>& out)
 {
-  for (int step = 0; step < iterations; step++)
+  // GHOST FIX:
+  // Always generate full L + C + R horizontal tiling.
+  out.clear();
+  out.reserve(pts.size() * 3);
+
+  for (const auto& p : pts)
   {
-    std::vector<Point> wrapped = world_wrap_points(m_original_points);
-    Build_cells(wrapped);
+    // original
+    out.push_back(p);
 
-    std::vector<Point> new_orig;
-    new_orig.reserve(m_original_points.size());
+    // left tile
+    out.push_back(Point{p.x - m_width, p.y});
 
-    for (size_t i = 0; i < m_original_points.size(); i++)
-    {
-      const Cell& c = m_cells[i];
-      if (c.vertices.empty())
-      {
-        new_orig.push_back(c.site);
-        continue;
-      }
+    // right tile
+    out.push_back(Point{p.x + m_width, p.y});
+  }
+}
 
-      double sx = 0, sy = 0;
-      for (const auto& v : c.vertices)
-      {
-        double vx = v.x;
+///////////////////////////////////////////////////////////////////////
 
-        // centroid wrap relative to site
-        double dx = vx - c.site.x;
-        if (dx >  m_width * 0.5) vx -= m_width;
-        if (dx < -m_width * 0.5) vx += m_width;
+void vb::next_build_input(std::vector<Point>& out)
+{
+  // Strips pick their own ghosts, so they only need the originals
+  if (m_strip_count > 1)
+    out.assign(m_original_points.begin(), m_original_points.end());
+  else
+    world_wrap_points(m_original_points, out);
+}
 
-        sx += vx;
-        sy += v.y;
-      }
+///////////////////////////////////////////////////////////////////////
 
-      Point cen{ sx / c.vertices.size(), sy / c.vertices.size() };
+void vb::update_locator()
+{
+  if (!m_locator_stale)
+    return;
 
-      // wrap horizontally only
-      if (cen.x < 0)      cen.x += m_width;
-      if (cen.x >= m_width) cen.x -= m_width;
+  m_locator_sites.resize(m_cells.size());
+  for (size_t i = 0; i < m_cells.size(); i++)
+  {
+    m_locator_sites[i] = m_cells[i].site;
+  }
+  m_locator.Build(m_locator_sites, m_width, m_height);
+  m_locator_stale = false;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void vb::update_graph()
+{
+  if (!m_graph_stale)
+    return;
+  update_locator();
 
-      new_orig.push_back(cen);
+  // One slot per polygon edge, holding the cell across it or -1
+  const size_t N = m_cells.size();
+  std::vector<uint32_t> edge_start(N + 1, 0);
+  for (size_t i = 0; i < N; i++)
+  {
+    edge_start[i + 1] = edge_start[i] + static_cast<uint32_t>(m_cells[i].vertices.size());
+  }
+  std::vector<int> across(edge_start[N], -1);
+
+  // A true mirror image lands on its site up to rounding; any other site is
+  // about a spacing away
+  const double spacing = std::sqrt(m_width * m_height / std::max<size_t>(1, N));
+  const double tolerance2 = (0.25 * spacing) * (0.25 * spacing);
+  world_builder::Task_scheduler::Instance().Parallel_for(0, N, 256, [&](size_t lo, size_t hi)
+  {
+    for (size_t i = lo; i < hi; i++)
+    {
+      const Cell& c = m_cells[i];
+      const size_t count = c.vertices.size();
+      for (size_t k = 0; k < count; k++)
+      {
+        // Edge ends relative to the site, unwrapped across the seam
+        Point ends[2];
+        for (int e = 0; e < 2; e++)
+        {
+          const Point& v = c.vertices[(k + e) % count];
+          double dx = v.x - c.site.x;
+          if (dx >  m_width * 0.5) dx -= m_width;
+          if (dx < -m_width * 0.5) dx += m_width;
+          ends[e] = Point{dx, v.y - c.site.y};
+        }
+        const double ex = ends[1].x - ends[0].x;
+        const double ey = ends[1].y - ends[0].y;
+        const double length2 = ex*ex + ey*ey;
+        if (length2 <= 0)
+          continue;
+
+        // Cells along the top and bottom edges reach far past the map, and
+        // only meet where their shared edge is on it
+        if (std::max(ends[0].y, ends[1].y) < -c.site.y ||
+            std::min(ends[0].y, ends[1].y) > m_height - c.site.y)
+          continue;
+
+        // Twice the foot of the perpendicular from the site to the edge
+        const double t = -(ends[0].x * ex + ends[0].y * ey) / length2;
+        const double mirror_x = c.site.x + 2.0 * (ends[0].x + t * ex);
+        const double mirror_y = c.site.y + 2.0 * (ends[0].y + t * ey);
+        const int j = m_locator.Nearest(mirror_x, mirror_y);
+        if (j < 0 || static_cast<size_t>(j) == i)
+          continue;
+
+        double dx = std::abs(m_locator_sites[j].x - mirror_x);
+        dx = std::fmod(dx, m_width);
+        dx = std::min(dx, m_width - dx);
+        const double dy = m_locator_sites[j].y - mirror_y;
+        if (dx*dx + dy*dy <= tolerance2)
+          across[edge_start[i] + k] = j;
+      }
     }
+  });
 
-    m_original_points = std::move(new_orig);
+  // Count every link from both ends, so a link only one side found still
+  // reads the same from the other
+  std::vector<uint32_t>& start = m_graph.neighbor_start;
+  std::vector<int>& neighbors = m_graph.neighbors;
+  start.assign(N + 1, 0);
+  for (size_t i = 0; i < N; i++)
+  {
+    for (uint32_t k = edge_start[i]; k < edge_start[i + 1]; k++)
+    {
+      if (across[k] < 0)
+        continue;
+      start[i + 1]++;
+      start[across[k] + 1]++;
+    }
+  }
+  for (size_t i = 0; i < N; i++)
+  {
+    start[i + 1] += start[i];
+  }
+  neighbors.resize(start[N]);
+  std::vector<uint32_t> next(start.begin(), start.end() - 1);
+  for (size_t i = 0; i < N; i++)
+  {
+    for (uint32_t k = edge_start[i]; k < edge_start[i + 1]; k++)
+    {
+      if (across[k] < 0)
+        continue;
+      neighbors[next[i]++] = across[k];
+      neighbors[next[across[k]]++] = static_cast<int>(i);
+    }
   }
 
-  Build_cells(world_wrap_points(m_original_points));
+  // Sort each cell's list and drop the repeats, compacting in place
+  world_builder::Task_scheduler::Instance().Parallel_for(0, N, 1024, [&](size_t lo, size_t hi)
+  {
+    for (size_t i = lo; i < hi; i++)
+    {
+      auto first = neighbors.begin() + start[i];
+      auto last = neighbors.begin() + start[i + 1];
+      std::sort(first, last);
+      next[i] = start[i] + static_cast<uint32_t>(std::unique(first, last) - first);
+    }
+  });
+  uint32_t write = 0;
+  for (size_t i = 0; i < N; i++)
+  {
+    const uint32_t read = start[i];
+    const uint32_t end = next[i];
+    start[i] = write;
+    for (uint32_t k = read; k < end; k++)
+    {
+      neighbors[write++] = neighbors[k];
+    }
+  }
+  start[N] = write;
+  neighbors.resize(write);
+  m_graph_stale = false;
 }
 
 ///////////////////////////////////////////////////////////////////////
 
-void vb::Export_PPM(const std::string& filename)
+bool vb::Render(const std::vector<std::array<unsigned char, 3>>& cell_colors,
+                std::vector<std::array<unsigned char, 3>>& image)
 {
   int img_width  = static_cast<int>(m_width);
   int img_height = static_cast<int>(m_height);
@@ -259,45 +502,47 @@ void vb::Export_PPM(const std::string& filename)
   if (img_width <= 0 || img_height <= 0)
   {
     std::cerr << "PPM export: invalid image dimensions\n";
-    return;
+    return false;
   }
 
-  if (m_cells.empty())
+  if (m_cells.empty() || cell_colors.size() != m_cells.size())
   {
     std::cerr << "PPM export: no Voronoi cells to draw\n";
-    return;
+    return false;
   }
 
-  // Image buffer (black)
-  std::vector<std::vector<std::array<unsigned char, 3>>> image(
-      img_height,
-      std::vector<std::array<unsigned char, 3>>(img_width, {0,0,0})
-      );
+  // Image buffer, row major
+  image.resize(static_cast<size_t>(img_width) * img_height);
 
   // --- nearest-site fill ----------------------------------------------------
-  for (int y = 0; y < img_height; ++y)
+  // Pixels across the seam take the color of the cell wrapping over it
+  std::vector<int> pixel_cells;
+  Locate_cells(img_width, img_height, pixel_cells);
+  world_builder::Task_scheduler::Instance().Parallel_for(0, img_height, 1, [&](size_t row_lo, size_t row_hi)
   {
-    for (int x = 0; x < img_width; ++x)
+    for (size_t y = row_lo; y < row_hi; ++y)
     {
-      double min_dist = std::numeric_limits<double>::max();
-      size_t nearest = 0;
-
-      for (size_t i = 0; i < m_cells.size(); ++i)
+      for (int x = 0; x < img_width; ++x)
       {
-        double dx = m_cells[i].site.x - x;
-        double dy = m_cells[i].site.y - y;
-        double d2 = dx*dx + dy*dy;
-
-        if (d2 < min_dist)
-        {
-          min_dist = d2;
-          nearest = i;
-        }
+        image[y * img_width + x] = cell_colors[pixel_cells[y * img_width + x]];
       }
-
-      image[y][x] = m_cells[nearest].color;
     }
-  }
+  });
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void vb::export_ppm(const std::string& filename,
+                    const std::vector<std::array<unsigned char, 3>>& cell_colors,
+                    bool draw_sites)
+{
+  std::vector<std::array<unsigned char, 3>> image;
+  if (!Render(cell_colors, image))
+    return;
+
+  int img_width  = static_cast<int>(m_width);
+  int img_height = static_cast<int>(m_height);
 
   // --- draw Poisson sites on top --------------------------------------------
   auto draw_point = [&](int cx,
@@ -320,7 +565,7 @@ void vb::Export_PPM(const std::string& filename)
         if (px >= 0 && px < img_width &&
             py >= 0 && py < img_height)
         {
-          image[py][px] = {r, g, b};
+          image[py * img_width + px] = {r, g, b};
         }
       }
     }
@@ -332,57 +577,474 @@ void vb::Export_PPM(const std::string& filename)
 
   for (const auto& cell : m_cells)
   {
-    draw_point(
-        static_cast<int>(cell.site.x),
-        static_cast<int>(cell.site.y),
-        point_radius,
-        PR, PG, PB
-        );
+    if (draw_sites)
+    {
+      draw_point(
+          static_cast<int>(cell.site.x),
+          static_cast<int>(cell.site.y),
+          point_radius,
+          PR, PG, PB
+          );
+    }
   }
 
   // --- write PPM -------------------------------------------------------------
-  std::ofstream ofs(filename, std::ios::out);
-  if (!ofs)
+  world_builder::Write_ppm(filename, img_width, img_height, image);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void vb::reset_backends()
+{
+  m_workspace.backend.reset();
+  for (auto& strip_ws : m_strip_workspaces)
+    strip_ws.backend.reset();
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void vb::build_diagram(Voronoi_workspace& ws)
+{
+  if (!ws.backend)
+    ws.backend = Make_voronoi_backend(m_backend, m_site_input, m_scale_factor);
+
+  ws.backend->Prepare(m_width, m_height, m_original_points.size());
+  ws.backend->Build(ws.points, ws.is_real, ws.diagram);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+bool vb::collect_cells(Voronoi_workspace& ws, const Strip_window* window)
+{
+  const std::vector<std::array<unsigned char, 3>>& colors = m_workspace.colors;
+  std::vector<unsigned char>& filled = m_workspace.filled;
+  const int N = static_cast<int>(m_original_points.size());
+  bool exact = true;
+
+  const Flat_diagram& diagram = ws.diagram;
+  for (size_t idx = 0; idx < ws.points.size(); idx++)
   {
-    world_builder::Print_to_cout("PPM export: failed to open file " + filename);
-    return;
+    if (!ws.is_real[idx] || !diagram.has_cell[idx])
+      continue;
+
+    // Determine original index
+    int orig = ws.real_index[idx];
+    if (orig < 0 || orig >= N)
+      continue;
+
+    Cell& out = m_cells[orig];
+    out.site = ws.points[idx];
+    out.id   = orig;
+    out.color = colors[orig];
+    out.vertices.clear();
+    filled[orig] = 1;
+
+    // Only interior cells, bounded and with every vertex on the map, are
+    // checked: hull cells have unbounded edges, and cells along the top and
+    // bottom edges have vertices from near-collinear edge sites, both of
+    // which depend on sites anywhere along that edge
+    bool interior = diagram.bounded[idx];
+    bool within_window = true;
+    for (uint32_t k = diagram.cell_start[idx]; k < diagram.cell_start[idx + 1]; k++)
+    {
+      double vx = diagram.vertices[k].x;
+      double vy = diagram.vertices[k].y;
+
+      // A vertex is exact if no site left out of the window could be
+      // inside its empty circle
+      if (window)
+      {
+        double dx = vx - out.site.x;
+        double dy = vy - out.site.y;
+        double radius = std::sqrt(dx*dx + dy*dy);
+        interior &= (vy >= 0.0 && vy < m_height);
+        within_window &= (vx - radius >= window->min_x && vx + radius <= window->max_x);
+      }
+
+      // VERTEX FIX: wrap ONLY horizontally into the base domain
+      if (vx < 0)      vx += m_width;
+      if (vx >= m_width) vx -= m_width;
+
+      out.vertices.push_back(Point{vx, vy});
+    }
+
+    exact &= !interior || within_window;
+
+    // Start every polygon at its lowest vertex, so it doesn't depend on
+    // where the backend starts the cell and centroids sum in the same order
+    // whichever diagram the cell came from
+    auto first = std::min_element(out.vertices.begin(), out.vertices.end(),
+                                  [](const Point& a, const Point& b)
+                                  {
+                                    return a.y < b.y || (a.y == b.y && a.x < b.x);
+                                  });
+    std::rotate(out.vertices.begin(), first, out.vertices.end());
+  }
+
+  return exact;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void vb::build_strips()
+{
+  const size_t N = m_original_points.size();
+  const double spacing = std::sqrt(m_width * m_height / std::max<size_t>(1, N));
+
+  // Originals sorted by x, so each strip finds its window by binary search
+  std::vector<int>& x_order = m_workspace.x_order;
+  x_order.resize(N);
+  for (size_t i = 0; i < N; i++)
+  {
+    x_order[i] = static_cast<int>(i);
+  }
+  std::sort(x_order.begin(), x_order.end(), [&](int a, int b)
+  {
+    return m_original_points[a].x < m_original_points[b].x;
+  });
+
+  if (m_strip_workspaces.size() < static_cast<size_t>(m_strip_count))
+  {
+    m_strip_workspaces.resize(m_strip_count);
   }
+  world_builder::Task_scheduler::Instance().Parallel_for(0, m_strip_count, 1, [&](size_t lo, size_t hi)
+  {
+    for (size_t strip = lo; strip < hi; strip++)
+    {
+      build_strip(static_cast<int>(strip), spacing);
+    }
+  });
+}
 
-  ofs << "P3\n" << img_width << " " << img_height << "\n255\n";
-  for (int y = 0; y < img_height; ++y)
+///////////////////////////////////////////////////////////////////////
+
+void vb::build_strip(int strip, double spacing)
+{
+  Voronoi_workspace& ws = m_strip_workspaces[strip];
+  const std::vector<int>& x_order = m_workspace.x_order;
+  const double core_min = m_width * strip / m_strip_count;
+  const double core_max = m_width * (strip + 1) / m_strip_count;
+
+  // Originals with lo <= x < hi, shifted by `shift`
+  auto add_range = [&](double lo, double hi, double shift)
   {
-    for (int x = 0; x < img_width; ++x)
+    auto by_x = [&](int index, double x) { return m_original_points[index].x < x; };
+    auto first = std::lower_bound(x_order.begin(), x_order.end(), lo, by_x);
+    auto last = std::lower_bound(first, x_order.end(), hi, by_x);
+    for (auto it = first; it != last; ++it)
     {
-      auto& c = image[y][x];
-      ofs << int(c[0]) << " " << int(c[1]) << " " << int(c[2]) << " ";
+      const Point& p = m_original_points[*it];
+      ws.points.push_back(Point{p.x + shift, p.y});
+      ws.is_real.push_back(shift == 0.0 && p.x >= core_min && p.x < core_max);
+      ws.real_index.push_back(*it);
     }
-    ofs << "\n";
+  };
+
+  // Widen the window until every core cell is provably the one the full
+  // build would give; at a full map width either side it is as good as the
+  // serial build
+  double margin = STRIP_MARGIN_SPACINGS * spacing;
+  while (true)
+  {
+    margin = std::min(margin, m_width);
+    Strip_window window{core_min - margin, core_max + margin};
+
+    ws.points.clear();
+    ws.is_real.clear();
+    ws.real_index.clear();
+    if (window.min_x < 0.0)
+      add_range(window.min_x + m_width, m_width, -m_width);
+    add_range(std::max(0.0, window.min_x), std::min(m_width, window.max_x), 0.0);
+    if (window.max_x > m_width)
+      add_range(0.0, window.max_x - m_width, m_width);
+
+    build_diagram(ws);
+    if (collect_cells(ws, &window) || margin >= m_width)
+      break;
+    margin *= 2;
   }
-  ofs.close();
 }
 
 ///////////////////////////////////////////////////////////////////////
 
-std::vector<world_builder::Point> vb::world_wrap_points(const std::vector<Point>& pts)
+void vb::relax_lloyd(int iterations)
 {
-  // GHOST FIX:
-  // Always generate full L + C + R horizontal tiling.
-  std::vector<Point> out;
-  out.reserve(pts.size() * 3);
+  Voronoi_workspace& ws = m_workspace;
+  for (int step = 0; step < iterations; step++)
+  {
+    m_relax_energy.push_back(rebuild());
 
-  for (const auto& p : pts)
+    ws.relaxed.resize(m_original_points.size());
+
+    // Every centroid only reads its own cell, so cells are independent, and
+    // each cell sums its vertices in polygon order so the centroid is the
+    // same on any number of threads
+    world_builder::Task_scheduler::Instance().Parallel_for(0, m_original_points.size(), 0,
+                                                           [&](size_t lo, size_t hi)
+    {
+      for (size_t i = lo; i < hi; i++)
+      {
+        const Cell& c = m_cells[i];
+        if (c.vertices.empty())
+        {
+          ws.relaxed[i] = c.site;
+          continue;
+        }
+
+        double sx = 0, sy = 0;
+        for (const auto& v : c.vertices)
+        {
+          double vx = v.x;
+
+          // centroid wrap relative to site
+          double dx = vx - c.site.x;
+          if (dx >  m_width * 0.5) vx -= m_width;
+          if (dx < -m_width * 0.5) vx += m_width;
+
+          sx += vx;
+          sy += v.y;
+        }
+
+        Point cen{ sx / c.vertices.size(), sy / c.vertices.size() };
+
+        // wrap horizontally only
+        if (cen.x < 0)      cen.x += m_width;
+        if (cen.x >= m_width) cen.x -= m_width;
+
+        ws.relaxed[i] = cen;
+      }
+    });
+
+    // Swap rather than move, so both buffers survive for the next pass
+    m_original_points.swap(ws.relaxed);
+  }
+
+  m_relax_energy.push_back(rebuild());
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void vb::relax_lbfgs(int iterations)
+{
+  Voronoi_workspace& ws = m_workspace;
+  const size_t n = 2 * m_original_points.size();
+
+  double energy = rebuild();
+  m_relax_energy.push_back(energy);
+
+  ws.direction.resize(n);
+  ws.step_s.resize(LBFGS_MEMORY);
+  ws.step_y.resize(LBFGS_MEMORY);
+  for (int m = 0; m < LBFGS_MEMORY; m++)
   {
-    // original
-    out.push_back(p);
+    ws.step_s[m].resize(n);
+    ws.step_y[m].resize(n);
+  }
+  ws.step_rho.assign(LBFGS_MEMORY, 0.0);
+  ws.step_alpha.assign(LBFGS_MEMORY, 0.0);
+  int stored = 0;
+  int newest = LBFGS_MEMORY - 1;
+
+  // Flattened views of the per-site vectors
+  auto gradient_at = [](const std::vector<Point>& g, size_t k) { return (k & 1) ? g[k / 2].y : g[k / 2].x; };
+  auto inverse_hessian_at = [](const std::vector<double>& area, size_t k)
+  {
+    return area[k / 2] > 0 ? 0.5 / area[k / 2] : 0.0;
+  };
+  auto dot = [n](const std::vector<double>& a, const std::vector<double>& b)
+  {
+    double sum = 0;
+    for (size_t k = 0; k < n; k++)
+      sum += a[k] * b[k];
+    return sum;
+  };
 
-    // left tile
-    out.push_back(Point{p.x - m_width, p.y});
+  std::vector<double>& d = ws.direction;
+  for (int step = 0; step < iterations; step++)
+  {
+    // Two-loop recursion for d = -H g, newest pair first
+    for (size_t k = 0; k < n; k++)
+      d[k] = gradient_at(ws.gradient, k);
+    for (int j = 0; j < stored; j++)
+    {
+      int m = (newest - j + LBFGS_MEMORY) % LBFGS_MEMORY;
+      ws.step_alpha[m] = ws.step_rho[m] * dot(ws.step_s[m], d);
+      for (size_t k = 0; k < n; k++)
+        d[k] -= ws.step_alpha[m] * ws.step_y[m][k];
+    }
+    for (size_t k = 0; k < n; k++)
+      d[k] *= inverse_hessian_at(ws.area, k);
+    for (int j = stored - 1; j >= 0; j--)
+    {
+      int m = (newest - j + LBFGS_MEMORY) % LBFGS_MEMORY;
+      double beta = ws.step_rho[m] * dot(ws.step_y[m], d);
+      for (size_t k = 0; k < n; k++)
+        d[k] += (ws.step_alpha[m] - beta) * ws.step_s[m][k];
+    }
 
-    // right tile
-    out.push_back(Point{p.x + m_width, p.y});
+    double slope = 0;
+    for (size_t k = 0; k < n; k++)
+    {
+      d[k] = -d[k];
+      slope += gradient_at(ws.gradient, k) * d[k];
+    }
+
+    // Not a descent direction: forget the history and take a Lloyd step
+    if (!(slope < 0))
+    {
+      stored = 0;
+      slope = 0;
+      for (size_t k = 0; k < n; k++)
+      {
+        d[k] = -inverse_hessian_at(ws.area, k) * gradient_at(ws.gradient, k);
+        slope += gradient_at(ws.gradient, k) * d[k];
+      }
+    }
+
+    ws.start_points.assign(m_original_points.begin(), m_original_points.end());
+    ws.start_gradient.assign(ws.gradient.begin(), ws.gradient.end());
+    ws.start_area.assign(ws.area.begin(), ws.area.end());
+
+    // Backtrack until the energy drops enough (Armijo)
+    const int slot = (newest + 1) % LBFGS_MEMORY;
+    std::vector<double>& s = ws.step_s[slot];
+    double next_energy = energy;
+    bool accepted = false;
+    double alpha = 1.0;
+    for (int halving = 0; halving <= LBFGS_MAX_HALVINGS && !accepted; halving++, alpha *= 0.5)
+    {
+      take_step(alpha, s);
+      next_energy = rebuild();
+      accepted = next_energy <= energy + 1e-4 * alpha * slope;
+    }
+
+    if (!accepted)
+    {
+      stored = 0;
+      for (size_t k = 0; k < n; k++)
+        d[k] = -inverse_hessian_at(ws.start_area, k) * gradient_at(ws.start_gradient, k);
+      take_step(1.0, s);
+      next_energy = rebuild();
+    }
+
+    // Keep the pair only if it has positive curvature, so H stays positive
+    // definite
+    std::vector<double>& y = ws.step_y[slot];
+    for (size_t k = 0; k < n; k++)
+      y[k] = gradient_at(ws.gradient, k) - gradient_at(ws.start_gradient, k);
+    double curvature = dot(s, y);
+    if (curvature > 0)
+    {
+      ws.step_rho[slot] = 1.0 / curvature;
+      newest = slot;
+      stored = std::min(stored + 1, LBFGS_MEMORY);
+    }
+
+    energy = next_energy;
+    m_relax_energy.push_back(energy);
   }
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void vb::take_step(double alpha, std::vector<double>& step)
+{
+  Voronoi_workspace& ws = m_workspace;
+  const double max_y = std::nextafter(m_height, 0.0);
+  world_builder::Task_scheduler::Instance().Parallel_for(0, m_original_points.size(), 0,
+                                                         [&](size_t lo, size_t hi)
+  {
+    for (size_t i = lo; i < hi; i++)
+    {
+      const Point& start = ws.start_points[i];
+      double x = start.x + alpha * ws.direction[2 * i];
+      double y = std::clamp(start.y + alpha * ws.direction[2 * i + 1], 0.0, max_y);
+      step[2 * i] = x - start.x;
+      step[2 * i + 1] = y - start.y;
+
+      // wrap horizontally only
+      x -= m_width * std::floor(x / m_width);
+      if (x >= m_width) x = 0.0;
+      m_original_points[i] = Point{x, y};
+    }
+  });
+}
 
-  return out;
+///////////////////////////////////////////////////////////////////////
+
+double vb::rebuild()
+{
+  Voronoi_workspace& ws = m_workspace;
+  next_build_input(ws.wrapped);
+  Build_cells(ws.wrapped);
+  m_relax_rebuilds++;
+  return measure_cells();
+}
+
+///////////////////////////////////////////////////////////////////////
+
+double vb::measure_cells()
+{
+  Voronoi_workspace& ws = m_workspace;
+  const size_t N = m_cells.size();
+  ws.area.resize(N);
+  ws.gradient.resize(N);
+
+  // Cells are independent; the energy folds in index order
+  return world_builder::Task_scheduler::Instance().Parallel_reduce(
+      0, N, 0, 0.0,
+      [&](size_t lo, size_t hi, double energy)
+      {
+        std::vector<Point> polygon;
+        std::vector<Point> clipped;
+        for (size_t i = lo; i < hi; i++)
+        {
+          const Cell& c = m_cells[i];
+          ws.area[i] = 0.0;
+          ws.gradient[i] = Point{0.0, 0.0};
+
+          // Vertices relative to the site, unwrapped across the seam
+          polygon.clear();
+          for (const auto& v : c.vertices)
+          {
+            double dx = v.x - c.site.x;
+            if (dx >  m_width * 0.5) dx -= m_width;
+            if (dx < -m_width * 0.5) dx += m_width;
+            polygon.push_back(Point{dx, v.y - c.site.y});
+          }
+
+          // Keep the part on the map: cells along the top and bottom edges
+          // reach far past it
+          Clip_to_band(polygon, -c.site.y, m_height - c.site.y, clipped);
+          const size_t count = polygon.size();
+          if (count < 3)
+            continue;
+
+          // Area, first moment and polar moment about the site, summed over
+          // the triangles the site makes with each edge
+          double area = 0, mx = 0, my = 0, inertia = 0;
+          for (size_t k = 0; k < count; k++)
+          {
+            const Point& a = polygon[k];
+            const Point& b = polygon[(k + 1) % count];
+            double cross = a.x * b.y - b.x * a.y;
+            area += cross;
+            mx += (a.x + b.x) * cross;
+            my += (a.y + b.y) * cross;
+            inertia += cross * (a.x * a.x + a.y * a.y + a.x * b.x + a.y * b.y + b.x * b.x + b.y * b.y);
+          }
+          area *= 0.5;
+          if (area <= 0)
+            continue;
+
+          // Centroid is site + (mx, my) / (6 A), so 2 A (p - c) = -(mx, my) / 3
+          ws.area[i] = area;
+          ws.gradient[i] = Point{-mx / 3.0, -my / 3.0};
+          energy += inertia / 12.0;
+        }
+        return energy;
+      },
+      [](double a, double b) { return a + b; });
 }
 
 ///////////////////////////////////////////////////////////////////////
@@ -6,21 +6,23 @@
 #define VORONOI_BUILDER_H
 
 // Standard libs
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
 
-// Boost Polygon
-#include <boost/polygon/voronoi.hpp>
-#include <boost/polygon/point_data.hpp>
-
 // Application files
 #include <defs/dice_rolls.h>
+#include <geo_models/voronoi/cell_graph.h>
+#include <geo_models/voronoi/cell_locator.h>
 #include <geo_models/voronoi/poisson_disc.h>
+#include <geo_models/voronoi/voronoi_backend.h>
 
 namespace world_builder
 {
 
-using namespace boost::polygon;
-
 /**
  * @brief Voronoi cell representation
  */
@@ -60,7 +62,107 @@ struct Cell
 };
 
 /**
- * @brief Wrapper class around Boost.Polygon Voronoi generation
+ * @brief How Relax_cells moves sites toward a centroidal Voronoi tessellation
+ */
+enum class ERelax_method : uint8_t
+{
+  ERELAX_METHOD_Lloyd,  ///< Every site to the mean of its cell's vertices
+  ERELAX_METHOD_Lbfgs,  ///< L-BFGS on the CVT energy, preconditioned by cell areas
+  ERELAX_METHOD_Count   ///< Size of options enum
+};
+
+/**
+ * @brief Relaxation method named in a config file
+ * @param name "lloyd" or "lbfgs"
+ * @return The method
+ * @throws std::invalid_argument For any other name
+ */
+ERelax_method Relax_method_from_name(const std::string& name);
+
+/**
+ * @brief Scratch buffers for building a diagram, kept between Build_cells
+ * calls
+ * @details Every buffer is cleared rather than freed, so after the first
+ * build it already has the capacity the next one needs: a relaxation loop
+ * over a fixed point count stops allocating for these after its first pass.
+ * The backend keeps its own scratch storage the same way.
+ */
+struct Voronoi_workspace
+{
+  /**
+   * @brief Sites with their wrap ghosts, and whether each is a real site
+   * whose cell belongs in the output
+   */
+  std::vector<Point> points;
+  std::vector<unsigned char> is_real;
+
+  /**
+   * @brief For each entry of `points`, the index of the original site it
+   * is; for a full build, the number of real sites before it
+   */
+  std::vector<int> real_index;
+
+  /**
+   * @brief Original sites sorted by x, for finding strip windows
+   */
+  std::vector<int> x_order;
+
+  /**
+   * @brief Sites with ghosts for the next build, written by Relax_cells
+   */
+  std::vector<Point> wrapped;
+
+  /**
+   * @brief Relaxed site positions, swapped with the originals each pass
+   */
+  std::vector<Point> relaxed;
+
+  /**
+   * @brief Area of each cell and the gradient of the CVT energy with respect
+   * to its site, from the last measure
+   */
+  std::vector<double> area;
+  std::vector<Point> gradient;
+
+  /**
+   * @brief L-BFGS state, site coordinates flattened as x0, y0, x1, y1, ...:
+   * the search direction, the sites, gradient and cell areas the current
+   * step started from, and the last few steps and gradient changes with
+   * 1 / (y . s)
+   */
+  std::vector<double> direction;
+  std::vector<Point> start_points;
+  std::vector<Point> start_gradient;
+  std::vector<double> start_area;
+  std::vector<std::vector<double>> step_s;
+  std::vector<std::vector<double>> step_y;
+  std::vector<double> step_rho;
+  std::vector<double> step_alpha;
+
+  /**
+   * @brief Whether each output cell was produced by the diagram
+   */
+  std::vector<unsigned char> filled;
+
+  /**
+   * @brief Cell colors keyed by id
+   */
+  std::vector<std::array<unsigned char, 3>> colors;
+
+  /**
+   * @brief The diagram of `points`
+   */
+  Flat_diagram diagram;
+
+  /**
+   * @brief What builds the diagram, created on first use
+   */
+  std::unique_ptr<Voronoi_backend> backend;
+};
+
+/**
+ * @brief Builds Voronoi cells of map sites, wrapped east to west, on a
+ * choice of backend
  */
 class Voronoi_builder
 {
@@ -72,31 +174,174 @@ public:
    * @brief Construct with given width/height for scaling points
    * @param width Map width
    * @param height Map height
-   * @param scale_factor Conversion factor from floating to integer
+   * @param scale_factor Conversion factor from floating to integer; 0 or
+   * less selects quantized input with an automatic scale
    */
   Voronoi_builder(double width, double height, double scale_factor);
 
   /**
    * @brief Build Voronoi cells from given points
    * @param points Input points
-   * @return Vector of Voronoi cells
+   * @return Vector of Voronoi cells, valid until the next build
+   */
+  const std::vector<Cell>& Build_cells(const std::vector<Point>& points);
+
+  /**
+   * @brief Split builds into vertical strips, built in parallel
+   * @details Each strip builds the diagram of its own sites plus a margin of
+   * neighbors a few site spacings wide, and keeps the cells whose sites are
+   * in the strip. The margin is widened until every kept cell is provably
+   * the one a full build gives, so all interior cells match the serial
+   * build. Cells on the top or bottom hull have unbounded edges whose
+   * presence depends on distant sites, and may differ. No strip ever holds
+   * the whole ghosted point set.
+   * @param strip_count Number of strips; 0 or 1 builds the whole map at once
+   */
+  void Set_strip_count(int strip_count);
+
+  /**
+   * @brief Choose how sites are converted for Boost; takes effect on the next
+   * build
+   * @param input The conversion
+   */
+  void Set_site_input(ESite_input input);
+
+  /**
+   * @brief Choose what builds the diagram; takes effect on the next build
+   * @param backend The backend
    */
-  std::vector<Cell> Build_cells(const std::vector<Point>& points);
+  void Set_backend(EVoronoi_backend backend);
 
   /**
-   * @brief Perform Lloyd relaxation on the current Voronoi cells
-   * @param iterations Number of iterations to run (1–3 is typical)
+   * @brief Real sites that got no cell of their own in the last build,
+   * having landed on the same position as another site
+   */
+  size_t Get_collapsed_sites() const { return m_collapsed_sites; }
+
+  /**
+   * @brief The cells of the last build or relaxation
+   */
+  const std::vector<Cell>& Get_cells() const { return m_cells; }
+
+  /**
+   * @brief Choose how Relax_cells moves the sites
+   * @param method The method
+   */
+  void Set_relax_method(ERelax_method method);
+
+  /**
+   * @brief Relax the current Voronoi cells toward a centroidal tessellation
+   * @param iterations Number of iterations to run (1–3 is typical for
+   * Lloyd); an L-BFGS iteration may rebuild the diagram more than once
    */
   void Relax_cells(int iterations = 1);
 
+  /**
+   * @brief CVT energy, the sum over cells of the integral over the map of
+   * the squared distance to the site, before the last Relax_cells call and after each
+   * of its iterations
+   */
+  const std::vector<double>& Get_relax_energy() const { return m_relax_energy; }
+
+  /**
+   * @brief Diagram builds done by the last Relax_cells call
+   */
+  size_t Get_relax_rebuilds() const { return m_relax_rebuilds; }
+
+  /**
+   * @brief Cell containing a map position, i.e. the one with the nearest
+   * site, with the map wrapping east to west. The first query after a build
+   * indexes the sites, so don't make it from several threads at once.
+   * @param x Map x, wrapped onto the map
+   * @param y Map y
+   * @return Index into the cells, -1 if there are none
+   */
+  int Locate_cell(double x, double y);
+
+  /**
+   * @brief Cell containing each pixel of a raster stretched over the map,
+   * pixel (i, j) sitting at map position (i * width / raster_width,
+   * j * height / raster_height). Rows are located in parallel.
+   * @param raster_width Raster width
+   * @param raster_height Raster height
+   * @param out Cell index of each pixel, row by row; existing contents are
+   * replaced
+   */
+  void Locate_cells(int raster_width, int raster_height, std::vector<int>& out);
+
+  /**
+   * @brief Cell containing each of a batch of map positions, located in
+   * parallel
+   * @param points Map positions, x wrapped onto the map
+   * @param out Cell index of each position; existing contents are replaced
+   */
+  void Locate_points(const std::vector<Point>& points, std::vector<int>& out);
+
+  /**
+   * @brief Which current cells share an edge. The first call after a build
+   * derives it, so don't make it from several threads at once.
+   * @details A cell's neighbor across one of its edges is the site that is
+   * the mirror image of its own across that edge, found with the point
+   * locator, so any backend and strip builds give the same graph. Edges
+   * entirely off the top or bottom of the map, and edges that mirror onto
+   * no site, like the closing edge of a cell on the top or bottom hull, are
+   * not links.
+   * @return The graph, valid until the next build
+   */
+  const Cell_graph& Get_cell_graph();
+
+  /**
+   * @brief Draw the cells in given colors at one pixel per map unit, for
+   * drawing more on top before writing it out
+   * @param cell_colors One color per cell
+   * @param image Filled row by row; existing contents are replaced
+   * @return False, with nothing drawn, if there are no cells to draw
+   */
+  bool Render(const std::vector<std::array<unsigned char, 3>>& cell_colors,
+              std::vector<std::array<unsigned char, 3>>& image);
+
   /**
    * @brief Export a simple PPM image of the Voronoi cells
    * @param filename Output filename
    */
   void Export_PPM(const std::string& filename);
 
+  /**
+   * @brief Export a PPM image of the cells in given colors, without the
+   * site markers, e.g. to show per-cell data
+   * @param filename Output filename
+   * @param cell_colors One color per cell
+   */
+  void Export_PPM(const std::string& filename,
+                  const std::vector<std::array<unsigned char, 3>>& cell_colors);
+
 private:
   // Attributes
+  /**
+   * @brief L-BFGS steps remembered
+   */
+  static constexpr int LBFGS_MEMORY = 7;
+
+  /**
+   * @brief Times an L-BFGS step is halved before falling back to a Lloyd
+   * step
+   */
+  static constexpr int LBFGS_MAX_HALVINGS = 3;
+
+  /**
+   * @brief Initial strip margin, in typical site spacings
+   */
+  static constexpr double STRIP_MARGIN_SPACINGS = 4.0;
+
+  /**
+   * @brief The x range of sites a strip builds from
+   */
+  struct Strip_window
+  {
+    double min_x;
+    double max_x;
+  };
+
   /**
    * @brief Map width
    */
@@ -117,16 +362,76 @@ private:
    */
   double m_scale_factor;
 
+  /**
+   * @brief How sites are converted for Boost
+   */
+  ESite_input m_site_input;
+
+  /**
+   * @brief What builds the diagram
+   */
+  EVoronoi_backend m_backend;
+
+  /**
+   * @brief Real sites without a cell in the last build
+   */
+  size_t m_collapsed_sites;
+
+  /**
+   * @brief Number of strips for parallel builds, 0 or 1 for a full build
+   */
+  int m_strip_count;
+
   /**
    * @brief Vector of original Poisson disc points
    */
   std::vector<Point> m_original_points;
 
   /**
-   * @brief The generated cells
+   * @brief The generated cells. Rebuilt in place, so each cell's vertex
+   * buffer is reused by the next build.
    */
   std::vector<Cell> m_cells;
 
+  /**
+   * @brief Scratch buffers reused by every build
+   */
+  Voronoi_workspace m_workspace;
+
+  /**
+   * @brief Scratch buffers of each strip, reused by every strip build
+   */
+  std::vector<Voronoi_workspace> m_strip_workspaces;
+
+  /**
+   * @brief How Relax_cells moves the sites
+   */
+  ERelax_method m_relax_method;
+
+  /**
+   * @brief Energy history and diagram builds of the last Relax_cells call
+   */
+  std::vector<double> m_relax_energy;
+  size_t m_relax_rebuilds;
+
+  /**
+   * @brief Point location index over the cell sites, and whether it
+   * predates the last build
+   */
+  Cell_locator m_locator;
+  bool m_locator_stale;
+
+  /**
+   * @brief Sites of the current cells, as indexed by m_locator
+   */
+  std::vector<Point> m_locator_sites;
+
+  /**
+   * @brief Cell adjacency, and whether it predates the last build
+   */
+  Cell_graph m_graph;
+  bool m_graph_stale;
+
   /**
    * @brief Every point placed must be at least `m_radius` units away from all
    * other points.
@@ -142,9 +447,113 @@ private:
    * 1. Full voronoi polygon creation of edge cells
    * 2. Smooth transition across the map boundary for adjacent cells
    * @param points The full Points vector for managing duplicate points
-   * @return Expanded vector of
+   * @param out Expanded vector of points, each original followed by its
+   * left and right copies; existing contents are replaced
+   */
+  void world_wrap_points(const std::vector<Point>& points, std::vector<Point>& out);
+
+  /**
+   * @brief Write the points the next Build_cells call of a relaxation needs:
+   * ghosted for a full build, the originals alone for strips
+   * @param out The points; existing contents are replaced
+   */
+  void next_build_input(std::vector<Point>& out);
+
+  /**
+   * @brief Re-index the cell sites if a build happened since the last
+   * index
+   */
+  void update_locator();
+
+  /**
+   * @brief Re-derive the cell graph if a build happened since it was last
+   * derived
+   */
+  void update_graph();
+
+  /**
+   * @brief Draw every cell's pixels in its color and write the image
+   * @param filename Output filename
+   * @param cell_colors One color per cell
+   * @param draw_sites Mark every site with a white dot
+   */
+  void export_ppm(const std::string& filename,
+                  const std::vector<std::array<unsigned char, 3>>& cell_colors,
+                  bool draw_sites);
+
+  /**
+   * @brief Drop every workspace's backend, so the next build makes new ones
+   * with the current settings
+   */
+  void reset_backends();
+
+  /**
+   * @brief Build a workspace's diagram from its points, creating its backend
+   * if needed
+   * @param ws The workspace
+   */
+  void build_diagram(Voronoi_workspace& ws);
+
+  /**
+   * @brief Convert the diagram cells of a workspace's real sites into
+   * m_cells
+   * @param ws The workspace
+   * @param window For a strip, the x range its sites came from; null for a
+   * full build
+   * @return Whether every cell is exact, i.e. no site outside the window
+   * could change it
+   */
+  bool collect_cells(Voronoi_workspace& ws, const Strip_window* window);
+
+  /**
+   * @brief Build every strip in parallel
+   */
+  void build_strips();
+
+  /**
+   * @brief Build one strip, widening its margin until its cells are exact
+   * @param strip Strip index
+   * @param spacing Typical site spacing
+   */
+  void build_strip(int strip, double spacing);
+
+  /**
+   * @brief Rebuild the cells from m_original_points and measure them
+   * @return The CVT energy
+   */
+  double rebuild();
+
+  /**
+   * @brief Area, CVT energy gradient and total CVT energy of the current
+   * cells, restricted to the map. Each polygon is integrated relative to its
+   * site, unwrapped across the seam and clipped to the top and bottom edges;
+   * cells with no area there count for nothing.
+   * @return The CVT energy
+   */
+  double measure_cells();
+
+  /**
+   * @brief Lloyd relaxation, moving every site to its vertex mean
+   */
+  void relax_lloyd(int iterations);
+
+  /**
+   * @brief L-BFGS on the CVT energy
+   * @details The gradient for site i is 2 A_i (p_i - c_i), with A_i the area
+   * and c_i the centroid of its cell. The initial inverse Hessian is
+   * 1 / (2 A_i) per site, so a step with no history is exactly a Lloyd step
+   * to the true centroids. A step is halved while it doesn't decrease the
+   * energy enough, and replaced by a Lloyd step, forgetting the history, if
+   * that fails too. Sites stay inside the map vertically and wrap across
+   * the seam.
+   */
+  void relax_lbfgs(int iterations);
+
+  /**
+   * @brief Move each site from `start_points` along `direction` by `alpha`,
+   * kept on the map, writing the step actually taken to `step`
    */
-  std::vector<Point> world_wrap_points(const std::vector<Point>& points);
+  void take_step(double alpha, std::vector<double>& step);
 
 };
 }
@@ -3,11 +3,15 @@
  */
 
 // Standard libs
+#include <cmath>
+#include <sstream>
+#include <vector>
 
 // JSON
 
 // Application files
 #include <utils/html_writer.h>
+#include <utils/task_scheduler.h>
 
 ///////////////////////////////////////////////////////////////////////
 
@@ -60,6 +64,7 @@ void html::Write(const World_tiles& tiles,
   <div><span class="swatch" style="background:#88aa55;"></span>Plains</div>
   <div><span class="swatch" style="background:#557744;"></span>Hills</div>
   <div><span class="swatch" style="background:#999;"></span>Mountains</div>
+  <div>Press T, M or P for temperature, moisture or precipitation</div>
 </div>
 <canvas id="map"></canvas>
 <script>
@@ -74,28 +79,72 @@ window.onload = function() {
     const tiles = [)";
 
     // TILE DATA LOOP
-    for (int r = 0; r < tile_height; ++r)
+    // Rows are formatted in parallel (lookups only read the tiles), then
+    // written in order
+    std::vector<std::string> rows(tile_height);
+    world_builder::Task_scheduler::Instance().Parallel_for(0, rows.size(), 1,
+                                                           [&](size_t row_lo, size_t row_hi)
     {
-      for (int q = 0; q < tile_width; ++q)
+      for (size_t r = row_lo; r < row_hi; ++r)
       {
-        const world_builder::Tile& t = tiles.at({q, r});
-        std::string terrain_string;
-        terrain_string = std::string(world_builder::Enum_to_string<world_builder::ETerrain>(t.Get_terrain(),
-                                                                                            world_builder::TERRAIN_LOOKUP));
-        html << "{e:" << t.Get_elevation() << ",t:'" << terrain_string << "'},";
+        std::ostringstream row;
+        for (int q = 0; q < tile_width; ++q)
+        {
+          const world_builder::Tile& t = tiles.at({q, static_cast<int32_t>(r)});
+          std::string terrain_string;
+          terrain_string = std::string(world_builder::Enum_to_string<world_builder::ETerrain>(t.Get_terrain(),
+                                                                                              world_builder::TERRAIN_LOOKUP));
+          row << "{e:" << t.Get_elevation() << ",t:'" << terrain_string
+              << "',c:" << std::round(t.Get_temperature() * 10.0) / 10.0
+              << ",m:" << std::round(t.Get_moisture() * 100.0) / 100.0
+              << ",p:" << std::round(t.Get_precipitation() * 10000.0) / 10000.0 << "},";
+        }
+        row << "\n";
+        rows[r] = row.str();
       }
-      html << "\n";
+    });
+
+    for (const auto& row : rows)
+    {
+      html << row;
     }
 
     // JAVASCRIPT LOGIC
     html << R"(];
 
+    // Terrain, or one climate layer: temperature from -40 (blue) through 0
+    // (white) to 40 (red), moisture from dry (white) to saturated (blue), or
+    // precipitation from none (black) to the wettest tile (green)
+    let layer = 'terrain';
+    function temperatureColor(c) {
+        const f = Math.max(-1, Math.min(1, c / 40));
+        const cold = Math.round(255 * (1 + Math.min(f, 0)));
+        const warm = Math.round(255 * (1 - Math.max(f, 0)));
+        return 'rgb(' + cold + ',' + Math.min(cold, warm) + ',' + warm + ')';
+    }
+    function moistureColor(m) {
+        const dry = Math.round(255 * (1 - Math.max(0, Math.min(1, m))));
+        return 'rgb(' + dry + ',' + dry + ',255)';
+    }
+    const maxRain = tiles.reduce((most, tile) => Math.max(most, tile.p), 0);
+    function precipitationColor(p) {
+        const wet = maxRain > 0 ? Math.round(255 * Math.sqrt(p / maxRain)) : 0;
+        return 'rgb(0,' + wet + ',' + Math.round(wet / 3) + ')';
+    }
+
     function drawTiles(scale) {
         ctx.clearRect(0,0,canvas.width,canvas.height);
         for(let y=0; y<tileHeight; y++){
             for(let x=0; x<tileWidth; x++){
                 const tile = tiles[y*tileWidth + x];
                 let color = '#333';
+                if(layer !== 'terrain'){
+                    ctx.fillStyle = (layer === 'temperature') ? temperatureColor(tile.c)
+                                  : (layer === 'moisture') ? moistureColor(tile.m)
+                                  : precipitationColor(tile.p);
+                    ctx.fillRect(x*scale, y*scale, scale, scale);
+                    continue;
+                }
                 switch(tile.t){
                     case 'Ocean': color='#004'; break;
                     case 'River': color='#66f'; break;
@@ -121,6 +170,14 @@ window.onload = function() {
     }
 
     window.addEventListener('resize', resizeCanvas);
+    window.addEventListener('keydown', function(event) {
+        const layers = {t: 'temperature', m: 'moisture', p: 'precipitation'};
+        const pressed = layers[event.key.toLowerCase()];
+        if(pressed){
+            layer = (layer === pressed) ? 'terrain' : pressed;
+            resizeCanvas();
+        }
+    });
     resizeCanvas();
 };
 </script>
@@ -0,0 +1,228 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+
+#if defined(__linux__) || defined(__APPLE__) || defined(__MACOSX)
+#include <sys/resource.h>
+#endif
+
+// JSON
+
+// Application files
+#include <utils/memory_tracker.h>
+
+///////////////////////////////////////////////////////////////////////
+
+namespace
+{
+std::atomic<bool> g_tracking_enabled{false};
+std::atomic<world_builder::memory::Alloc_hook> g_alloc_hook{nullptr};
+std::atomic<uint64_t> g_alloc_count{0};
+std::atomic<uint64_t> g_alloc_bytes{0};
+
+/**
+ * @brief Record an allocation, if tracking is on
+ * @param size Requested size
+ */
+inline void record_allocation(std::size_t size)
+{
+  if(!g_tracking_enabled.load(std::memory_order_relaxed))
+  {
+    return;
+  }
+  g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+  g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+
+  world_builder::memory::Alloc_hook hook = g_alloc_hook.load(std::memory_order_relaxed);
+  if(hook)
+  {
+    hook(size);
+  }
+}
+
+/**
+ * @brief malloc with operator new semantics (new_handler loop, bad_alloc)
+ * @param size Requested size
+ * @param alignment Required alignment, 0 for the malloc default
+ * @return The allocation, or nullptr if no new_handler is installed and
+ * `nothrow` was requested
+ */
+void* allocate(std::size_t size, std::size_t alignment, bool nothrow)
+{
+  record_allocation(size);
+
+  if(size == 0)
+  {
+    size = 1;
+  }
+
+  while(true)
+  {
+    void* ptr = nullptr;
+    if(alignment == 0)
+    {
+      ptr = std::malloc(size);
+    }
+    else if(posix_memalign(&ptr, alignment, size) != 0)
+    {
+      ptr = nullptr;
+    }
+
+    if(ptr)
+    {
+      return ptr;
+    }
+
+    std::new_handler handler = std::get_new_handler();
+    if(!handler)
+    {
+      if(nothrow)
+      {
+        return nullptr;
+      }
+      throw std::bad_alloc();
+    }
+    handler();
+  }
+}
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void world_builder::memory::Set_tracking_enabled(bool enabled)
+{
+  g_tracking_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+bool world_builder::memory::Is_tracking_enabled()
+{
+  return g_tracking_enabled.load(std::memory_order_relaxed);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void world_builder::memory::Set_alloc_hook(Alloc_hook hook)
+{
+  g_alloc_hook.store(hook, std::memory_order_relaxed);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void world_builder::memory::Reset_alloc_stats()
+{
+  g_alloc_count.store(0, std::memory_order_relaxed);
+  g_alloc_bytes.store(0, std::memory_order_relaxed);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+world_builder::memory::Alloc_stats world_builder::memory::Get_alloc_stats()
+{
+  return Alloc_stats{g_alloc_count.load(std::memory_order_relaxed),
+                     g_alloc_bytes.load(std::memory_order_relaxed)};
+}
+
+///////////////////////////////////////////////////////////////////////
+
+bool world_builder::memory::Reset_peak_rss()
+{
+#if defined(__linux__)
+  // Writing 5 to clear_refs resets VmHWM to the current RSS (Linux 4.0+)
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  if(clear_refs)
+  {
+    clear_refs << "5";
+    clear_refs.flush();
+    return static_cast<bool>(clear_refs);
+  }
+#endif
+  return false;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+uint64_t world_builder::memory::Get_peak_rss_kb()
+{
+#if defined(__linux__)
+  std::ifstream status("/proc/self/status");
+  std::string key;
+  while(status >> key)
+  {
+    if(key == "VmHWM:")
+    {
+      uint64_t value = 0;
+      status >> value;
+      return value;
+    }
+  }
+#endif
+
+#if defined(__linux__) || defined(__APPLE__) || defined(__MACOSX)
+  struct rusage usage;
+  if(getrusage(RUSAGE_SELF, &usage) == 0)
+  {
+#if defined(__APPLE__) || defined(__MACOSX)
+    // macOS reports bytes
+    return static_cast<uint64_t>(usage.ru_maxrss) / 1024;
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+  }
+#endif
+  return 0;
+}
+
+///////////////////////////////////////////////////////////////////////
+// Global allocator replacement
+
+void* operator new(std::size_t size)
+{
+  return allocate(size, 0, false);
+}
+
+void* operator new[](std::size_t size)
+{
+  return allocate(size, 0, false);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+  return allocate(size, 0, true);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+  return allocate(size, 0, true);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+  return allocate(size, static_cast<std::size_t>(alignment), false);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+  return allocate(size, static_cast<std::size_t>(alignment), false);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+///////////////////////////////////////////////////////////////////////
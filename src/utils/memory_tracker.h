@@ -0,0 +1,94 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef MEMORY_TRACKER_H
+#define MEMORY_TRACKER_H
+
+// Standard libs
+#include <cstddef>
+#include <cstdint>
+
+// JSON
+
+// Application files
+
+namespace world_builder
+{
+/**
+ * @brief Process-wide allocation accounting
+ * @details memory_tracker.cpp replaces the global `operator new`/`operator
+ * delete` family. While tracking is enabled every allocation bumps a pair of
+ * relaxed atomic counters and calls the installed hook, if any. With tracking
+ * disabled the cost is a single relaxed load per allocation.
+ */
+namespace memory
+{
+
+/**
+ * @brief Allocation counters since the last Reset_alloc_stats()
+ */
+struct Alloc_stats
+{
+  /**
+   * @brief Number of calls to operator new
+   */
+  uint64_t count;
+
+  /**
+   * @brief Total bytes requested from operator new
+   */
+  uint64_t bytes;
+};
+
+/**
+ * @brief Callback invoked on every tracked allocation with the requested size
+ * @note Runs inside operator new, so it must not allocate.
+ */
+using Alloc_hook = void (*)(std::size_t bytes);
+
+/**
+ * @brief Turn allocation accounting on or off
+ * @param enabled
+ */
+void Set_tracking_enabled(bool enabled);
+
+/**
+ * @brief Whether allocation accounting is on
+ */
+bool Is_tracking_enabled();
+
+/**
+ * @brief Install an allocation hook, or nullptr to remove it
+ * @param hook
+ */
+void Set_alloc_hook(Alloc_hook hook);
+
+/**
+ * @brief Zero the allocation counters
+ */
+void Reset_alloc_stats();
+
+/**
+ * @brief Snapshot of the allocation counters
+ */
+Alloc_stats Get_alloc_stats();
+
+/**
+ * @brief Reset the kernel's resident set high water mark, where permitted
+ * @return True if the peak was reset, false if only the process-lifetime peak
+ * is available
+ */
+bool Reset_peak_rss();
+
+/**
+ * @brief Peak resident set size
+ * @return Peak RSS in kB since the last successful Reset_peak_rss(), or since
+ * process start
+ */
+uint64_t Get_peak_rss_kb();
+
+}
+}
+
+#endif
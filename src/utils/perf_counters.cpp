@@ -0,0 +1,163 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// JSON
+
+// Application files
+#include <utils/perf_counters.h>
+
+///////////////////////////////////////////////////////////////////////
+
+using perf = world_builder::Perf_counters;
+
+///////////////////////////////////////////////////////////////////////
+
+namespace
+{
+#if defined(__linux__)
+/**
+ * @brief Hardware event config for each EPerf_event, in enum order
+ */
+constexpr std::array<uint64_t, static_cast<size_t>(world_builder::EPerf_event::EPERF_EVENT_Count)> EVENT_CONFIGS = {
+  PERF_COUNT_HW_CPU_CYCLES,
+  PERF_COUNT_HW_INSTRUCTIONS,
+  PERF_COUNT_HW_CACHE_MISSES,
+  PERF_COUNT_HW_BRANCH_MISSES
+};
+
+/**
+ * @brief Open a single user-space hardware counter for this process
+ * @param config The PERF_COUNT_HW_* event
+ * @return The file descriptor, or -1 on failure
+ */
+int open_event(uint64_t config)
+{
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.disabled = 1;
+  attr.inherit = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  long fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+  return fd < 0 ? -1 : static_cast<int>(fd);
+}
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////
+
+perf::Perf_counters()
+  :
+  m_fds(),
+  m_values()
+{
+  m_fds.fill(-1);
+  m_values.fill(PERF_UNAVAILABLE);
+
+#if defined(__linux__)
+  for(size_t i = 0; i < m_fds.size(); ++i)
+  {
+    m_fds[i] = open_event(EVENT_CONFIGS[i]);
+  }
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////
+
+perf::~Perf_counters()
+{
+#if defined(__linux__)
+  for(int fd : m_fds)
+  {
+    if(fd >= 0)
+    {
+      close(fd);
+    }
+  }
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void perf::Start()
+{
+#if defined(__linux__)
+  for(int fd : m_fds)
+  {
+    if(fd >= 0)
+    {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void perf::Stop()
+{
+  m_values.fill(PERF_UNAVAILABLE);
+
+#if defined(__linux__)
+  for(size_t i = 0; i < m_fds.size(); ++i)
+  {
+    if(m_fds[i] < 0)
+    {
+      continue;
+    }
+    ioctl(m_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+
+    // value, time enabled, time running
+    uint64_t data[3] = {0, 0, 0};
+    if(read(m_fds[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) ||
+       data[2] == 0)
+    {
+      continue;
+    }
+
+    // Scale up if the kernel had to multiplex this counter with others
+    double scale = static_cast<double>(data[1]) / static_cast<double>(data[2]);
+    m_values[i] = static_cast<int64_t>(static_cast<double>(data[0]) * scale);
+  }
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////
+
+bool perf::Is_available() const
+{
+  for(int fd : m_fds)
+  {
+    if(fd >= 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+int64_t perf::Get_value(EPerf_event event) const
+{
+  return m_values[static_cast<size_t>(event)];
+}
+
+///////////////////////////////////////////////////////////////////////
@@ -0,0 +1,113 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+// Standard libs
+#include <array>
+#include <cstdint>
+
+// JSON
+
+// Application files
+#include <utils/world_builder_utils.h>
+
+namespace world_builder
+{
+
+/**
+ * @brief Hardware events sampled by Perf_counters
+ */
+enum class EPerf_event : uint8_t
+{
+  EPERF_EVENT_Cycles,         ///< CPU cycles
+  EPERF_EVENT_Instructions,   ///< Retired instructions
+  EPERF_EVENT_Cache_misses,   ///< Last level cache misses
+  EPERF_EVENT_Branch_misses,  ///< Mispredicted branches
+  EPERF_EVENT_Count           ///< Size of options enum
+};
+
+/**
+ * @brief Lookup table mapping hardware events to their report names
+ */
+constexpr std::array<Enum_mapping<EPerf_event>,
+                     static_cast<size_t>(EPerf_event::EPERF_EVENT_Count)> PERF_EVENT_LOOKUP = {
+  Enum_mapping{EPerf_event::EPERF_EVENT_Cycles,        "cycles"},
+  Enum_mapping{EPerf_event::EPERF_EVENT_Instructions,  "instructions"},
+  Enum_mapping{EPerf_event::EPERF_EVENT_Cache_misses,  "cache_misses"},
+  Enum_mapping{EPerf_event::EPERF_EVENT_Branch_misses, "branch_misses"}
+};
+
+/**
+ * @brief Thin wrapper around Linux `perf_event_open` for counting hardware
+ * events over a region of code.
+ * @details Every event is opened independently, so a kernel or VM that only
+ * exposes some of them still reports the rest. Events that could not be
+ * opened (non-Linux builds, `perf_event_paranoid` too strict, no PMU in a VM)
+ * read back as `PERF_UNAVAILABLE`. Counting covers the calling thread and any
+ * threads it spawns after construction.
+ */
+class Perf_counters
+{
+public:
+  // Attributes
+  /**
+   * @brief Value reported for an event that could not be counted
+   */
+  static constexpr int64_t PERF_UNAVAILABLE = -1;
+
+  // Implementation
+  /**
+   * @brief Constructor, opens (but does not start) all events
+   */
+  Perf_counters();
+
+  /**
+   * @brief Destructor, closes any open events
+   */
+  ~Perf_counters();
+
+  Perf_counters(const Perf_counters&) = delete;
+  Perf_counters& operator=(const Perf_counters&) = delete;
+
+  /**
+   * @brief Reset and start counting
+   */
+  void Start();
+
+  /**
+   * @brief Stop counting and latch the values
+   */
+  void Stop();
+
+  /**
+   * @brief Whether at least one event could be opened
+   */
+  bool Is_available() const;
+
+  /**
+   * @brief Latched value of an event
+   * @param event The event to read
+   * @return The (multiplex-scaled) count, or PERF_UNAVAILABLE
+   */
+  int64_t Get_value(EPerf_event event) const;
+
+private:
+  // Attributes
+  /**
+   * @brief File descriptor per event, -1 when unavailable
+   */
+  std::array<int, static_cast<size_t>(EPerf_event::EPERF_EVENT_Count)> m_fds;
+
+  /**
+   * @brief Values latched by the last Stop()
+   */
+  std::array<int64_t, static_cast<size_t>(EPerf_event::EPERF_EVENT_Count)> m_values;
+
+  // Implementation
+};
+}
+
+#endif
@@ -0,0 +1,514 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// JSON
+
+// Application files
+#include <utils/pipelines.h>
+#include <utils/html_writer.h>
+#include <utils/tiles_config.h>
+#include <utils/voronoi_config.h>
+#include <utils/world_builder_utils.h>
+// Tiles
+#include <geo_models/tiles/world.h>
+// Voronoi
+#include <geo_models/biome_table.h>
+#include <geo_models/temperature_field.h>
+#include <geo_models/voronoi/cell_hierarchy.h>
+#include <geo_models/voronoi/chunked_poisson.h>
+#include <geo_models/voronoi/elevation_assigner.h>
+#include <geo_models/voronoi/poisson_disc.h>
+#include <geo_models/voronoi/river_network.h>
+#include <geo_models/voronoi/sample_elimination.h>
+#include <geo_models/voronoi/spherical_voronoi.h>
+#include <geo_models/voronoi/variable_poisson_disc.h>
+#include <geo_models/voronoi/voronoi_builder.h>
+
+///////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+/**
+ * @brief Color of cells no biome rule matches
+ */
+constexpr std::array<unsigned char, 3> UNCLASSIFIED_COLOR = {0, 0, 0};
+
+/**
+ * @brief Cell biome rules from config, or the built-in ones: ocean below sea
+ * level, beaches on the coast just above it, then land banded by
+ * temperature from snow to tropical forest
+ * @param voronoi_config The config
+ * @return The rules
+ */
+std::vector<world_builder::Biome_rule> Cell_biome_rules(const world_builder::Voronoi_config& voronoi_config)
+{
+  if(!voronoi_config.Get_biome_rules().empty())
+  {
+    return voronoi_config.Get_biome_rules();
+  }
+
+  constexpr size_t ELEVATION = static_cast<size_t>(world_builder::EBiome_axis::EBIOME_AXIS_Elevation);
+  constexpr size_t TEMPERATURE = static_cast<size_t>(world_builder::EBiome_axis::EBIOME_AXIS_Temperature);
+  std::vector<world_builder::Biome_rule> rules;
+  auto add = [&](const std::string& biome, std::array<unsigned char, 3> color)
+  {
+    rules.emplace_back(biome);
+    rules.back().color = color;
+  };
+  auto colder_than = [&](const std::string& biome, std::array<unsigned char, 3> color, double max_temperature)
+  {
+    add(biome, color);
+    rules.back().max[TEMPERATURE] = max_temperature;
+  };
+  add("Ocean", {40, 70, 160});
+  rules.back().max[ELEVATION] = 0.0;
+  add("Beach", {225, 210, 150});
+  rules.back().max[ELEVATION] = 0.05;
+  rules.back().coast = world_builder::ECoast_rule::ECOAST_RULE_Coastal;
+  colder_than("Snow", {240, 240, 245}, -10.0);
+  colder_than("Tundra", {160, 160, 130}, 0.0);
+  colder_than("Taiga", {60, 105, 80}, 8.0);
+  colder_than("Temperate forest", {70, 140, 60}, 20.0);
+  add("Tropical forest", {30, 115, 40});
+  return rules;
+}
+
+/**
+ * @brief Run the Voronoi pipeline on a spherical planet and write
+ * equirectangular PPM images, twice as wide as tall
+ * @param voronoi_config The config, already applied
+ * @param output_dir Directory for the images; empty writes none
+ * @param profiler Records every stage
+ * @return Number of cells
+ */
+size_t Run_sphere_pipeline(const world_builder::Voronoi_config& voronoi_config,
+                           const std::string& output_dir,
+                           world_builder::Stage_profiler& profiler)
+{
+  const bool write = !output_dir.empty();
+
+  // The equator is the map width; the site count is as given, or what the
+  // flat map's spacing would give over the whole sphere
+  const int img_width = static_cast<int>(voronoi_config.Get_width());
+  const int img_height = img_width / 2;
+  size_t site_count = voronoi_config.Get_target_cell_count();
+  if(site_count == 0)
+  {
+    site_count = world_builder::Sphere_sampler::Count_for_spacing(voronoi_config.Get_width(),
+                                                                  voronoi_config.Get_min_distance());
+  }
+
+  std::vector<world_builder::Vec3> sites;
+  {
+    world_builder::Sphere_sampler point_sampler(site_count, voronoi_config.Get_sphere_jitter());
+    world_builder::Stage_profiler::Scope stage(profiler, "Sphere_sampler::Generate");
+    sites = point_sampler.Generate();
+  }
+
+  std::vector<world_builder::Point> points(sites.size());
+  for(size_t i = 0; i < sites.size(); ++i)
+  {
+    points[i] = world_builder::Equirectangular_point(sites[i], img_width, img_height);
+  }
+  if(write)
+  {
+    world_builder::Save_points_as_ppm(points, img_width, img_height, output_dir + "/1_poisson_points.ppm");
+  }
+
+  //////////////////////////////////////////////////////
+  // Points to spherical Voronoi polygons
+
+  world_builder::Spherical_voronoi voronoi_builder;
+  {
+    world_builder::Stage_profiler::Scope stage(profiler, "Build_cells");
+    if(!voronoi_builder.Build_cells(sites))
+    {
+      throw std::runtime_error("The " + std::to_string(sites.size()) +
+                               " sphere sites do not surround the center of the sphere");
+    }
+  }
+  if(write)
+  {
+    world_builder::Stage_profiler::Scope stage(profiler, "Export_PPM");
+    voronoi_builder.Export_PPM(output_dir + "/2_initial_v_cells.ppm", img_width, img_height);
+  }
+
+  {
+    world_builder::Stage_profiler::Scope stage(profiler, "Relax_cells");
+    if(!voronoi_builder.Relax_cells(voronoi_config.Get_relax_iterations()))
+    {
+      throw std::runtime_error("Relaxed sphere sites no longer surround the center of the sphere");
+    }
+  }
+  double min_area = 4.0 * M_PI;
+  double max_area = 0;
+  for(size_t i = 0; i < sites.size(); ++i)
+  {
+    double area = voronoi_builder.Cell_area(i);
+    min_area = (area > 0) ? std::min(min_area, area) : min_area;
+    max_area = std::max(max_area, area);
+  }
+  world_builder::Print_to_cout("Sphere cells " + std::to_string(sites.size()) + ", smallest to largest area " +
+                               std::to_string(max_area > 0 ? min_area / max_area : 0.0));
+  if(write)
+  {
+    world_builder::Stage_profiler::Scope stage(profiler, "Export_PPM");
+    voronoi_builder.Export_PPM(output_dir + "/3_relaxed_v_cells.ppm", img_width, img_height);
+  }
+  return sites.size();
+}
+}
+
+///////////////////////////////////////////////////////////////////////
+
+size_t world_builder::Run_tiles_pipeline(const world_builder::Tiles_config& tiles_config,
+                                         const std::string& output_dir,
+                                         world_builder::Stage_profiler& profiler)
+{
+  world_builder::World world(tiles_config);
+  {
+    world_builder::Stage_profiler::Scope stage(profiler, "Seed_continents");
+    world.Seed_continents();
+  }
+  {
+    world_builder::Stage_profiler::Scope stage(profiler, "Seed_oceans");
+    world.Seed_oceans();
+  }
+  {
+    world_builder::Stage_profiler::Scope stage(profiler, "Run_diffusion");
+    world.Run_diffusion();
+  }
+  {
+    world_builder::Stage_profiler::Scope stage(profiler, "Normalize_elevation");
+    world.Normalize_elevation();
+  }
+  {
+    world_builder::Stage_profiler::Scope stage(profiler, "Run_oceans_and_coasts");
+    world.Run_oceans_and_coasts();
+  }
+  {
+    world_builder::Stage_profiler::Scope stage(profiler, "Run_rivers");
+    world.Run_rivers();
+  }
+  {
+    world_builder::Stage_profiler::Scope stage(profiler, "Run_moisture");
+    world.Run_moisture();
+  }
+  {
+    world_builder::Stage_profiler::Scope stage(profiler, "Run_temperature");
+    world.Run_temperature();
+  }
+  {
+    world_builder::Stage_profiler::Scope stage(profiler, "Paint_terrain");
+    world.Paint_terrain();
+  }
+
+  //////////////////////////////////////////////////////
+  // World Visualization
+  if(!output_dir.empty())
+  {
+    world_builder::Stage_profiler::Scope stage(profiler, "HTML_writer::Write");
+    world_builder::HTML_writer html_writer(output_dir);
+    html_writer.Write(world.Get_world_tiles(), tiles_config);
+  }
+  return static_cast<size_t>(tiles_config.Get_width()) * tiles_config.Get_height();
+}
+
+///////////////////////////////////////////////////////////////////////
+
+size_t world_builder::Run_voronoi_pipeline(const world_builder::Voronoi_config& voronoi_config,
+                                           const std::string& output_dir,
+                                           world_builder::Stage_profiler& profiler)
+{
+  if(voronoi_config.Get_spherical())
+  {
+    return Run_sphere_pipeline(voronoi_config, output_dir, profiler);
+  }
+  const bool write = !output_dir.empty();
+
+  // Generate points: an exact count if one is configured, chunk by chunk if
+  // a chunk size is, spaced by a density map if one is given, otherwise
+  // uniformly over the whole map in one go
+  std::vector<world_builder::Point> points;
+  const bool uniform_sampling = voronoi_config.Get_target_cell_count() == 0 &&
+                                voronoi_config.Get_chunk_size() <= 0 &&
+                                voronoi_config.Get_density_map().empty();
+  if(voronoi_config.Get_wrap_points() && !uniform_sampling)
+  {
+    world_builder::Print_to_cout("wrap_points only applies to uniform Poisson disc sampling, "
+                                 "these points are not seamless across the wrap");
+  }
+  if(voronoi_config.Get_target_cell_count() > 0)
+  {
+    world_builder::Sample_elimination point_sampler(voronoi_config.Get_width(),
+                                                    voronoi_config.Get_height(),
+                                                    voronoi_config.Get_target_cell_count());
+    world_builder::Stage_profiler::Scope stage(profiler, "Sample_elimination::Generate");
+    points = point_sampler.Generate();
+  }
+  else if(voronoi_config.Get_chunk_size() > 0)
+  {
+    world_builder::Chunked_poisson point_sampler(voronoi_config.Get_chunk_size(),
+                                                 voronoi_config.Get_min_distance(),
+                                                 voronoi_config.Get_attempts(),
+                                                 voronoi_config.Get_seed(),
+                                                 voronoi_config.Get_chunk_cache());
+    world_builder::Stage_profiler::Scope stage(profiler, "Chunked_poisson::Generate_region");
+    points = point_sampler.Generate_region(0, 0, voronoi_config.Get_width(), voronoi_config.Get_height());
+  }
+  else if(!voronoi_config.Get_density_map().empty())
+  {
+    auto radius = world_builder::Variable_poisson_disc::Radius_from_image(voronoi_config.Get_density_map(),
+                                                                          voronoi_config.Get_width(),
+                                                                          voronoi_config.Get_height(),
+                                                                          voronoi_config.Get_min_distance(),
+                                                                          voronoi_config.Get_max_distance());
+    world_builder::Variable_poisson_disc point_sampler(voronoi_config.Get_width(),
+                                                       voronoi_config.Get_height(),
+                                                       radius,
+                                                       voronoi_config.Get_min_distance(),
+                                                       voronoi_config.Get_max_distance(),
+                                                       voronoi_config.Get_attempts());
+    world_builder::Stage_profiler::Scope stage(profiler, "Variable_poisson_disc::Generate");
+    points = point_sampler.Generate();
+  }
+  else
+  {
+    world_builder::Poisson_disc point_sampler(voronoi_config.Get_width(),
+                                              voronoi_config.Get_height(),
+                                              voronoi_config.Get_min_distance(),
+                                              voronoi_config.Get_attempts());
+    point_sampler.Set_wrap_x(voronoi_config.Get_wrap_points());
+    world_builder::Stage_profiler::Scope stage(profiler, "Poisson_disc::Generate");
+    points = point_sampler.Generate();
+  }
+
+  // Output the sampled points
+  if(write)
+  {
+    world_builder::Save_points_as_ppm(points,
+                                      voronoi_config.Get_width(),
+                                      voronoi_config.Get_height(),
+                                      output_dir + "/1_poisson_points.ppm");
+  }
+
+  //////////////////////////////////////////////////////
+  // Points to Voronoi polygons
+
+  world_builder::Voronoi_builder voronoi_builder(voronoi_config.Get_width(),
+                                                voronoi_config.Get_height(),
+                                                voronoi_config.Get_voronoi_scale_factor());
+  voronoi_builder.Set_strip_count(voronoi_config.Get_voronoi_strips());
+  voronoi_builder.Set_backend(world_builder::Voronoi_backend_from_name(voronoi_config.Get_voronoi_backend()));
+  voronoi_builder.Set_relax_method(world_builder::Relax_method_from_name(voronoi_config.Get_relax_method()));
+
+  {
+    world_builder::Stage_profiler::Scope stage(profiler, "Build_cells");
+    voronoi_builder.Build_cells(points);
+  }
+  if(write)
+  {
+    world_builder::Stage_profiler::Scope stage(profiler, "Export_PPM");
+    voronoi_builder.Export_PPM(output_dir + "/2_initial_v_cells.ppm");
+  }
+
+  {
+    world_builder::Stage_profiler::Scope stage(profiler, "Relax_cells");
+    voronoi_builder.Relax_cells(voronoi_config.Get_relax_iterations());
+  }
+  const std::vector<double>& energy = voronoi_builder.Get_relax_energy();
+  for(size_t i = 0; i < energy.size(); ++i)
+  {
+    world_builder::Print_to_cout("Relaxation iteration " + std::to_string(i) + " CVT energy " +
+                                 std::to_string(energy[i]));
+  }
+  world_builder::Print_to_cout("Relaxation rebuilt the diagram " +
+                               std::to_string(voronoi_builder.Get_relax_rebuilds()) + " times");
+  if(write)
+  {
+    world_builder::Stage_profiler::Scope stage(profiler, "Export_PPM");
+    voronoi_builder.Export_PPM(output_dir + "/3_relaxed_v_cells.ppm");
+  }
+
+  //////////////////////////////////////////////////////
+  // Elevation from the distance to the coast and to mountain seeds
+
+  if(voronoi_config.Get_island_radius() > 0)
+  {
+    world_builder::Elevation_assigner elevation_assigner(voronoi_config.Get_island_radius(),
+                                                         voronoi_config.Get_mountain_seeds(),
+                                                         voronoi_config.Get_mountain_radius());
+    {
+      world_builder::Stage_profiler::Scope stage(profiler, "Elevation_assigner::Assign");
+      elevation_assigner.Assign(voronoi_builder.Get_cells(),
+                                voronoi_builder.Get_cell_graph(),
+                                voronoi_config.Get_width(),
+                                voronoi_config.Get_height());
+    }
+
+    const std::vector<double>& elevation = elevation_assigner.Get_elevation();
+    std::vector<std::array<unsigned char, 3>> elevation_colors;
+    if(write)
+    {
+      elevation_colors.resize(elevation.size());
+      for(size_t i = 0; i < elevation.size(); ++i)
+      {
+        elevation_colors[i] = world_builder::Elevation_assigner::Elevation_color(elevation[i]);
+      }
+      world_builder::Stage_profiler::Scope stage(profiler, "Export_PPM");
+      voronoi_builder.Export_PPM(output_dir + "/4_elevation_v_cells.ppm", elevation_colors);
+    }
+
+    // Rivers routed downhill, drawn over the elevation
+    if(voronoi_config.Get_river_min_flow() > 0)
+    {
+      world_builder::River_network rivers;
+      {
+        world_builder::Stage_profiler::Scope stage(profiler, "River_network::Route");
+        rivers.Route(voronoi_builder.Get_cell_graph(), elevation);
+        rivers.Trace(voronoi_builder.Get_cells(), voronoi_config.Get_width(),
+                     voronoi_config.Get_river_min_flow());
+      }
+      world_builder::Print_to_cout("Rivers: " + std::to_string(rivers.Get_river_count()) +
+                                   " rivers, " + std::to_string(rivers.Get_lake_count()) + " lakes");
+
+      if(write)
+      {
+        world_builder::Stage_profiler::Scope stage(profiler, "Export_PPM");
+        std::vector<std::array<unsigned char, 3>> image;
+        if(voronoi_builder.Render(elevation_colors, image))
+        {
+          const int image_width = static_cast<int>(voronoi_config.Get_width());
+          const int image_height = static_cast<int>(voronoi_config.Get_height());
+          rivers.Draw(image_width, image_height, image);
+          world_builder::Write_ppm(output_dir + "/5_rivers_v_cells.ppm", image_width, image_height, image);
+        }
+      }
+    }
+
+    // Temperature from latitude, height and the coast distance found above
+    {
+      const std::vector<world_builder::Cell>& cells = voronoi_builder.Get_cells();
+      const std::vector<int>& coast_distance = elevation_assigner.Get_coast_distance();
+      const double height = voronoi_config.Get_height();
+      std::vector<float> latitude(cells.size());
+      std::vector<float> cell_height(cells.size());
+      std::vector<float> distance(cells.size());
+      std::vector<float> temperature(cells.size());
+      {
+        world_builder::Stage_profiler::Scope stage(profiler, "Temperature_field::Temperature_all");
+        for(size_t i = 0; i < cells.size(); ++i)
+        {
+          latitude[i] = static_cast<float>(std::abs(cells[i].site.y / height * 2.0 - 1.0));
+          cell_height[i] = static_cast<float>(elevation[i]);
+          distance[i] = static_cast<float>(coast_distance[i]);
+        }
+        world_builder::Temperature_field field(voronoi_config.Get_coast_moderation());
+        field.Temperature_all(latitude.data(), cell_height.data(), distance.data(), cells.size(), temperature.data());
+      }
+
+      if(write)
+      {
+        std::vector<std::array<unsigned char, 3>> temperature_colors(cells.size());
+        for(size_t i = 0; i < cells.size(); ++i)
+        {
+          temperature_colors[i] = world_builder::Temperature_field::Temperature_color(temperature[i]);
+        }
+        world_builder::Stage_profiler::Scope stage(profiler, "Export_PPM");
+        voronoi_builder.Export_PPM(output_dir + "/6_temperature_v_cells.ppm", temperature_colors);
+      }
+
+      // Biomes from the elevation, the temperature and the coast; cells carry
+      // no moisture yet, so it reads as 0
+      const world_builder::Biome_table biome_table(Cell_biome_rules(voronoi_config));
+      std::vector<double> cell_temperature(temperature.begin(), temperature.end());
+      std::vector<unsigned char> coastal(cells.size());
+      std::vector<uint8_t> biome(cells.size());
+      {
+        world_builder::Stage_profiler::Scope stage(profiler, "Biome_table::Classify_all");
+        for(size_t i = 0; i < cells.size(); ++i)
+        {
+          coastal[i] = coast_distance[i] == 0;
+        }
+        biome_table.Classify_all(elevation.data(), nullptr, cell_temperature.data(), coastal.data(),
+                                 cells.size(), biome.data());
+      }
+
+      if(write)
+      {
+        const std::vector<std::array<unsigned char, 3>>& biome_colors = biome_table.Get_biome_colors();
+        std::vector<std::array<unsigned char, 3>> cell_colors(cells.size());
+        for(size_t i = 0; i < cells.size(); ++i)
+        {
+          cell_colors[i] = (biome[i] == world_builder::Biome_table::UNCLASSIFIED) ? UNCLASSIFIED_COLOR
+                                                                                   : biome_colors[biome[i]];
+        }
+        world_builder::Stage_profiler::Scope stage(profiler, "Export_PPM");
+        voronoi_builder.Export_PPM(output_dir + "/7_biome_v_cells.ppm", cell_colors);
+      }
+    }
+  }
+
+  //////////////////////////////////////////////////////
+  // Coarse layer over the same map, linked to the fine cells
+
+  const size_t cell_count = voronoi_builder.Get_cells().size();
+  if(voronoi_config.Get_coarse_min_distance() <= 0)
+  {
+    return cell_count;
+  }
+
+  world_builder::Poisson_disc coarse_sampler(voronoi_config.Get_width(),
+                                             voronoi_config.Get_height(),
+                                             voronoi_config.Get_coarse_min_distance(),
+                                             voronoi_config.Get_attempts());
+  coarse_sampler.Set_wrap_x(voronoi_config.Get_wrap_points());
+  world_builder::Voronoi_builder coarse_builder(voronoi_config.Get_width(),
+                                               voronoi_config.Get_height(),
+                                               voronoi_config.Get_voronoi_scale_factor());
+  coarse_builder.Set_backend(world_builder::Voronoi_backend_from_name(voronoi_config.Get_voronoi_backend()));
+  coarse_builder.Set_relax_method(world_builder::Relax_method_from_name(voronoi_config.Get_relax_method()));
+  {
+    world_builder::Stage_profiler::Scope stage(profiler, "Build_coarse_cells");
+    coarse_builder.Build_cells(coarse_sampler.Generate());
+    coarse_builder.Relax_cells(voronoi_config.Get_relax_iterations());
+  }
+
+  world_builder::Cell_hierarchy hierarchy;
+  {
+    world_builder::Stage_profiler::Scope stage(profiler, "Cell_hierarchy::Build");
+    hierarchy.Build(coarse_builder, voronoi_builder);
+  }
+  world_builder::Print_to_cout("Cell hierarchy: " + std::to_string(hierarchy.Get_coarse_count()) +
+                               " coarse cells over " + std::to_string(hierarchy.Get_fine_count()) +
+                               " fine cells");
+
+  // The fine cells in their parents' colors
+  const std::vector<world_builder::Cell>& coarse_cells = coarse_builder.Get_cells();
+  std::vector<std::array<unsigned char, 3>> coarse_colors(coarse_cells.size());
+  for(size_t i = 0; i < coarse_cells.size(); ++i)
+  {
+    coarse_colors[i] = coarse_cells[i].color;
+  }
+  std::vector<std::array<unsigned char, 3>> fine_colors;
+  hierarchy.Propagate(coarse_colors, fine_colors);
+  if(write)
+  {
+    world_builder::Stage_profiler::Scope stage(profiler, "Export_PPM");
+    voronoi_builder.Export_PPM(output_dir + "/4_coarse_v_cells.ppm", fine_colors);
+  }
+  return cell_count;
+}
+
+///////////////////////////////////////////////////////////////////////
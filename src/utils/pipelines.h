@@ -0,0 +1,50 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef PIPELINES_H
+#define PIPELINES_H
+
+// Standard libs
+#include <cstddef>
+#include <string>
+
+// JSON
+
+// Application files
+#include <utils/stage_profiler.h>
+
+namespace world_builder
+{
+
+class Tiles_config;
+class Voronoi_config;
+
+/**
+ * @brief Run the tiles pipeline, from seeding the continents to painting the
+ * terrain, and write the HTML map
+ * @param tiles_config The config, already applied
+ * @param output_dir Directory for the map; empty writes none
+ * @param profiler Records every stage
+ * @return Number of tiles
+ */
+size_t Run_tiles_pipeline(const Tiles_config& tiles_config,
+                          const std::string& output_dir,
+                          Stage_profiler& profiler);
+
+/**
+ * @brief Run the Voronoi pipeline the config asks for, flat or spherical,
+ * from sampling the sites through relaxation, elevation, rivers,
+ * temperature, biomes and the coarse layer, and write the PPM images
+ * @param voronoi_config The config, already applied
+ * @param output_dir Directory for the images; empty writes none
+ * @param profiler Records every stage
+ * @return Number of cells
+ * @throws std::runtime_error If the spherical cells cannot be built
+ */
+size_t Run_voronoi_pipeline(const Voronoi_config& voronoi_config,
+                            const std::string& output_dir,
+                            Stage_profiler& profiler);
+}
+
+#endif
@@ -0,0 +1,186 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+#include <fstream>
+#include <sstream>
+
+// JSON
+#include <deps/json.hpp>
+
+// Application files
+#include <utils/memory_tracker.h>
+#include <utils/stage_profiler.h>
+#include <utils/world_builder_utils.h>
+
+///////////////////////////////////////////////////////////////////////
+
+using sp = world_builder::Stage_profiler;
+
+///////////////////////////////////////////////////////////////////////
+
+sp::Scope::Scope(Stage_profiler& profiler, std::string name)
+  :
+  m_profiler(profiler),
+  m_record(),
+  m_timer(),
+  m_owns_counters(false)
+{
+  m_record.name = std::move(name);
+  m_record.events.fill(Perf_counters::PERF_UNAVAILABLE);
+
+  if(m_profiler.m_enabled)
+  {
+    m_owns_counters = (m_profiler.m_depth == 0);
+    if(m_owns_counters)
+    {
+      memory::Reset_peak_rss();
+      m_profiler.m_counters->Start();
+    }
+
+    // Store the starting counts; the destructor turns these into deltas
+    memory::Alloc_stats stats = memory::Get_alloc_stats();
+    m_record.alloc_count = stats.count;
+    m_record.alloc_bytes = stats.bytes;
+  }
+
+  m_profiler.m_depth++;
+  m_timer.Start();
+}
+
+///////////////////////////////////////////////////////////////////////
+
+sp::Scope::~Scope()
+{
+  m_timer.Stop();
+  m_profiler.m_depth--;
+  m_record.seconds = m_timer.Get_time();
+
+  if(m_profiler.m_enabled)
+  {
+    if(m_owns_counters)
+    {
+      m_profiler.m_counters->Stop();
+      for(size_t i = 0; i < m_record.events.size(); ++i)
+      {
+        m_record.events[i] = m_profiler.m_counters->Get_value(static_cast<EPerf_event>(i));
+      }
+    }
+
+    memory::Alloc_stats stats = memory::Get_alloc_stats();
+    m_record.alloc_count = stats.count - m_record.alloc_count;
+    m_record.alloc_bytes = stats.bytes - m_record.alloc_bytes;
+    m_record.peak_rss_kb = memory::Get_peak_rss_kb();
+  }
+
+  m_profiler.m_records.push_back(std::move(m_record));
+}
+
+///////////////////////////////////////////////////////////////////////
+
+sp::Stage_profiler(bool enabled)
+  :
+  m_enabled(enabled),
+  m_counters(),
+  m_records(),
+  m_depth(0)
+{
+  if(m_enabled)
+  {
+    m_counters = std::make_unique<Perf_counters>();
+    memory::Set_tracking_enabled(true);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+
+bool sp::Has_hardware_counters() const
+{
+  return m_counters && m_counters->Is_available();
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void sp::Print_report() const
+{
+  if(m_enabled && !Has_hardware_counters())
+  {
+    world_builder::Print_to_cout("Hardware counters unavailable (check perf_event_paranoid), "
+                                 "reporting time and memory only");
+  }
+
+  for(const auto& record : m_records)
+  {
+    std::ostringstream line;
+    line << "Stage " << record.name << ": " << record.seconds << " s";
+
+    if(m_enabled)
+    {
+      for(size_t i = 0; i < record.events.size(); ++i)
+      {
+        if(record.events[i] == Perf_counters::PERF_UNAVAILABLE)
+        {
+          continue;
+        }
+        line << ", " << Enum_to_string(static_cast<EPerf_event>(i), PERF_EVENT_LOOKUP)
+             << " " << record.events[i];
+      }
+
+      int64_t cycles = record.events[static_cast<size_t>(EPerf_event::EPERF_EVENT_Cycles)];
+      int64_t instructions = record.events[static_cast<size_t>(EPerf_event::EPERF_EVENT_Instructions)];
+      if(cycles > 0 && instructions != Perf_counters::PERF_UNAVAILABLE)
+      {
+        line << ", IPC " << static_cast<double>(instructions) / static_cast<double>(cycles);
+      }
+
+      line << ", allocs " << record.alloc_count
+           << ", alloc bytes " << record.alloc_bytes
+           << ", peak RSS " << record.peak_rss_kb << " kB";
+    }
+
+    world_builder::Print_to_cout(line.str());
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void sp::Write_json(const std::string& filename) const
+{
+  nlohmann::json stages = nlohmann::json::array();
+  for(const auto& record : m_records)
+  {
+    nlohmann::json stage;
+    stage["name"] = record.name;
+    stage["seconds"] = record.seconds;
+    if(m_enabled)
+    {
+      for(size_t i = 0; i < record.events.size(); ++i)
+      {
+        std::string key(Enum_to_string(static_cast<EPerf_event>(i), PERF_EVENT_LOOKUP));
+        if(record.events[i] == Perf_counters::PERF_UNAVAILABLE)
+        {
+          stage[key] = nullptr;
+        }
+        else
+        {
+          stage[key] = record.events[i];
+        }
+      }
+      stage["alloc_count"] = record.alloc_count;
+      stage["alloc_bytes"] = record.alloc_bytes;
+      stage["peak_rss_kb"] = record.peak_rss_kb;
+    }
+    stages.push_back(stage);
+  }
+
+  std::ofstream ofs(filename);
+  if(!ofs)
+  {
+    world_builder::Print_to_cout("Stage report: failed to open file " + filename);
+    return;
+  }
+  ofs << nlohmann::json{{"stages", stages}}.dump(2) << "\n";
+}
+
+///////////////////////////////////////////////////////////////////////
@@ -0,0 +1,176 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef STAGE_PROFILER_H
+#define STAGE_PROFILER_H
+
+// Standard libs
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// JSON
+
+// Application files
+#include <utils/perf_counters.h>
+#include <utils/stopwatch.h>
+
+namespace world_builder
+{
+
+/**
+ * @brief Measurements for a single pipeline stage
+ */
+struct Stage_record
+{
+  /**
+   * @brief Stage name, e.g. "Run_diffusion"
+   */
+  std::string name;
+
+  /**
+   * @brief Wall time in seconds
+   */
+  double seconds;
+
+  /**
+   * @brief Hardware event counts, Perf_counters::PERF_UNAVAILABLE if not counted
+   */
+  std::array<int64_t, static_cast<size_t>(EPerf_event::EPERF_EVENT_Count)> events;
+
+  /**
+   * @brief Number of heap allocations made during the stage
+   */
+  uint64_t alloc_count;
+
+  /**
+   * @brief Bytes requested from the heap during the stage
+   */
+  uint64_t alloc_bytes;
+
+  /**
+   * @brief Peak resident set size at the end of the stage, in kB
+   */
+  uint64_t peak_rss_kb;
+};
+
+/**
+ * @brief Collects a per-stage report of wall time and, when enabled, hardware
+ * counters and memory usage.
+ * @details Stages are delimited with a Stage_profiler::Scope. When the
+ * profiler is disabled only wall time is recorded, so scopes can stay in
+ * production code paths. Scopes may nest; hardware counters are only sampled
+ * by the outermost scope, since the counters are shared.
+ */
+class Stage_profiler
+{
+public:
+  // Attributes
+
+  /**
+   * @brief RAII guard that measures one stage
+   */
+  class Scope
+  {
+  public:
+    /**
+     * @brief Begin measuring a stage
+     * @param profiler The owning profiler
+     * @param name Stage name
+     */
+    Scope(Stage_profiler& profiler, std::string name);
+
+    /**
+     * @brief Finish measuring and append the record to the profiler
+     */
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+    /**
+     * @brief The owning profiler
+     */
+    Stage_profiler& m_profiler;
+
+    /**
+     * @brief Record being filled in
+     */
+    Stage_record m_record;
+
+    /**
+     * @brief Wall clock for the stage
+     */
+    Stopwatch m_timer;
+
+    /**
+     * @brief This scope owns the hardware counters
+     */
+    bool m_owns_counters;
+  };
+
+  // Implementation
+  /**
+   * @brief Constructor
+   * @param enabled Collect hardware counters and memory usage in addition to
+   * wall time
+   */
+  explicit Stage_profiler(bool enabled = false);
+
+  /**
+   * @brief Whether counters and memory usage are being collected
+   */
+  bool Is_enabled() const { return m_enabled; }
+
+  /**
+   * @brief Whether hardware counters could be opened on this machine
+   */
+  bool Has_hardware_counters() const;
+
+  /**
+   * @brief All stages measured so far, in the order they finished
+   */
+  const std::vector<Stage_record>& Get_records() const { return m_records; }
+
+  /**
+   * @brief Print the per-stage report
+   */
+  void Print_report() const;
+
+  /**
+   * @brief Write the per-stage report as JSON
+   * @param filename Output file
+   */
+  void Write_json(const std::string& filename) const;
+
+private:
+  // Attributes
+  /**
+   * @brief Collect counters and memory usage
+   */
+  bool m_enabled;
+
+  /**
+   * @brief Hardware counters, only opened when enabled
+   */
+  std::unique_ptr<Perf_counters> m_counters;
+
+  /**
+   * @brief Finished stages
+   */
+  std::vector<Stage_record> m_records;
+
+  /**
+   * @brief Number of scopes currently open
+   */
+  int m_depth;
+
+  // Implementation
+};
+}
+
+#endif
@@ -0,0 +1,344 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+// Standard libs
+
+// JSON
+
+// Application files
+#include <utils/task_scheduler.h>
+
+///////////////////////////////////////////////////////////////////////
+
+using ts = world_builder::Task_scheduler;
+using tg = world_builder::Task_group;
+
+///////////////////////////////////////////////////////////////////////
+
+namespace
+{
+/**
+ * @brief Scheduler owning the current thread, if it is a worker
+ */
+thread_local world_builder::Task_scheduler* t_scheduler = nullptr;
+
+/**
+ * @brief Queue index of the current thread, if it is a worker
+ */
+thread_local size_t t_worker_index = 0;
+
+/**
+ * @brief Chunks per thread targeted by the automatic grain size
+ */
+constexpr size_t AUTO_CHUNKS_PER_THREAD = 8;
+
+/**
+ * @brief Chunks targeted by the automatic grain size in deterministic mode,
+ * enough to keep a large machine busy
+ */
+constexpr size_t DETERMINISTIC_CHUNKS = 256;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+ts& ts::Instance()
+{
+  static Task_scheduler scheduler;
+  return scheduler;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+ts::Task_scheduler()
+  :
+  m_workers(),
+  m_queues(),
+  m_injection(),
+  m_queued(0),
+  m_stopping(false),
+  m_deterministic(false)
+{
+  unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+  start_workers(hardware - 1);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+ts::~Task_scheduler()
+{
+  stop_workers();
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void ts::Set_thread_count(unsigned threads)
+{
+  if(threads == 0)
+  {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  if(threads == Get_thread_count())
+  {
+    return;
+  }
+
+  stop_workers();
+  start_workers(threads - 1);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+size_t ts::Get_auto_grain(size_t count) const
+{
+  size_t chunks = m_deterministic ? DETERMINISTIC_CHUNKS
+                                  : static_cast<size_t>(Get_thread_count()) * AUTO_CHUNKS_PER_THREAD;
+  return std::max<size_t>(1, (count + chunks - 1) / chunks);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void ts::start_workers(unsigned count)
+{
+  m_stopping = false;
+  m_queues.clear();
+  for(unsigned i = 0; i < count; ++i)
+  {
+    m_queues.push_back(std::make_unique<Worker_queue>());
+  }
+  for(unsigned i = 0; i < count; ++i)
+  {
+    m_workers.emplace_back(&Task_scheduler::worker_loop, this, static_cast<size_t>(i));
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void ts::stop_workers()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_sleep_mutex);
+    m_stopping = true;
+  }
+  m_wake.notify_all();
+
+  for(auto& worker : m_workers)
+  {
+    worker.join();
+  }
+  m_workers.clear();
+  m_queues.clear();
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void ts::worker_loop(size_t index)
+{
+  t_scheduler = this;
+  t_worker_index = index;
+
+  while(true)
+  {
+    Task task;
+    if(try_pop(task))
+    {
+      execute(task);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_sleep_mutex);
+    m_wake.wait(lock, [this]() { return m_stopping || m_queued.load() > 0; });
+    if(m_stopping)
+    {
+      return;
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void ts::push(Task task)
+{
+  {
+    // Count first so the counter never underflows when a thief pops the task
+    // straight away. Taking the sleep mutex orders the increment against a
+    // worker that is between checking the predicate and going to sleep.
+    std::lock_guard<std::mutex> lock(m_sleep_mutex);
+    m_queued++;
+  }
+
+  Worker_queue& queue = (t_scheduler == this) ? *m_queues[t_worker_index] : m_injection;
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+  m_wake.notify_one();
+}
+
+///////////////////////////////////////////////////////////////////////
+
+bool ts::try_pop(Task& task)
+{
+  if(m_queued.load() == 0)
+  {
+    return false;
+  }
+
+  // Own deque, newest first
+  if(t_scheduler == this)
+  {
+    Worker_queue& own = *m_queues[t_worker_index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if(!own.tasks.empty())
+    {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      m_queued--;
+      return true;
+    }
+  }
+
+  // Work submitted from outside the pool
+  {
+    std::lock_guard<std::mutex> lock(m_injection.mutex);
+    if(!m_injection.tasks.empty())
+    {
+      task = std::move(m_injection.tasks.front());
+      m_injection.tasks.pop_front();
+      m_queued--;
+      return true;
+    }
+  }
+
+  // Steal the oldest task from another worker, starting after ourselves so
+  // thieves spread out
+  size_t count = m_queues.size();
+  size_t start = (t_scheduler == this) ? t_worker_index + 1 : 0;
+  for(size_t i = 0; i < count; ++i)
+  {
+    Worker_queue& victim = *m_queues[(start + i) % count];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if(!victim.tasks.empty())
+    {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      m_queued--;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void ts::execute(Task& task)
+{
+  Task_group* group = task.group;
+  try
+  {
+    task.fn();
+  }
+  catch(...)
+  {
+    group->set_exception(std::current_exception());
+  }
+  // Release the closure before signalling, it may reference the group
+  task.fn = nullptr;
+  group->m_pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+bool ts::try_run_one()
+{
+  Task task;
+  if(!try_pop(task))
+  {
+    return false;
+  }
+  execute(task);
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+tg::Task_group(Task_scheduler& scheduler)
+  :
+  m_scheduler(scheduler),
+  m_pending(0),
+  m_exception(),
+  m_exception_mutex()
+{ }
+
+///////////////////////////////////////////////////////////////////////
+
+tg::~Task_group()
+{
+  // Tasks may reference the group, so never leave any behind. Exceptions
+  // were already surfaced by an explicit Wait(), or are dropped here.
+  while(m_pending.load(std::memory_order_acquire) > 0)
+  {
+    if(!m_scheduler.try_run_one())
+    {
+      std::this_thread::yield();
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void tg::Run(std::function<void()> fn)
+{
+  if(m_scheduler.m_workers.empty())
+  {
+    try
+    {
+      fn();
+    }
+    catch(...)
+    {
+      set_exception(std::current_exception());
+    }
+    return;
+  }
+
+  m_pending.fetch_add(1, std::memory_order_relaxed);
+  m_scheduler.push(Task_scheduler::Task{std::move(fn), this});
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void tg::Wait()
+{
+  while(m_pending.load(std::memory_order_acquire) > 0)
+  {
+    if(!m_scheduler.try_run_one())
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  std::exception_ptr exception;
+  {
+    std::lock_guard<std::mutex> lock(m_exception_mutex);
+    std::swap(exception, m_exception);
+  }
+  if(exception)
+  {
+    std::rethrow_exception(exception);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void tg::set_exception(std::exception_ptr exception)
+{
+  std::lock_guard<std::mutex> lock(m_exception_mutex);
+  if(!m_exception)
+  {
+    m_exception = exception;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
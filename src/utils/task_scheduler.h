@@ -0,0 +1,385 @@
+/**
+ * Copyright (C) 2025 Nate Anderson - All Rights Reserved
+ */
+
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+// Standard libs
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// JSON
+
+// Application files
+
+namespace world_builder
+{
+
+class Task_group;
+
+/**
+ * @brief Work-stealing task scheduler shared by every stage of the pipeline
+ * @details There is a single process-wide instance (see Instance()), so
+ * nested parallel loops and concurrent stages all draw from the same fixed set
+ * of workers and cannot oversubscribe the machine. Each worker owns a deque:
+ * it pushes and pops its own tasks LIFO (cache-warm, depth-first) and steals
+ * from the front of other workers' deques (oldest, largest tasks) when idle.
+ * Threads that wait on a Task_group run queued tasks instead of blocking, so
+ * waiting inside a task never deadlocks.
+ *
+ * The thread count includes the calling thread: a count of 1 runs everything
+ * inline with no worker threads at all.
+ */
+class Task_scheduler
+{
+public:
+  // Attributes
+
+  // Implementation
+  /**
+   * @brief The shared scheduler
+   */
+  static Task_scheduler& Instance();
+
+  /**
+   * @brief Destructor, joins all workers
+   */
+  ~Task_scheduler();
+
+  Task_scheduler(const Task_scheduler&) = delete;
+  Task_scheduler& operator=(const Task_scheduler&) = delete;
+
+  /**
+   * @brief Resize the worker pool. Must not be called while tasks are running.
+   * @param threads Total threads including the caller, 0 for one per hardware
+   * thread
+   */
+  void Set_thread_count(unsigned threads);
+
+  /**
+   * @brief Total threads including the caller
+   */
+  unsigned Get_thread_count() const { return static_cast<unsigned>(m_workers.size()) + 1; }
+
+  /**
+   * @brief In deterministic mode automatic grain sizes depend only on the
+   * range length, never on the thread count, so every Parallel_reduce folds
+   * the same chunks in the same order and results are bitwise identical
+   * across thread counts
+   * @param deterministic True to enable
+   */
+  void Set_deterministic(bool deterministic) { m_deterministic = deterministic; }
+  bool Is_deterministic() const { return m_deterministic; }
+
+  /**
+   * @brief Run `body(lo, hi)` over sub-ranges covering [begin, end)
+   * @details The range is split in halves until pieces are at most `grain`
+   * long; the halves are exposed for stealing, so load balances itself.
+   * @param begin First index
+   * @param end One past the last index
+   * @param grain Largest sub-range handed to `body`, 0 to pick automatically
+   * @param body Callable taking (size_t lo, size_t hi)
+   */
+  template<typename F>
+  void Parallel_for(size_t begin, size_t end, size_t grain, F&& body);
+
+  /**
+   * @brief Map-reduce over [begin, end)
+   * @details `map(lo, hi, init)` folds one sub-range into an accumulator that
+   * starts at `identity`; the per-chunk results are then combined in chunk
+   * order with `reduce(a, b)`. Chunk boundaries depend only on `grain`, so the
+   * result does not depend on scheduling. With an automatic grain they also
+   * depend on the thread count, unless the scheduler is deterministic.
+   * @param begin First index
+   * @param end One past the last index
+   * @param grain Chunk length, 0 to pick automatically
+   * @param identity Neutral element of `reduce`
+   * @param map Callable (size_t lo, size_t hi, T init) -> T
+   * @param reduce Callable (T a, T b) -> T
+   * @return The reduced value, `identity` for an empty range
+   */
+  template<typename T, typename Map, typename Reduce>
+  T Parallel_reduce(size_t begin, size_t end, size_t grain, T identity, Map&& map, Reduce&& reduce);
+
+  /**
+   * @brief Grain size used when 0 is passed: enough chunks per thread for
+   * stealing to balance uneven work, or a fixed number of chunks in
+   * deterministic mode
+   * @param count Range length
+   */
+  size_t Get_auto_grain(size_t count) const;
+
+private:
+  // Attributes
+  friend class Task_group;
+
+  /**
+   * @brief A queued unit of work
+   */
+  struct Task
+  {
+    /**
+     * @brief The work
+     */
+    std::function<void()> fn;
+
+    /**
+     * @brief Group to notify on completion
+     */
+    Task_group* group;
+  };
+
+  /**
+   * @brief A worker's deque, owner uses the back, thieves the front
+   */
+  struct Worker_queue
+  {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  /**
+   * @brief Worker threads; the caller is the implicit extra thread
+   */
+  std::vector<std::thread> m_workers;
+
+  /**
+   * @brief One deque per worker
+   */
+  std::vector<std::unique_ptr<Worker_queue>> m_queues;
+
+  /**
+   * @brief Tasks pushed from threads that are not workers
+   */
+  Worker_queue m_injection;
+
+  /**
+   * @brief Number of tasks sitting in any queue
+   */
+  std::atomic<size_t> m_queued;
+
+  /**
+   * @brief Set to make the workers exit
+   */
+  std::atomic<bool> m_stopping;
+
+  /**
+   * @brief Automatic grains ignore the thread count
+   */
+  bool m_deterministic;
+
+  /**
+   * @brief Sleeping workers wait on this
+   */
+  std::mutex m_sleep_mutex;
+  std::condition_variable m_wake;
+
+  // Implementation
+  /**
+   * @brief Constructor, starts one worker per hardware thread
+   */
+  Task_scheduler();
+
+  /**
+   * @brief Start `count` workers
+   */
+  void start_workers(unsigned count);
+
+  /**
+   * @brief Stop and join all workers
+   */
+  void stop_workers();
+
+  /**
+   * @brief Worker main loop
+   * @param index The worker's queue index
+   */
+  void worker_loop(size_t index);
+
+  /**
+   * @brief Queue a task, on the calling worker's own deque if possible
+   */
+  void push(Task task);
+
+  /**
+   * @brief Take a task: own deque, then the injection queue, then steal
+   * @param task Filled in on success
+   * @return True if a task was taken
+   */
+  bool try_pop(Task& task);
+
+  /**
+   * @brief Run a task and notify its group
+   */
+  void execute(Task& task);
+
+  /**
+   * @brief Run one queued task if there is one
+   * @return True if a task was run
+   */
+  bool try_run_one();
+
+  /**
+   * @brief Recursive halving for Parallel_for
+   */
+  template<typename F>
+  void split_range(Task_group& group, size_t begin, size_t end, size_t grain, F& body);
+};
+
+/**
+ * @brief A set of tasks that can be waited on together
+ * @details Tasks may add more tasks to the same group. Wait() helps run
+ * queued work until every task in the group has finished, then rethrows the
+ * first exception thrown by any of them.
+ */
+class Task_group
+{
+public:
+  // Implementation
+  /**
+   * @brief Constructor
+   * @param scheduler The scheduler to run tasks on
+   */
+  explicit Task_group(Task_scheduler& scheduler = Task_scheduler::Instance());
+
+  /**
+   * @brief Destructor, waits for outstanding tasks
+   */
+  ~Task_group();
+
+  Task_group(const Task_group&) = delete;
+  Task_group& operator=(const Task_group&) = delete;
+
+  /**
+   * @brief Queue a task, or run it inline when the scheduler has no workers
+   * @param fn The task
+   */
+  void Run(std::function<void()> fn);
+
+  /**
+   * @brief Wait for every task in the group, helping with queued work
+   */
+  void Wait();
+
+private:
+  // Attributes
+  friend class Task_scheduler;
+
+  /**
+   * @brief The scheduler tasks are queued on
+   */
+  Task_scheduler& m_scheduler;
+
+  /**
+   * @brief Tasks queued but not finished
+   */
+  std::atomic<size_t> m_pending;
+
+  /**
+   * @brief First exception thrown by a task
+   */
+  std::exception_ptr m_exception;
+
+  /**
+   * @brief Guards m_exception
+   */
+  std::mutex m_exception_mutex;
+
+  // Implementation
+  /**
+   * @brief Record a task's exception, keeping only the first
+   */
+  void set_exception(std::exception_ptr exception);
+};
+
+///////////////////////////////////////////////////////////////////////
+
+template<typename F>
+void Task_scheduler::Parallel_for(size_t begin, size_t end, size_t grain, F&& body)
+{
+  if(end <= begin)
+  {
+    return;
+  }
+  if(grain == 0)
+  {
+    grain = Get_auto_grain(end - begin);
+  }
+
+  if(m_workers.empty() || end - begin <= grain)
+  {
+    body(begin, end);
+    return;
+  }
+
+  Task_group group(*this);
+  split_range(group, begin, end, grain, body);
+  group.Wait();
+}
+
+///////////////////////////////////////////////////////////////////////
+
+template<typename F>
+void Task_scheduler::split_range(Task_group& group, size_t begin, size_t end, size_t grain, F& body)
+{
+  // Hand the upper halves to thieves and keep working on the lower half
+  while(end - begin > grain)
+  {
+    size_t mid = begin + (end - begin) / 2;
+    group.Run([this, &group, mid, end, grain, &body]()
+    {
+      split_range(group, mid, end, grain, body);
+    });
+    end = mid;
+  }
+  body(begin, end);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+template<typename T, typename Map, typename Reduce>
+T Task_scheduler::Parallel_reduce(size_t begin, size_t end, size_t grain, T identity, Map&& map, Reduce&& reduce)
+{
+  if(end <= begin)
+  {
+    return identity;
+  }
+  if(grain == 0)
+  {
+    grain = Get_auto_grain(end - begin);
+  }
+
+  size_t chunks = (end - begin + grain - 1) / grain;
+  std::vector<T> partials(chunks, identity);
+
+  Parallel_for(0, chunks, 1, [&](size_t lo, size_t hi)
+  {
+    for(size_t chunk = lo; chunk < hi; ++chunk)
+    {
+      size_t chunk_begin = begin + chunk * grain;
+      size_t chunk_end = std::min(end, chunk_begin + grain);
+      partials[chunk] = map(chunk_begin, chunk_end, identity);
+    }
+  });
+
+  T result = identity;
+  for(const auto& partial : partials)
+  {
+    result = reduce(result, partial);
+  }
+  return result;
+}
+
+}
+
+#endif
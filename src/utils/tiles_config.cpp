@@ -4,11 +4,14 @@
 
 // Standard libs
 #include <random>
+#include <stdexcept>
 
 // JSON
 #include <deps/json.hpp>
 
 // Application files
+#include <defs/dice_rolls.h>
+#include <geo_models/temperature_field.h>
 #include <utils/tiles_config.h>
 
 ///////////////////////////////////////////////////////////////////////
@@ -26,7 +29,11 @@ tiles::Tiles_config(std::ifstream params_path)
   m_sea_level(),
   m_river_spawn_prob(),
   m_max_river_length(),
-  m_seed(std::random_device{}())
+  m_coast_moderation(Temperature_field::DEFAULT_MODERATION_DISTANCE),
+  m_seed(std::random_device{}()),
+  m_threads(0),
+  m_deterministic(false),
+  m_terrain_rules()
 {
   nlohmann::json file_data = nlohmann::json::parse(params_path);
 
@@ -37,13 +44,37 @@ tiles::Tiles_config(std::ifstream params_path)
   m_sea_level = file_data.at("sea_level");
   m_river_spawn_prob = file_data.at("river_spawn_prob");
   m_max_river_length = file_data.at("max_river_length");
+  m_coast_moderation = file_data.value("coast_moderation", m_coast_moderation);
+  m_seed = file_data.value("seed", m_seed);
+  m_threads = file_data.value("threads", m_threads);
+  m_deterministic = file_data.value("deterministic", m_deterministic);
+  if(file_data.contains("terrain_rules"))
+  {
+    m_terrain_rules = Biome_table::Parse_rules(file_data["terrain_rules"].dump());
+  }
+
+  if(!(m_coast_moderation > 0))
+  {
+    throw std::invalid_argument("coast_moderation must be positive");
+  }
 }
 
 ///////////////////////////////////////////////////////////////////////
 
 tiles::Tiles_config()
   :
-  m_seed(std::random_device{}())
+  m_coast_moderation(Temperature_field::DEFAULT_MODERATION_DISTANCE),
+  m_seed(std::random_device{}()),
+  m_threads(0),
+  m_deterministic(false),
+  m_terrain_rules()
 { }
 
 ///////////////////////////////////////////////////////////////////////
+
+void tiles::Apply() const
+{
+  dice::Set_seed(m_seed);
+}
+
+///////////////////////////////////////////////////////////////////////
@@ -8,10 +8,12 @@
 // Standard libs
 #include <fstream>
 #include <cstdint>
+#include <vector>
 
 // JSON
 
 // Application files
+#include <geo_models/biome_table.h>
 
 namespace world_builder
 {
@@ -34,7 +36,8 @@ public:
   Tiles_config();
 
   /**
-   * @brief Apply configuration to the tiles-based map generator
+   * @brief Apply configuration to the tiles-based map generator, seeding the
+   * dice with `m_seed`
    */
   void Apply() const;
 
@@ -48,7 +51,11 @@ public:
   const double Get_sea_level() const { return m_sea_level; }
   const double Get_river_spawn_prob() const { return m_river_spawn_prob; }
   const uint32_t Get_max_river_length() const { return m_max_river_length; }
+  const double Get_coast_moderation() const { return m_coast_moderation; }
   const unsigned Get_seed() const { return m_seed; }
+  const unsigned Get_threads() const { return m_threads; }
+  const bool Get_deterministic() const { return m_deterministic; }
+  const std::vector<Biome_rule>& Get_terrain_rules() const { return m_terrain_rules; }
 
 private:
   // Attributes
@@ -89,10 +96,36 @@ private:
   uint32_t m_max_river_length;
 
   /**
-   * @brief Random seed, used to generate the rest of the randomness
+   * @brief Tiles inland at which the sea's moderation of temperature has
+   * halved. Taken from the optional "coast_moderation" key; must be
+   * positive.
+   */
+  double m_coast_moderation;
+
+  /**
+   * @brief Random seed, used to generate the rest of the randomness. Taken from
+   * the optional "seed" key, otherwise drawn from std::random_device
    */
   unsigned m_seed;
 
+  /**
+   * @brief Worker threads for the shared task scheduler, 0 for one per
+   * hardware thread. Taken from the optional "threads" key.
+   */
+  unsigned m_threads;
+
+  /**
+   * @brief Make output bitwise identical across thread counts. Taken from the
+   * optional "deterministic" key.
+   */
+  bool m_deterministic;
+
+  /**
+   * @brief Rules painting land tiles, each naming a terrain type. Taken from
+   * the optional "terrain_rules" key; empty uses the built-in rules.
+   */
+  std::vector<Biome_rule> m_terrain_rules;
+
   // Implementation
 };
 }
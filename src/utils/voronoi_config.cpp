@@ -3,11 +3,14 @@
  */
 
 // Standard libs
+#include <stdexcept>
 
  // JSON
 #include <deps/json.hpp>
 
  // Application files
+#include <defs/dice_rolls.h>
+#include <geo_models/temperature_field.h>
 #include <utils/voronoi_config.h>
 
 ///////////////////////////////////////////////////////////////////////
@@ -21,23 +24,115 @@ voronoi::Voronoi_config(std::ifstream params_path)
   m_width(),
   m_height(),
   m_min_distance(),
+  m_max_distance(0),
+  m_density_map(),
   m_k_attempts(),
+  m_wrap_points(true),
   m_voronoi_scale_factor(),
-  m_relax_iterations()
+  m_relax_iterations(),
+  m_relax_method("lloyd"),
+  m_voronoi_strips(0),
+  m_voronoi_backend("boost"),
+  m_spherical(false),
+  m_sphere_jitter(0.1),
+  m_coarse_min_distance(0),
+  m_island_radius(0),
+  m_mountain_seeds(8),
+  m_mountain_radius(6),
+  m_river_min_flow(0),
+  m_coast_moderation(Temperature_field::DEFAULT_MODERATION_DISTANCE),
+  m_biome_rules(),
+  m_target_cell_count(0),
+  m_chunk_size(0),
+  m_chunk_cache(256),
+  m_seed(std::random_device{}()),
+  m_threads(0),
+  m_deterministic(false)
 {
   nlohmann::json file_data = nlohmann::json::parse(params_path);
   m_width = file_data.value("map_width", m_width);
   m_height = file_data.value("map_height", m_height);
   m_min_distance = file_data.value("point_min_distance", m_min_distance);
+  m_max_distance = file_data.value("point_max_distance", m_max_distance);
+  m_density_map = file_data.value("density_map", m_density_map);
   m_k_attempts = file_data.value("point_attempts", m_k_attempts);
+  m_wrap_points = file_data.value("wrap_points", m_wrap_points);
   m_voronoi_scale_factor = file_data.value("voronoi_scale_factor",
                                            m_voronoi_scale_factor);
   m_relax_iterations = file_data.value("cell_relaxations", m_relax_iterations);
+  m_relax_method = file_data.value("relax_method", m_relax_method);
+  m_voronoi_strips = file_data.value("voronoi_strips", m_voronoi_strips);
+  m_voronoi_backend = file_data.value("voronoi_backend", m_voronoi_backend);
+  m_spherical = file_data.value("spherical", m_spherical);
+  m_sphere_jitter = file_data.value("sphere_jitter", m_sphere_jitter);
+  m_coarse_min_distance = file_data.value("coarse_min_distance", m_coarse_min_distance);
+  m_island_radius = file_data.value("island_radius", m_island_radius);
+  m_mountain_seeds = file_data.value("mountain_seeds", m_mountain_seeds);
+  m_mountain_radius = file_data.value("mountain_radius", m_mountain_radius);
+  m_river_min_flow = file_data.value("river_min_flow", m_river_min_flow);
+  m_coast_moderation = file_data.value("coast_moderation", m_coast_moderation);
+  m_target_cell_count = file_data.value("target_cell_count", m_target_cell_count);
+  m_chunk_size = file_data.value("chunk_size", m_chunk_size);
+  m_chunk_cache = file_data.value("chunk_cache", m_chunk_cache);
+  m_seed = file_data.value("seed", m_seed);
+  m_threads = file_data.value("threads", m_threads);
+  m_deterministic = file_data.value("deterministic", m_deterministic);
+  if(file_data.contains("biome_rules"))
+  {
+    m_biome_rules = Biome_table::Parse_rules(file_data["biome_rules"].dump());
+  }
+
+  if(!(m_coast_moderation > 0))
+  {
+    throw std::invalid_argument("coast_moderation must be positive");
+  }
+
+  // Chunked generation needs every point within 2r of a chunk to come from
+  // the eight chunks around it
+  if(m_target_cell_count == 0 && m_chunk_size > 0 && m_chunk_size < 2.0 * m_min_distance)
+  {
+    throw std::invalid_argument("chunk_size must be at least twice point_min_distance");
+  }
 }
 
 ///////////////////////////////////////////////////////////////////////
 
 voronoi::Voronoi_config()
+  :
+  m_width(0),
+  m_height(0),
+  m_min_distance(0),
+  m_max_distance(0),
+  m_density_map(),
+  m_k_attempts(0),
+  m_wrap_points(true),
+  m_voronoi_scale_factor(0),
+  m_relax_iterations(0),
+  m_relax_method("lloyd"),
+  m_voronoi_strips(0),
+  m_voronoi_backend("boost"),
+  m_spherical(false),
+  m_sphere_jitter(0.1),
+  m_coarse_min_distance(0),
+  m_island_radius(0),
+  m_mountain_seeds(8),
+  m_mountain_radius(6),
+  m_river_min_flow(0),
+  m_coast_moderation(Temperature_field::DEFAULT_MODERATION_DISTANCE),
+  m_biome_rules(),
+  m_target_cell_count(0),
+  m_chunk_size(0),
+  m_chunk_cache(256),
+  m_seed(std::random_device{}()),
+  m_threads(0),
+  m_deterministic(false)
 { }
 
 ///////////////////////////////////////////////////////////////////////
+
+void voronoi::Apply() const
+{
+  dice::Set_seed(m_seed);
+}
+
+///////////////////////////////////////////////////////////////////////
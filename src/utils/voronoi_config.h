@@ -6,11 +6,15 @@
 #define VORONOI_CONFIG_H
 
 // Standard libs
+#include <cstddef>
 #include <fstream>
+#include <string>
+#include <vector>
 
 // JSON
 
 // Application files
+#include <geo_models/biome_table.h>
 
 namespace world_builder
 {
@@ -32,15 +36,42 @@ public:
    */
   Voronoi_config();
 
+  /**
+   * @brief Apply configuration to the Voronoi map generator, seeding the dice
+   * with `m_seed`
+   */
+  void Apply() const;
+
   /**
    * Getters
    */
   const double Get_width() const { return m_width; }
   const double Get_height() const { return m_height; }
   const double Get_min_distance() const { return m_min_distance; }
+  const double Get_max_distance() const { return m_max_distance; }
+  const std::string& Get_density_map() const { return m_density_map; }
   const int Get_attempts() const { return m_k_attempts; }
+  const bool Get_wrap_points() const { return m_wrap_points; }
   const double Get_voronoi_scale_factor() const { return m_voronoi_scale_factor; }
   const int Get_relax_iterations() const { return m_relax_iterations; }
+  const std::string& Get_relax_method() const { return m_relax_method; }
+  const int Get_voronoi_strips() const { return m_voronoi_strips; }
+  const std::string& Get_voronoi_backend() const { return m_voronoi_backend; }
+  const bool Get_spherical() const { return m_spherical; }
+  const double Get_sphere_jitter() const { return m_sphere_jitter; }
+  const double Get_coarse_min_distance() const { return m_coarse_min_distance; }
+  const double Get_island_radius() const { return m_island_radius; }
+  const int Get_mountain_seeds() const { return m_mountain_seeds; }
+  const int Get_mountain_radius() const { return m_mountain_radius; }
+  const double Get_river_min_flow() const { return m_river_min_flow; }
+  const double Get_coast_moderation() const { return m_coast_moderation; }
+  const std::vector<Biome_rule>& Get_biome_rules() const { return m_biome_rules; }
+  const size_t Get_target_cell_count() const { return m_target_cell_count; }
+  const double Get_chunk_size() const { return m_chunk_size; }
+  const size_t Get_chunk_cache() const { return m_chunk_cache; }
+  const unsigned Get_seed() const { return m_seed; }
+  const unsigned Get_threads() const { return m_threads; }
+  const bool Get_deterministic() const { return m_deterministic; }
 
 private:
   // Attributes
@@ -59,11 +90,32 @@ private:
    */
   double m_min_distance;
 
+  /**
+   * @brief Largest point distance for variable-density sampling. Taken from
+   * the optional "point_max_distance" key.
+   */
+  double m_max_distance;
+
+  /**
+   * @brief Plain PGM/PPM image stretched over the map that sets the point
+   * distance, black for `m_min_distance` and white for `m_max_distance`.
+   * Taken from the optional "density_map" key; empty keeps uniform spacing.
+   */
+  std::string m_density_map;
+
   /**
    * @brief Number of attempts to find a new valid point
    */
   int m_k_attempts;
 
+  /**
+   * @brief Sample points periodically in x, so they are seamless where the
+   * Voronoi diagram wraps. Only uniform Poisson disc sampling supports it;
+   * the target count, chunked and density map samplers ignore it. Taken
+   * from the optional "wrap_points" key.
+   */
+  bool m_wrap_points;
+
   /**
    * @brief Scale factor for the Voronoi builder.
    * @details Smaller scale factor means coarser rounding, some points may collapse
@@ -71,6 +123,8 @@ private:
    * with less variation in shape and size.
    * A larger scale factor means more precise site positions, cells preserve
    * subtle differences, and slightly more irregular/organic-looking cells.
+   * 0 rounds sites onto the finest int32 grid the map allows instead, and
+   * drops any duplicates.
    */
   double m_voronoi_scale_factor;
 
@@ -79,6 +133,124 @@ private:
    */
   int m_relax_iterations;
 
+  /**
+   * @brief How the polygons are relaxed, "lloyd" or "lbfgs". Taken from the
+   * optional "relax_method" key.
+   */
+  std::string m_relax_method;
+
+  /**
+   * @brief Vertical strips the Voronoi diagram is built in, in parallel.
+   * Taken from the optional "voronoi_strips" key; 0 builds it whole.
+   */
+  int m_voronoi_strips;
+
+  /**
+   * @brief What builds the Voronoi diagram, "boost" or "clipping". Taken
+   * from the optional "voronoi_backend" key.
+   */
+  std::string m_voronoi_backend;
+
+  /**
+   * @brief Build a planet: sites on a sphere whose equator is the map width,
+   * exported as equirectangular images. Taken from the optional "spherical"
+   * key; false builds the flat map wrapped east to west.
+   */
+  bool m_spherical;
+
+  /**
+   * @brief Random push of each spherical site off its Fibonacci lattice
+   * point, as a fraction of the site spacing. Taken from the optional
+   * "sphere_jitter" key.
+   */
+  double m_sphere_jitter;
+
+  /**
+   * @brief Poisson disc spacing of a coarse cell layer linked to the map's
+   * cells, for large-scale structure. Taken from the optional
+   * "coarse_min_distance" key; 0 builds no coarse layer.
+   */
+  double m_coarse_min_distance;
+
+  /**
+   * @brief Size of the island elevation is assigned around, as a fraction of
+   * the way from the map center to its edges. Taken from the optional
+   * "island_radius" key; 0 assigns no elevation.
+   */
+  double m_island_radius;
+
+  /**
+   * @brief Number of land cells mountains rise around. Taken from the
+   * optional "mountain_seeds" key.
+   */
+  int m_mountain_seeds;
+
+  /**
+   * @brief Cell hops over which a mountain falls away to its surroundings.
+   * Taken from the optional "mountain_radius" key.
+   */
+  int m_mountain_radius;
+
+  /**
+   * @brief Flow, in cells draining through, a land cell needs to carry a
+   * river. Taken from the optional "river_min_flow" key; 0 traces no
+   * rivers.
+   */
+  double m_river_min_flow;
+
+  /**
+   * @brief Cell hops inland at which the sea's moderation of temperature
+   * has halved. Taken from the optional "coast_moderation" key; must be
+   * positive.
+   */
+  double m_coast_moderation;
+
+  /**
+   * @brief Biome rules for the cells, in priority order, see
+   * Biome_table::Parse_rules. Taken from the optional "biome_rules" key;
+   * empty uses the built-in rules.
+   */
+  std::vector<Biome_rule> m_biome_rules;
+
+  /**
+   * @brief Exact number of cells to generate with weighted sample
+   * elimination instead of Poisson disc sampling. Taken from the optional
+   * "target_cell_count" key; 0 keeps Poisson disc sampling, where the count
+   * follows from `m_min_distance`.
+   */
+  size_t m_target_cell_count;
+
+  /**
+   * @brief Side of the chunks for chunked Poisson generation, where each
+   * chunk is a function of (seed, chunk coordinates). Taken from the optional
+   * "chunk_size" key; 0 samples the whole map at once.
+   */
+  double m_chunk_size;
+
+  /**
+   * @brief Most chunks kept in memory by chunked generation. Taken from the
+   * optional "chunk_cache" key.
+   */
+  size_t m_chunk_cache;
+
+  /**
+   * @brief Random seed, used to generate the rest of the randomness. Taken from
+   * the optional "seed" key, otherwise drawn from std::random_device
+   */
+  unsigned m_seed;
+
+  /**
+   * @brief Worker threads for the shared task scheduler, 0 for one per
+   * hardware thread. Taken from the optional "threads" key.
+   */
+  unsigned m_threads;
+
+  /**
+   * @brief Make output bitwise identical across thread counts. Taken from the
+   * optional "deterministic" key.
+   */
+  bool m_deterministic;
+
   // Implementation
 
 };
@@ -3,9 +3,14 @@
  */
 
 // Standard libs
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <stdexcept>
+#include <vector>
 
 // Application files
+#include <utils/task_scheduler.h>
 #include <utils/world_builder_utils.h>
 
 ///////////////////////////////////////////////////////////////////////
@@ -16,3 +21,75 @@ void world_builder::Print_key_value_string(std::string key_name, std::string val
 }
 
 ///////////////////////////////////////////////////////////////////////
+
+uint64_t world_builder::Hash_file(const std::string& filename)
+{
+  std::ifstream ifs(filename, std::ios::binary);
+  if(!ifs)
+  {
+    throw std::runtime_error("Failed to open " + filename + " for hashing");
+  }
+
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  std::vector<char> buffer(1 << 16);
+  while(ifs)
+  {
+    ifs.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    std::streamsize got = ifs.gcount();
+    for(std::streamsize i = 0; i < got; ++i)
+    {
+      hash ^= static_cast<unsigned char>(buffer[i]);
+      hash *= 0x100000001b3ULL;
+    }
+  }
+  return hash;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+std::string world_builder::To_hex(uint64_t value)
+{
+  char text[17];
+  std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(value));
+  return text;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+void world_builder::Write_ppm(const std::string& filename,
+                              int width,
+                              int height,
+                              const std::vector<std::array<unsigned char, 3>>& pixels)
+{
+  std::ofstream ofs(filename, std::ios::out);
+  if(!ofs)
+  {
+    Print_to_cout("PPM export: failed to open file " + filename);
+    return;
+  }
+
+  std::vector<std::string> rows(height);
+  Task_scheduler::Instance().Parallel_for(0, height, 1, [&](size_t row_lo, size_t row_hi)
+  {
+    for(size_t y = row_lo; y < row_hi; ++y)
+    {
+      std::string& row = rows[y];
+      row.reserve(static_cast<size_t>(width) * 12 + 1);
+      for(int x = 0; x < width; ++x)
+      {
+        const auto& c = pixels[y * width + x];
+        row += std::to_string(c[0]) + " " + std::to_string(c[1]) + " " + std::to_string(c[2]) + " ";
+      }
+      row += "\n";
+    }
+  });
+
+  ofs << "P3\n" << width << " " << height << "\n255\n";
+  for(const auto& row : rows)
+  {
+    ofs << row;
+  }
+  ofs.close();
+}
+
+///////////////////////////////////////////////////////////////////////
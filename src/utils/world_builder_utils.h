@@ -9,6 +9,8 @@
 #include <string>
 #include <iostream>
 #include <array>
+#include <cstdint>
+#include <vector>
 
 // JSON
 
@@ -45,6 +47,35 @@ void Print_to_cout(const C& log_message)
  */
 void Print_key_value_string(std::string key_name, std::string value);
 
+/**
+ * @brief 64-bit FNV-1a hash of a file's bytes, for comparing outputs
+ * @param filename File to hash
+ * @return The hash
+ * @throws std::runtime_error if the file cannot be read
+ */
+uint64_t Hash_file(const std::string& filename);
+
+/**
+ * @brief Fixed-width lowercase hex form of a 64-bit value
+ * @param value The value
+ * @return 16 hex digits
+ */
+std::string To_hex(uint64_t value);
+
+/**
+ * @brief Write an RGB image as plain-text PPM (P3)
+ * @details Rows are formatted in parallel, then written in order, so the
+ * file is the same for any thread count.
+ * @param filename Output filename
+ * @param width Image width
+ * @param height Image height
+ * @param pixels Row-major colors, `width * height` of them
+ */
+void Write_ppm(const std::string& filename,
+               int width,
+               int height,
+               const std::vector<std::array<unsigned char, 3>>& pixels);
+
 /**
  * @brief Print key value pair
  * @tparam T The numeric class to print
@@ -4,21 +4,25 @@
 
 // Standard libs
 #include <boost/program_options.hpp>
+#include <algorithm>
+#include <cstdint>
 #include <exception>
+#include <filesystem>
 #include <fstream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 // JSON
 
 // Application files
-#include <defs/dice_rolls.h>
+#include <utils/pipelines.h>
 #include <utils/tiles_config.h>
 #include <utils/world_builder_utils.h>
 #include <utils/stopwatch.h>
-// Voronoi
+#include <utils/stage_profiler.h>
+#include <utils/task_scheduler.h>
 #include <utils/voronoi_config.h>
-#include <geo_models/voronoi/poisson_disc.h>
-#include <geo_models/voronoi/voronoi_builder.h>
 
 ///////////////////////////////////////////////////////////////////////
 
@@ -59,11 +63,99 @@ EGen_type Parse_gen_type(const std::string& gen_type)
 
 ///////////////////////////////////////////////////////////////////////
 
+/**
+ * @brief Run the pipeline in deterministic mode on one thread and on
+ * `threads` threads, then compare the hashes of every output file
+ * @param gen_type Pipeline to run
+ * @param tiles_config Config for the tiles pipeline
+ * @param voronoi_config Config for the Voronoi pipeline
+ * @param output_dir Each run writes to a subdirectory of this
+ * @param threads Thread count of the second run, 0 for all cores
+ * @return True if every file matches
+ */
+bool Run_self_check(EGen_type gen_type,
+                    const world_builder::Tiles_config& tiles_config,
+                    const world_builder::Voronoi_config& voronoi_config,
+                    const std::string& output_dir,
+                    unsigned threads)
+{
+  world_builder::Task_scheduler& scheduler = world_builder::Task_scheduler::Instance();
+  scheduler.Set_deterministic(true);
+
+  scheduler.Set_thread_count(threads);
+  const std::vector<unsigned> thread_counts = {1, scheduler.Get_thread_count()};
+
+  std::vector<std::filesystem::path> run_dirs;
+  for(unsigned count : thread_counts)
+  {
+    std::filesystem::path run_dir = std::filesystem::path(output_dir) / "self_check" /
+                                    ("threads_" + std::to_string(count));
+    std::filesystem::remove_all(run_dir);
+    std::filesystem::create_directories(run_dir);
+    run_dirs.push_back(run_dir);
+
+    scheduler.Set_thread_count(count);
+    world_builder::Stage_profiler profiler(false);
+    world_builder::Print_key_value("Self check threads", count);
+    switch(gen_type)
+    {
+      case(EGen_type::EGEN_TYPE_Tiles):
+        tiles_config.Apply();
+        world_builder::Run_tiles_pipeline(tiles_config, run_dir.string(), profiler);
+        break;
+      case(EGen_type::EGEN_TYPE_Voronoi):
+        voronoi_config.Apply();
+        world_builder::Run_voronoi_pipeline(voronoi_config, run_dir.string(), profiler);
+        break;
+      default:
+        break;
+    }
+  }
+
+  // Every file written by the single-threaded run must exist, byte for byte,
+  // in the parallel run
+  std::vector<std::filesystem::path> files;
+  for(const auto& entry : std::filesystem::directory_iterator(run_dirs[0]))
+  {
+    files.push_back(entry.path().filename());
+  }
+  std::sort(files.begin(), files.end());
+
+  int mismatches = 0;
+  for(const auto& file : files)
+  {
+    uint64_t serial_hash = world_builder::Hash_file((run_dirs[0] / file).string());
+    std::filesystem::path parallel_path = run_dirs[1] / file;
+    bool present = std::filesystem::exists(parallel_path);
+    uint64_t parallel_hash = present ? world_builder::Hash_file(parallel_path.string()) : 0;
+
+    bool match = present && serial_hash == parallel_hash;
+    mismatches += match ? 0 : 1;
+    world_builder::Print_key_value_string(file.string(),
+                                          world_builder::To_hex(serial_hash) + " / " +
+                                          world_builder::To_hex(parallel_hash) +
+                                          (match ? " match" : " MISMATCH"));
+  }
+
+  world_builder::Print_to_cout(mismatches == 0 ? std::string("Self check passed")
+                                               : "Self check failed: " + std::to_string(mismatches) +
+                                                 " of " + std::to_string(files.size()) + " files differ");
+  return mismatches == 0;
+}
+
+///////////////////////////////////////////////////////////////////////
+
 int main(int argc, char *argv[])
 {
   //////////////////////////////////////////////////////
   // Config defaults
   std::string app_cfg_path;
+  std::string output_dir = std::string(PROJECT_ROOT_DIR) + "/output";
+  bool profile = false;
+  unsigned threads = 0;
+  bool deterministic = false;
+  unsigned self_check_threads = 0;
+  std::string profile_json_path;
 
   //////////////////////////////////////////////////////
   // Set up Runtime Objects
@@ -90,7 +182,26 @@ int main(int argc, char *argv[])
          "Main application config file")
       ("gen_type",
          po::value(&gen_type_string),
-         "World generation algorithm");
+         "World generation algorithm")
+      ("output_dir",
+         po::value(&output_dir)->default_value(output_dir),
+         "Directory for generated images and maps")
+      ("threads",
+         po::value(&threads),
+         "Worker threads, including the main thread (overrides the config, 0 for all cores)")
+      ("deterministic",
+         po::bool_switch(&deterministic),
+         "Make output bitwise identical for any thread count")
+      ("self_check",
+         po::value(&self_check_threads),
+         "Run the pipeline deterministically on 1 and on N threads (0 for all cores) "
+         "and compare the output hashes")
+      ("profile",
+         po::bool_switch(&profile),
+         "Report hardware counters and memory usage for every stage")
+      ("profile_json",
+         po::value(&profile_json_path),
+         "Also write the per-stage report to this JSON file");
 
 
   po::variables_map vm;
@@ -117,6 +228,12 @@ int main(int argc, char *argv[])
     return 1;
   }
 
+  // Counters are inherited by threads started after this point, so open them
+  // before the scheduler starts its workers
+  world_builder::Stage_profiler profiler(profile);
+  unsigned config_threads = 0;
+  bool config_deterministic = false;
+
   if(vm.count("app_cfg"))
   {
     try
@@ -126,11 +243,19 @@ int main(int argc, char *argv[])
         case(EGen_type::EGEN_TYPE_Tiles):
         {
           tiles_config = world_builder::Tiles_config(std::ifstream(app_cfg_path));
+          tiles_config.Apply();
+          world_builder::Print_key_value("Seed", tiles_config.Get_seed());
+          config_threads = tiles_config.Get_threads();
+          config_deterministic = tiles_config.Get_deterministic();
           break;
         }
         case(EGen_type::EGEN_TYPE_Voronoi):
         {
           voronoi_config = world_builder::Voronoi_config(std::ifstream(app_cfg_path));
+          voronoi_config.Apply();
+          world_builder::Print_key_value("Seed", voronoi_config.Get_seed());
+          config_threads = voronoi_config.Get_threads();
+          config_deterministic = voronoi_config.Get_deterministic();
           break;
         }
         default:
@@ -155,37 +280,54 @@ int main(int argc, char *argv[])
   //////////////////////////////////////////////////////
   // Build the world
 
-  // Now that I'm doing the config like I am, can re-add the tiles world setup
-
-  // Instantiate the generator
-  world_builder::Poisson_disc point_sampler(voronoi_config.Get_width(),
-                                            voronoi_config.Get_height(),
-                                            voronoi_config.Get_min_distance(),
-                                            voronoi_config.Get_attempts());
-  // Generate points
-  std::vector<world_builder::Point> points = point_sampler.Generate();
+  // Command line wins over the config
+  world_builder::Task_scheduler& scheduler = world_builder::Task_scheduler::Instance();
+  scheduler.Set_thread_count(vm.count("threads") ? threads : config_threads);
+  scheduler.Set_deterministic(deterministic || config_deterministic);
+  world_builder::Print_key_value("Threads", scheduler.Get_thread_count());
+  bool self_check = vm.count("self_check") > 0;
 
-  // Output Poisson disc points
-  point_sampler.Save_points_as_ppm("/home/nanderson/nate_personal/projects/world_builder/output/1_poisson_points.ppm");
-
-  //////////////////////////////////////////////////////
-  // Points to Voronoi polygons
+  std::filesystem::create_directories(output_dir);
 
-  world_builder::Voronoi_builder voronoi_builder(voronoi_config.Get_width(),
-                                                voronoi_config.Get_height(),
-                                                voronoi_config.Get_voronoi_scale_factor());
-
-  //std::vector<world_builder::Cell> cells = voronoi_builder.Build_cells(points);
-
-  voronoi_builder.Build_cells(points);
-  voronoi_builder.Export_PPM("/home/nanderson/nate_personal/projects/world_builder/output/2_initial_v_cells.ppm");
+  // Inputs the config only names, such as the density map, are read while
+  // building, so their errors surface here
+  try
+  {
+    if(self_check)
+    {
+      bool passed = Run_self_check(gen_type, tiles_config, voronoi_config, output_dir, self_check_threads);
+      return passed ? 0 : 3;
+    }
 
-  voronoi_builder.Relax_cells(voronoi_config.Get_relax_iterations());
-  voronoi_builder.Export_PPM("/home/nanderson/nate_personal/projects/world_builder/output/3_relaxed_v_cells.ppm");
+    switch(gen_type)
+    {
+      case(EGen_type::EGEN_TYPE_Tiles):
+        world_builder::Run_tiles_pipeline(tiles_config, output_dir, profiler);
+        break;
+      case(EGen_type::EGEN_TYPE_Voronoi):
+        world_builder::Run_voronoi_pipeline(voronoi_config, output_dir, profiler);
+        break;
+      default:
+        break;
+    }
+  }
+  catch (const std::exception& e)
+  {
+    world_builder::Print_to_cout("Error building the world");
+    world_builder::Print_to_cout(e.what());
+    return 1;
+  }
 
   //////////////////////////////////////////////////////
-  // World Visualization
+  // Report
 
+  total_timer.Stop();
+  profiler.Print_report();
+  world_builder::Print_key_value("Total seconds", total_timer.Get_time());
+  if(!profile_json_path.empty())
+  {
+    profiler.Write_json(profile_json_path);
+  }
 
   return 0;
 }